@@ -0,0 +1,119 @@
+/*
+ * ==========================================================================
+ *  eegblockcodec_bench.cpp — Ratio and Throughput Benchmark for EegBlockCodec
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Encodes synthetic EEG in recording-drain-sized runs (250 ms) the way
+ *    RecordingWorker does, decodes every block again and checks the round
+ *    trip bit for bit. The signal is DC offset + 10 Hz alpha + 50 Hz mains
+ *    + noise; by default it is quantized like a 24-bit amplifier
+ *    (ADC counts × a float μV step), which is what makes it compressible.
+ *    Built only with -DVIDEOEEG_BUILD_BENCHMARKS=ON; no Qt required.
+ *
+ *  USAGE:
+ *    eegblockcodec_bench [channels] [samplingRateHz] [quantized 1|0]
+ *    Defaults: 256 channels, 2000 Hz, quantized.
+ *
+ *  OUTPUT:
+ *    Compression ratio against RawFloat32 records, encode / decode speed
+ *    as multiples of real time on one core. Exit code 1 if any value or
+ *    timestamp differs after decoding.
+ *
+ * ==========================================================================
+ */
+
+#include "eegblockcodec.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const int channels = argc > 1 ? std::atoi(argv[1]) : 256;
+    const double rate = argc > 2 ? std::atof(argv[2]) : 2000.0;
+    const bool quantized = argc > 3 ? std::atoi(argv[3]) != 0 : true;
+    if (channels <= 0 || rate <= 0.0)
+    {
+        std::fprintf(stderr, "usage: %s [channels] [samplingRateHz] [quantized 1|0]\n", argv[0]);
+        return 2;
+    }
+
+    /* 20 s of signal; the ADC step is typical of a 24-bit EEG front end. */
+    const int seconds = 20;
+    const int totalRows = static_cast<int>(rate * seconds);
+    const float adcStep = 0.0715f;
+    std::vector<float> input(static_cast<size_t>(totalRows) * channels);
+    std::vector<double> timestamps(totalRows);
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> offset(-20000.0, 20000.0);
+    std::vector<double> dc(channels);
+    for (double& d : dc)
+        d = offset(rng);
+    for (int r = 0; r < totalRows; ++r)
+    {
+        const double t = r / rate;
+        timestamps[r] = 86400.0 + t * (1.0 + 25e-6);
+        const double alpha = 30.0 * std::sin(2.0 * 3.14159265358979 * 10.0 * t);
+        const double mains = 40.0 * std::sin(2.0 * 3.14159265358979 * 50.0 * t);
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            const double v = dc[ch] + alpha + mains + noise(rng);
+            input[static_cast<size_t>(r) * channels + ch] = quantized
+                ? static_cast<float>(std::lround(v / adcStep)) * adcStep
+                : static_cast<float>(v);
+        }
+    }
+
+    EegBlockCodec codec;
+    codec.reset(channels);
+    std::vector<char> encoded;
+    const int drainRows = std::max(1, static_cast<int>(rate / 4.0));
+
+    const auto encodeStart = std::chrono::steady_clock::now();
+    for (int r = 0; r < totalRows; r += drainRows)
+    {
+        const int rows = std::min(drainRows, totalRows - r);
+        codec.encode(input.data() + static_cast<size_t>(r) * channels, timestamps.data() + r,
+                     rows, encoded);
+    }
+    const auto encodeEnd = std::chrono::steady_clock::now();
+
+    std::vector<double> decodedTs;
+    std::vector<float> decoded;
+    decodedTs.reserve(timestamps.size());
+    decoded.reserve(input.size());
+    size_t at = 0;
+    bool ok = true;
+    const auto decodeStart = std::chrono::steady_clock::now();
+    while (ok && at < encoded.size())
+    {
+        size_t blockBytes = 0;
+        ok = EegBlockCodec::decodeBlock(encoded.data() + at, encoded.size() - at, channels,
+                                        decodedTs, decoded, &blockBytes);
+        at += blockBytes;
+    }
+    const auto decodeEnd = std::chrono::steady_clock::now();
+
+    ok = ok && decoded.size() == input.size() && decodedTs.size() == timestamps.size()
+         && std::memcmp(decoded.data(), input.data(), input.size() * sizeof(float)) == 0
+         && std::memcmp(decodedTs.data(), timestamps.data(), timestamps.size() * sizeof(double)) == 0;
+
+    const double rawBytes = static_cast<double>(totalRows) * (8.0 + 4.0 * channels);
+    const double encodeSec = std::chrono::duration<double>(encodeEnd - encodeStart).count();
+    const double decodeSec = std::chrono::duration<double>(decodeEnd - decodeStart).count();
+
+    std::printf("EegBlockCodec: %d channels, %.0f Hz, %s\n", channels, rate,
+                quantized ? "quantized (24-bit ADC steps)" : "continuous float");
+    std::printf("  ratio %.2f : 1 (%.2f bits/value)  encode x%.0f real time  decode x%.0f  %s\n",
+                rawBytes / encoded.size(), 8.0 * encoded.size() / (double(totalRows) * channels),
+                seconds / encodeSec, seconds / decodeSec, ok ? "round trip exact" : "MISMATCH");
+
+    return ok ? 0 : 1;
+}
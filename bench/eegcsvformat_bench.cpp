@@ -0,0 +1,160 @@
+/*
+ * ==========================================================================
+ *  eegcsvformat_bench.cpp — EEG CSV Row Formatting: QString vs appendFixed
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Formats the same sample rows the way RecordingWorker wrote CSV
+ *    before (QString::number per value through a QTextStream) and the way
+ *    it does now (appendFixed() into one byte buffer), times both in rows
+ *    per second and checks that the bytes are identical. Built only with
+ *    -DVIDEOEEG_BUILD_BENCHMARKS=ON; links Qt Core for the reference path.
+ *
+ *  USAGE:
+ *    eegcsvformat_bench [rows] [channels]
+ *    Defaults: 100000 rows of 64 channels.
+ *
+ *  DATA:
+ *    Timestamps as LSL delivers them (≈ 10⁵ s, 2 kHz steps) and Gaussian
+ *    μV values, with edge cases mixed in: ±0, values that round to
+ *    "-0.0000", halfway cases, NaN of either sign, ±infinity, ±FLT_MAX
+ *    and denormals.
+ *
+ *  OUTPUT:
+ *    Rows per second for both paths and the speed-up. Exit code 1 (after
+ *    printing the first differing row) if the outputs differ.
+ *
+ * ==========================================================================
+ */
+
+#include "eegcsvformat.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QTextStream>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+/* Old path: one QString per value, streamed as in the former writeEegChunk(). */
+void formatWithQString(const std::vector<double>& timestamps, const std::vector<float>& values,
+                       int channels, QByteArray& out)
+{
+    out.clear();
+    QTextStream stream(&out, QIODevice::WriteOnly);
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        stream << QString::number(timestamps[i], 'f', 6);
+        const float* row = values.data() + i * size_t(channels);
+        for (int ch = 0; ch < channels; ++ch)
+            stream << ',' << QString::number(row[ch], 'f', 4);
+        stream << '\n';
+    }
+    stream.flush();
+}
+
+/* New path: RecordingWorker::appendEegCsvRows(). */
+void formatWithAppendFixed(const std::vector<double>& timestamps, const std::vector<float>& values,
+                           int channels, std::vector<char>& out)
+{
+    out.clear();
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        appendFixed(out, timestamps[i], 6);
+        const float* row = values.data() + i * size_t(channels);
+        for (int ch = 0; ch < channels; ++ch) {
+            out.push_back(',');
+            appendFixed(out, double(row[ch]), 4);
+        }
+        out.push_back('\n');
+    }
+}
+
+template <typename F>
+double bestSeconds(F&& run)
+{
+    double best = 1e30;
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int rows = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int channels = argc > 2 ? std::atoi(argv[2]) : 64;
+    if (rows <= 0 || channels <= 0) {
+        std::fprintf(stderr, "usage: %s [rows] [channels]\n", argv[0]);
+        return 2;
+    }
+
+    std::mt19937 rng(11);
+    std::normal_distribution<float> microvolts(0.0f, 50.0f);
+    std::uniform_real_distribution<double> jitter(-2e-4, 2e-4);
+    std::vector<double> timestamps(static_cast<size_t>(rows));
+    std::vector<float> values(size_t(rows) * size_t(channels));
+    for (int i = 0; i < rows; ++i)
+        timestamps[size_t(i)] = 123456.0 + i / 2000.0 + jitter(rng);
+    for (float& v : values)
+        v = microvolts(rng);
+
+    const float edgeCases[] = {
+        0.0f, -0.0f, -0.00004f, -0.00005f, 0.00005f, -0.00001f, 0.12345f, -0.12345f,
+        1.00005f, 2.5e-5f, -2.5e-5f,
+        std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min(),
+    };
+    const size_t edgeCount = sizeof(edgeCases) / sizeof(edgeCases[0]);
+    for (size_t i = 0; i < values.size(); i += 97)
+        values[i] = edgeCases[(i / 97) % edgeCount];
+    timestamps[0] = 0.0;
+    if (rows > 1)
+        timestamps[1] = -0.0;
+
+    QByteArray reference;
+    std::vector<char> formatted;
+    const double qstringSec = bestSeconds([&] { formatWithQString(timestamps, values, channels, reference); });
+    const double appendSec = bestSeconds([&] { formatWithAppendFixed(timestamps, values, channels, formatted); });
+
+    std::printf("EEG CSV formatting: %d rows x %d channels (%.1f MB)\n",
+                rows, channels, double(formatted.size()) / 1e6);
+    std::printf("  QString::number + QTextStream  %10.0f rows/s\n", rows / qstringSec);
+    std::printf("  appendFixed                    %10.0f rows/s  (x%.1f)\n",
+                rows / appendSec, qstringSec / appendSec);
+
+    const size_t common = std::min(size_t(reference.size()), formatted.size());
+    const auto mismatch = std::mismatch(reference.constData(), reference.constData() + common,
+                                        formatted.data());
+    if (size_t(reference.size()) == formatted.size() && mismatch.first == reference.constData() + common) {
+        std::printf("  output byte-identical\n");
+        return 0;
+    }
+
+    const size_t at = size_t(mismatch.first - reference.constData());
+    const char* rowStart = formatted.data() + at;
+    while (rowStart > formatted.data() && rowStart[-1] != '\n')
+        --rowStart;
+    const size_t offset = size_t(rowStart - formatted.data());
+    const char* refEnd = static_cast<const char*>(
+        std::memchr(reference.constData() + offset, '\n', size_t(reference.size()) - offset));
+    const char* newEnd = static_cast<const char*>(
+        std::memchr(rowStart, '\n', formatted.size() - offset));
+    std::printf("  OUTPUT DIFFERS at byte %zu\n    QString:     %.*s\n    appendFixed: %.*s\n", at,
+                int((refEnd ? refEnd : reference.constData() + reference.size()) - (reference.constData() + offset)),
+                reference.constData() + offset,
+                int((newEnd ? newEnd : formatted.data() + formatted.size()) - rowStart), rowStart);
+    return 1;
+}
@@ -0,0 +1,168 @@
+/*
+ * ==========================================================================
+ *  eeginterpkernel_bench.cpp — Microbenchmark for EegInterpKernel
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Times every EegInterpKernel path and interpolation mode on the same
+ *    synthetic sync ring stored both ways: channel-major planes
+ *    (weightedTaps, as for rows older than the ring's recent window) and
+ *    row-major rows (weightedRows in each variant, as for the recent
+ *    window). Checks every path against the planes result bit for bit,
+ *    and checks that each mode reconstructs a slow sine between samples.
+ *    Built only with -DVIDEOEEG_BUILD_BENCHMARKS=ON; no Qt required.
+ *
+ *  USAGE:
+ *    eeginterpkernel_bench [channels] [ringRows]
+ *    Defaults: 128 channels, 60000 rows (30 s at 2 kHz). Queries are
+ *    spread over the whole ring, so with the defaults most taps miss the
+ *    cache; 1024 rows (the recent window) keeps everything cached.
+ *
+ *  OUTPUT:
+ *    One line per mode and path: ns per query (all channels), queries
+ *    per second, speed-up over planes, and the worst interpolation error
+ *    on a 10 Hz sine at 2 kHz. Exit code 1 if any path disagrees with
+ *    planes.
+ *
+ * ==========================================================================
+ */
+
+#include "eeginterpkernel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using EegInterpKernel::Mode;
+using EegInterpKernel::Variant;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double RATE = 2000.0;
+constexpr double SINE_HZ = 10.0;
+
+const char* modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Cubic: return "cubic";
+    case Mode::Sinc: return "sinc";
+    case Mode::Linear: break;
+    }
+    return "linear";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int channels = argc > 1 ? std::atoi(argv[1]) : 128;
+    const int rows = argc > 2 ? std::atoi(argv[2]) : 60000;
+    if (channels <= 0 || rows < 16)
+    {
+        std::fprintf(stderr, "usage: %s [channels] [ringRows >= 16]\n", argv[0]);
+        return 2;
+    }
+
+    /* Channel c carries a 10 Hz sine with phase c, amplitude 100 μV. */
+    std::vector<float> planes(static_cast<size_t>(channels) * rows);
+    std::vector<float> rowMajor(planes.size());
+    for (int c = 0; c < channels; ++c)
+        for (int r = 0; r < rows; ++r)
+        {
+            const float v = static_cast<float>(100.0 * std::sin(2.0 * PI * SINE_HZ * r / RATE + c));
+            planes[static_cast<size_t>(c) * rows + r] = v;
+            rowMajor[static_cast<size_t>(r) * channels + c] = v;
+        }
+
+    /* Random query positions, away from the ends so every tap exists. */
+    const int queries = 4096;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> position(8.0, rows - 8.0);
+    std::vector<double> at(queries);
+    for (double& p : at)
+        p = position(rng);
+
+    std::vector<float> output(static_cast<size_t>(queries) * channels);
+    std::vector<float> reference;
+    bool mismatch = false;
+
+    std::printf("EegInterpKernel: %d channels, %d ring rows, best = %s\n",
+                channels, rows, EegScaleKernel::variantName(EegScaleKernel::bestVariant()));
+
+    for (Mode mode : { Mode::Linear, Mode::Cubic, Mode::Sinc })
+    {
+        const int taps = EegInterpKernel::tapCount(mode);
+        double planesNs = 0.0;
+
+        /* -1 = planes, otherwise rows with that variant. */
+        for (int path : { -1, int(Variant::Scalar), int(Variant::Sse2), int(Variant::Avx2) })
+        {
+            const auto run = [&] {
+                for (int q = 0; q < queries; ++q)
+                {
+                    /* r = first row at or after the query, t from r − 1. */
+                    const int r = static_cast<int>(std::ceil(at[q]));
+                    const double t = at[q] - (r - 1);
+                    int slots[EegInterpKernel::MAX_TAPS];
+                    const float* tapRows[EegInterpKernel::MAX_TAPS];
+                    float weights[EegInterpKernel::MAX_TAPS];
+                    for (int k = 0; k < taps; ++k)
+                    {
+                        slots[k] = r + EegInterpKernel::firstTapOffset(mode) + k;
+                        tapRows[k] = rowMajor.data() + static_cast<size_t>(slots[k]) * channels;
+                    }
+                    EegInterpKernel::weights(mode, t, weights);
+                    float* out = output.data() + static_cast<size_t>(q) * channels;
+                    if (path < 0)
+                        EegInterpKernel::weightedTaps(planes.data(), rows, slots, weights, taps, channels, out);
+                    else
+                        EegInterpKernel::weightedRows(Variant(path), tapRows, weights, taps, channels, out);
+                }
+            };
+
+            run();  // Warm-up
+            const int iterations = 20;
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+                run();
+            const double ns = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / (iterations * queries);
+
+            double worst = 0.0;
+            for (int q = 0; q < queries; ++q)
+                for (int c = 0; c < channels; ++c)
+                {
+                    const double exact = 100.0 * std::sin(2.0 * PI * SINE_HZ * at[q] / RATE + c);
+                    worst = std::max(worst, std::abs(output[static_cast<size_t>(q) * channels + c] - exact));
+                }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%s", path < 0 ? "planes"
+                          : EegScaleKernel::variantName(Variant(path)));
+            if (path < 0)
+            {
+                planesNs = ns;
+                reference = output;
+            }
+            else if (std::memcmp(reference.data(), output.data(), reference.size() * sizeof(float)) != 0)
+            {
+                std::printf("  %-6s rows %-6s MISMATCH against planes\n", modeName(mode), name);
+                mismatch = true;
+                continue;
+            }
+
+            std::printf("  %-6s %-4s %-6s %8.1f ns/query  %7.2f Mqueries/s  x%.2f  max error %.4f uV\n",
+                        modeName(mode), path < 0 ? "" : "rows", name, ns,
+                        1e3 / ns, planesNs / ns, worst);
+        }
+    }
+
+    return mismatch ? 1 : 0;
+}
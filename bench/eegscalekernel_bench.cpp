@@ -0,0 +1,138 @@
+/*
+ * ==========================================================================
+ *  eegscalekernel_bench.cpp — Microbenchmark for EegScaleKernel
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Times every EegScaleKernel variant on a synthetic interleaved chunk
+ *    and checks each against the scalar reference, so a change that slows
+ *    the display transform (or breaks a SIMD path) is visible at a glance.
+ *    Built only with -DVIDEOEEG_BUILD_BENCHMARKS=ON; no Qt required.
+ *
+ *  USAGE:
+ *    eegscalekernel_bench [hardwareChannels] [selectedChannels] [rowsPerChunk]
+ *    Defaults: 128 hardware channels, 128 selected (reversed order, so the
+ *    gather is not a straight copy), 64 rows per chunk.
+ *
+ *  OUTPUT:
+ *    One line per variant: ns per output sample, throughput, and speedup
+ *    over scalar. Exit code 1 if any variant disagrees with scalar.
+ *
+ * ==========================================================================
+ */
+
+#include "eegscalekernel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using EegScaleKernel::Variant;
+
+namespace {
+
+struct Workload
+{
+    int stride = 0;
+    int channels = 0;
+    int rows = 0;
+    std::vector<float> samples;
+    std::vector<int> source;
+    std::vector<float> offset;
+    std::vector<float> output;
+    std::vector<float*> out;
+};
+
+Workload makeWorkload(int stride, int channels, int rows)
+{
+    Workload w;
+    w.stride = stride;
+    w.channels = channels;
+    w.rows = rows;
+
+    std::mt19937 rng(42);
+    std::normal_distribution<float> microvolts(0.0f, 50.0f);
+    w.samples.resize(static_cast<size_t>(stride) * rows);
+    for (float& v : w.samples)
+        v = microvolts(rng);
+
+    w.source.resize(channels);
+    w.offset.resize(channels);
+    for (int c = 0; c < channels; ++c)
+    {
+        w.source[c] = (stride - 1 - c % stride);
+        w.offset[c] = static_cast<float>((channels - 1 - c) * 40.0);
+    }
+
+    w.output.assign(static_cast<size_t>(channels) * rows, 0.0f);
+    w.out.resize(channels);
+    for (int c = 0; c < channels; ++c)
+        w.out[c] = w.output.data() + static_cast<size_t>(c) * rows;
+    return w;
+}
+
+double timeVariant(Variant variant, Workload& w, int iterations)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        EegScaleKernel::scaleGather(variant, w.samples.data(), w.stride, w.rows,
+                                    w.source.data(), w.offset.data(), 0.54f,
+                                    w.channels, w.out.data());
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int stride = argc > 1 ? std::atoi(argv[1]) : 128;
+    const int channels = argc > 2 ? std::atoi(argv[2]) : 128;
+    const int rows = argc > 3 ? std::atoi(argv[3]) : 64;
+    if (stride <= 0 || channels <= 0 || rows <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [hardwareChannels] [selectedChannels] [rowsPerChunk]\n", argv[0]);
+        return 2;
+    }
+
+    Workload w = makeWorkload(stride, channels, rows);
+    const double outputs = static_cast<double>(channels) * rows;
+    const int iterations = std::max(1, static_cast<int>(2e8 / outputs / 10));
+
+    std::vector<float> reference;
+    double scalarNs = 0.0;
+    bool mismatch = false;
+
+    std::printf("EegScaleKernel: %d hw channels, %d selected, %d rows/chunk, best = %s\n",
+                stride, channels, rows, EegScaleKernel::variantName(EegScaleKernel::bestVariant()));
+
+    for (Variant variant : { Variant::Scalar, Variant::Sse2, Variant::Avx2 })
+    {
+        timeVariant(variant, w, iterations / 10 + 1);   // Warm-up
+        const double ns = timeVariant(variant, w, iterations);
+        const double perSample = ns / (iterations * outputs);
+
+        if (variant == Variant::Scalar)
+        {
+            scalarNs = ns;
+            reference = w.output;
+        }
+        else if (std::memcmp(reference.data(), w.output.data(), reference.size() * sizeof(float)) != 0)
+        {
+            std::printf("  %-6s MISMATCH against scalar\n", EegScaleKernel::variantName(variant));
+            mismatch = true;
+            continue;
+        }
+
+        std::printf("  %-6s %7.3f ns/sample  %8.1f Msamples/s  x%.2f\n",
+                    EegScaleKernel::variantName(variant), perSample,
+                    1e3 / perSample, scalarNs / ns);
+    }
+
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * ==========================================================================
+ *  eegsyncring_bench.cpp — Timestamp Lookup Benchmark for EegSyncRing
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Fills a 30 s sync ring at a regular rate (with optional dropouts and
+ *    timestamp jitter) and times frame-style lookups through the
+ *    regular-sampling prediction (lowerBound) against the plain binary
+ *    search (binarySearch). Every lookup is checked against the binary
+ *    search result, and the row-major recent window against the channel
+ *    planes. Built only with -DVIDEOEEG_BUILD_BENCHMARKS=ON; no Qt
+ *    required.
+ *
+ *  USAGE:
+ *    eegsyncring_bench [samplingRateHz] [gapsPerMinute] [jitterFraction]
+ *    Defaults: 2000 Hz, 2 gaps per minute, 0.1 (jitter σ as a fraction of
+ *    the sample interval).
+ *
+ *  OUTPUT:
+ *    ns per lookup for both paths, the prediction hit rate and the number
+ *    of lookups where the two disagree. That can only happen when jitter
+ *    reorders timestamps (neither result is then meaningful); exit code 1
+ *    if it happens while the timestamps are sorted, or if a recent-window
+ *    row differs from the planes.
+ *
+ * ==========================================================================
+ */
+
+#include "eegsyncring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const double rate = argc > 1 ? std::atof(argv[1]) : 2000.0;
+    const double gapsPerMinute = argc > 2 ? std::atof(argv[2]) : 2.0;
+    const double jitter = argc > 3 ? std::atof(argv[3]) : 0.1;
+    if (rate <= 0.0 || gapsPerMinute < 0.0 || jitter < 0.0)
+    {
+        std::fprintf(stderr, "usage: %s [samplingRateHz] [gapsPerMinute] [jitterFraction]\n", argv[0]);
+        return 2;
+    }
+
+    /* 60 s of 32-row chunks into a 30 s ring; a dropout skips 100 ms. */
+    const int capacity = static_cast<int>(rate * 30.0);
+    const int rows = 32;
+    const double interval = 1.0 / rate;
+    const double gapChance = gapsPerMinute * rows / (rate * 60.0);
+    EegSyncRing ring(capacity, 1);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> noise(0.0, jitter * interval);
+    double t = 1000.0;
+    float written = 0.0f;   // Row counter as the sample value (exact below 2^24)
+    for (int chunk = 0; chunk < static_cast<int>(rate * 60.0) / rows; ++chunk)
+    {
+        if (uniform(rng) < gapChance)
+            t += 0.1;
+        ring.append(rows, [&](int, float* out) {
+            out[0] = written++;
+            t += interval;
+            return t + noise(rng);
+        });
+    }
+
+    /* Frame timestamps spread over the whole window. */
+    const EegSyncRing::Window window = ring.window();
+    bool sorted = true;
+    for (std::uint64_t row = window.first + 1; row < window.end; ++row)
+        sorted = sorted && ring.timestamp(row - 1) <= ring.timestamp(row);
+    int recentMismatches = 0;
+    for (std::uint64_t row = window.first; row < window.end; ++row)
+    {
+        if (ring.inRecent(window, row))
+            recentMismatches += ring.recentRow(row)[0] != ring.value(row, 0);
+    }
+    const double oldest = ring.timestamp(window.first);
+    const double newest = ring.timestamp(window.end - 1);
+    std::vector<double> queries(1 << 20);
+    for (double& q : queries)
+        q = oldest + uniform(rng) * (newest - oldest);
+
+    volatile std::uint64_t sink = 0;
+    int hits = 0;
+    int mismatches = 0;
+    std::vector<std::uint64_t> expected(queries.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i)
+        sink += expected[i] = ring.binarySearch(window, queries[i]);
+    const double searchNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / queries.size();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        bool predicted = false;
+        const std::uint64_t row = ring.lowerBound(window, queries[i], &predicted);
+        hits += predicted;
+        mismatches += row != expected[i];
+        sink += row;
+    }
+    const double predictNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / queries.size();
+
+    std::printf("EegSyncRing: %.0f Hz, %d rows, %.1f gaps/min, jitter %.2f\n",
+                rate, capacity, gapsPerMinute, jitter);
+    std::printf("  binary search %6.1f ns  predicted %6.1f ns  hit rate %.1f%%  mismatches %d%s\n",
+                searchNs, predictNs, 100.0 * hits / queries.size(), mismatches,
+                sorted ? "" : " (timestamps unsorted)");
+    std::printf("  recent window %d rows, mismatches %d\n", ring.recentCapacity(), recentMismatches);
+
+    return ((mismatches == 0 || !sorted) && recentMismatches == 0) ? 0 : 1;
+}
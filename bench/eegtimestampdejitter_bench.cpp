@@ -0,0 +1,199 @@
+/*
+ * ==========================================================================
+ *  eegtimestampdejitter_bench.cpp — Accuracy and Cost of the LSL Dejitter
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Simulates an amplifier stream as LSLStreamReader sees it — a crystal
+ *    that is off by 30 ppm, chunks stamped when the outlet pushed them
+ *    (exponential push latency) and back-dated at the nominal rate — runs
+ *    it through EegTimestampDejitter and compares every output timestamp
+ *    with the true sample time. Built only with
+ *    -DVIDEOEEG_BUILD_BENCHMARKS=ON; no Qt required.
+ *
+ *  SCENARIOS:
+ *    steady    15 min without loss
+ *    dropout   the same stream losing 100 ms of samples at 300 s
+ *    dropouts  a 100 ms, a 20 ms and a 1-sample loss, plus an outlet
+ *              restart (new sample phase) and a 5 min clean tail
+ *    Each is run at 2 kHz with 40-row chunks and 4 ms mean push latency,
+ *    and at 256 Hz with 8-row chunks and 50 µs latency (hardware-stamped
+ *    outlets), where a single lost sample is far outside the jitter.
+ *
+ *  USAGE:
+ *    eegtimestampdejitter_bench
+ *
+ *  OUTPUT:
+ *    Per scenario the error against the true sample times, minus the
+ *    constant push latency the fit cannot see: RMS in the windows before
+ *    and after the first event, the worst error from 10 s after the last
+ *    event on, and the gap counters. Also ns per sample. Exit code 1 if
+ *    the settled error exceeds the stream's limits.
+ *
+ * ==========================================================================
+ */
+
+#include "eegtimestampdejitter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Stream
+{
+    const char* name;
+    double rate;
+    int rows;
+    double meanLatency;     // Exponential push latency (s)
+    double limitRms;        // Settled error limits (s)
+    double limitMax;
+};
+
+/* A loss of `lost` samples after `at` seconds of stream. A phase step
+ * additionally shifts the sampling grid by `phase` periods (an outlet
+ * restarted against a new sample clock). */
+struct Event
+{
+    double at;
+    long lost;
+    double phase;
+};
+
+struct Scenario
+{
+    const char* name;
+    double seconds;
+    std::vector<Event> events;
+};
+
+struct Window
+{
+    double from, to;
+    double sumSq = 0.0;
+    long count = 0;
+    double rms() const { return count ? std::sqrt(sumSq / double(count)) : 0.0; }
+};
+
+bool run(const Stream& stream, const Scenario& scenario)
+{
+    const double truePeriod = (1.0 / stream.rate) * (1.0 + 30e-6);
+    std::mt19937 rng(7);
+    std::exponential_distribution<double> latency(1.0 / stream.meanLatency);
+
+    EegTimestampDejitter dejitter;
+    dejitter.reset(stream.rate);
+
+    const double firstEvent = scenario.events.empty() ? scenario.seconds : scenario.events.front().at;
+    const double lastEvent = scenario.events.empty() ? 0.0 : scenario.events.back().at;
+    std::vector<Window> windows = {
+        { 5.0, 30.0 }, { 30.0, firstEvent },
+        { firstEvent, firstEvent + 1.0 }, { firstEvent + 1.0, firstEvent + 10.0 },
+        { firstEvent + 10.0, firstEvent + 60.0 }, { firstEvent + 60.0, scenario.seconds },
+    };
+    double settledMax = 0.0;
+    double settledSumSq = 0.0;
+    long settledCount = 0;
+
+    std::vector<double> timestamps(stream.rows);
+    std::vector<double> truth(stream.rows);
+    const double t0 = 5000.0;
+    double phase = 0.0;
+    long sample = 0;
+    size_t nextEvent = 0;
+    double busy = 0.0;
+    const long total = long(scenario.seconds * stream.rate);
+    while (sample < total)
+    {
+        if (nextEvent < scenario.events.size() && sample >= long(scenario.events[nextEvent].at * stream.rate))
+        {
+            sample += scenario.events[nextEvent].lost;
+            phase += scenario.events[nextEvent].phase;
+            ++nextEvent;
+        }
+
+        const double push = t0 + (double(sample + stream.rows - 1) + phase) * truePeriod + latency(rng);
+        for (int j = 0; j < stream.rows; ++j)
+        {
+            timestamps[j] = push - double(stream.rows - 1 - j) / stream.rate;
+            truth[j] = t0 + (double(sample + j) + phase) * truePeriod;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        dejitter.process(timestamps.data(), timestamps.size());
+        busy += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (int j = 0; j < stream.rows; ++j)
+        {
+            const double at = double(sample + j) / stream.rate;
+            const double error = timestamps[j] - truth[j] - stream.meanLatency;
+            for (Window& window : windows)
+            {
+                if (at >= window.from && at < window.to)
+                {
+                    window.sumSq += error * error;
+                    ++window.count;
+                }
+            }
+            if (at >= std::max(30.0, lastEvent + 10.0))
+            {
+                settledMax = std::max(settledMax, std::fabs(error));
+                settledSumSq += error * error;
+                ++settledCount;
+            }
+        }
+        sample += stream.rows;
+    }
+
+    const double settledRms = settledCount ? std::sqrt(settledSumSq / double(settledCount)) : 0.0;
+    std::printf("%-6s %-9s RMS ms:", stream.name, scenario.name);
+    for (const Window& window : windows)
+    {
+        if (window.count)
+            std::printf(" [%.0f,%.0f) %.3f", window.from, window.to, window.rms() * 1e3);
+    }
+    std::printf("\n                 settled RMS %.3f max %.3f ms, bridged %d, resets %d, %.1f ns/sample\n",
+                settledRms * 1e3, settledMax * 1e3, dejitter.bridgedGaps(), dejitter.gapResets(),
+                busy * 1e9 / double(total));
+
+    return settledRms <= stream.limitRms && settledMax <= stream.limitMax;
+}
+
+} // namespace
+
+int main()
+{
+    const Stream streams[] = {
+        { "2kHz", 2000.0, 40, 0.004, 0.5e-3, 2e-3 },
+        { "256Hz", 256.0, 8, 0.00005, 0.02e-3, 0.1e-3 },
+    };
+    const Scenario scenarios[] = {
+        { "steady", 900.0, {} },
+        { "dropout", 900.0, { { 300.0, 200, 0.0 } } },
+        { "dropouts", 900.0, { { 300.0, 200, 0.0 }, { 360.0, 40, 0.0 }, { 420.0, 1, 0.0 },
+                               { 480.0, 0, 0.37 } } },
+    };
+
+    bool ok = true;
+    for (const Stream& stream : streams)
+    {
+        for (const Scenario& scenario : scenarios)
+        {
+            Scenario scaled = scenario;
+            for (Event& event : scaled.events)
+                event.lost = long(double(event.lost) * stream.rate / 2000.0 + 0.5);
+            // Keep the single-sample loss at one sample on every stream
+            for (size_t i = 0; i < scenario.events.size(); ++i)
+            {
+                if (scenario.events[i].lost == 1)
+                    scaled.events[i].lost = 1;
+            }
+            ok = run(stream, scaled) && ok;
+        }
+    }
+    return ok ? 0 : 1;
+}
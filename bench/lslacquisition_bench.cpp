@@ -0,0 +1,276 @@
+/*
+ * ==========================================================================
+ *  lslacquisition_bench.cpp — LSLStreamReader Delivery and Stop Latency
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Runs the real LSLStreamReader against an in-process LSL outlet and
+ *    measures what the acquisition modes promise: how long a pushed
+ *    chunk takes to reach a Direct dispatcher consumer in each mode, and
+ *    how long requestStop() takes to end the reader thread. Built only
+ *    with -DVIDEOEEG_BUILD_BENCHMARKS=ON; links Qt Core and liblsl.
+ *
+ *  SETUP:
+ *    A pusher thread feeds a type "EEG" outlet at real-time pace
+ *    (channels x rate, `rows` samples per push). Channel 0 of every row
+ *    carries the sample index, so the consumer can look up when the
+ *    newest row of each delivered chunk was pushed; the reader's
+ *    dejittered timestamps are not used for timing. The reader resolves
+ *    type "EEG", so run it on a machine without a live amplifier stream.
+ *
+ *  PHASES:
+ *    latency   LatencyOptimized for `seconds`
+ *    cpu       CpuOptimized for `seconds`, switched at runtime
+ *    stop      pushing paused, mode back to LatencyOptimized, then
+ *              requestStop() + quit() + wait() while the reader idles in
+ *              its blocking wait
+ *    The first second of each phase is not counted.
+ *
+ *  USAGE:
+ *    lslacquisition_bench [seconds] [channels] [rate] [rows]
+ *    Defaults: 5 s per phase, 32 channels at 2000 Hz, 4-row pushes.
+ *
+ *  OUTPUT:
+ *    Median, p95 and max delivery latency and mean rows per chunk per
+ *    mode; stop latency. Exit code 1 if the latency-optimized median is
+ *    not below the CPU-optimized one, if either mode delivered nothing,
+ *    or if the stop takes longer than STOP_LIMIT_S or does not close the
+ *    inlet on the reader thread.
+ *
+ * ==========================================================================
+ */
+
+#include "lslstreamreader.h"
+#include "eegchunkdispatcher.h"
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QThread>
+
+#include <lsl_cpp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/* One wait timeout (100 ms) plus scheduling slack. */
+constexpr double STOP_LIMIT_S = 0.5;
+
+struct Stats
+{
+    double median = 0.0, p95 = 0.0, max = 0.0, rowsPerChunk = 0.0;
+    size_t chunks = 0;
+};
+
+class LatencyProbe
+{
+public:
+    explicit LatencyProbe(size_t maxSamples)
+        : m_pushTimes(new std::atomic<double>[maxSamples]), m_maxSamples(maxSamples)
+    {
+        for (size_t i = 0; i < maxSamples; ++i)
+            m_pushTimes[i].store(0.0, std::memory_order_relaxed);
+    }
+
+    void markPushed(size_t sample, double when) { m_pushTimes[sample].store(when, std::memory_order_release); }
+
+    /* Direct consumer: runs on the reader thread inside publish(). */
+    void onChunk(const EegChunkPtr& chunk)
+    {
+        const double now = lsl::local_clock();
+        const size_t sample = size_t(chunk->value(chunk->sampleCount - 1, 0));
+        if (sample >= m_maxSamples)
+            return;
+        const double pushed = m_pushTimes[sample].load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_counting || pushed <= 0.0)
+            return;
+        m_latencies.push_back(now - pushed);
+        m_rows += size_t(chunk->sampleCount);
+    }
+
+    void startCounting()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latencies.clear();
+        m_rows = 0;
+        m_counting = true;
+    }
+
+    Stats stopCounting()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_counting = false;
+        Stats stats;
+        stats.chunks = m_latencies.size();
+        if (m_latencies.empty())
+            return stats;
+        std::sort(m_latencies.begin(), m_latencies.end());
+        stats.median = m_latencies[m_latencies.size() / 2];
+        stats.p95 = m_latencies[m_latencies.size() * 95 / 100];
+        stats.max = m_latencies.back();
+        stats.rowsPerChunk = double(m_rows) / double(m_latencies.size());
+        return stats;
+    }
+
+private:
+    std::unique_ptr<std::atomic<double>[]> m_pushTimes;
+    size_t m_maxSamples;
+    std::mutex m_mutex;
+    std::vector<double> m_latencies;
+    size_t m_rows = 0;
+    bool m_counting = false;
+};
+
+void printStats(const char* mode, const Stats& stats)
+{
+    std::printf("  %-17s median %6.2f  p95 %6.2f  max %6.2f ms  %5.1f rows/chunk  (%zu chunks)\n",
+                mode, stats.median * 1e3, stats.p95 * 1e3, stats.max * 1e3, stats.rowsPerChunk,
+                stats.chunks);
+}
+
+void sleepFor(double seconds)
+{
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+    const int channels = argc > 2 ? std::atoi(argv[2]) : 32;
+    const double rate = argc > 3 ? std::atof(argv[3]) : 2000.0;
+    const int rows = argc > 4 ? std::atoi(argv[4]) : 4;
+    if (seconds < 2.0 || channels <= 0 || rate <= 0.0 || rows <= 0) {
+        std::fprintf(stderr, "usage: %s [seconds>=2] [channels] [rate] [rows]\n", argv[0]);
+        return 2;
+    }
+
+    /* Room for every phase plus the resolve and shutdown margins. */
+    const size_t maxSamples = size_t((3.0 * seconds + 30.0) * rate) + size_t(rows);
+    LatencyProbe probe(maxSamples);
+
+    lsl::stream_outlet outlet(lsl::stream_info("VideoEegBench", "EEG", channels, rate,
+                                               lsl::cf_float32, "videoeeg-lslacquisition-bench"));
+
+    std::atomic<bool> pushing{true};
+    std::atomic<bool> quitPusher{false};
+    std::thread pusher([&] {
+        std::vector<float> buffer(size_t(rows) * size_t(channels), 0.0f);
+        const auto period = std::chrono::duration<double>(double(rows) / rate);
+        auto next = std::chrono::steady_clock::now();
+        size_t sample = 0;
+        while (!quitPusher && sample + size_t(rows) <= maxSamples) {
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+            std::this_thread::sleep_until(next);
+            if (!pushing)
+                continue;
+            for (int r = 0; r < rows; ++r)
+                buffer[size_t(r) * size_t(channels)] = float(sample + size_t(r));
+            probe.markPushed(sample + size_t(rows) - 1, lsl::local_clock());
+            outlet.push_chunk_multiplexed(buffer.data(), buffer.size());
+            sample += size_t(rows);
+        }
+    });
+
+    EegChunkDispatcher dispatcher;
+    QObject consumerContext;
+    dispatcher.subscribe(&consumerContext, [&probe](const EegChunkPtr& chunk) { probe.onChunk(chunk); },
+                         Qt::DirectConnection);
+
+    QThread readerThread;
+    auto reader = std::make_unique<LSLStreamReader>();
+    reader->setDispatcher(&dispatcher);
+    reader->setAcquisitionMode(LSLStreamReader::AcquisitionMode::LatencyOptimized);
+    reader->moveToThread(&readerThread);
+
+    std::atomic<bool> connected{false};
+    std::atomic<bool> closedOnReaderThread{false};
+    QObject::connect(reader.get(), &LSLStreamReader::streamConnected, reader.get(),
+                     [&] { connected = true; }, Qt::DirectConnection);
+    QObject::connect(reader.get(), &LSLStreamReader::inletReady, reader.get(),
+                     [&](lsl::stream_inlet* inlet) {
+        if (!inlet && QThread::currentThread() == &readerThread)
+            closedOnReaderThread = true;
+    }, Qt::DirectConnection);
+    QObject::connect(reader.get(), &LSLStreamReader::errorOccurred, reader.get(),
+                     [](const QString& error) {
+        std::fprintf(stderr, "  reader error: %s\n", qPrintable(error));
+    }, Qt::DirectConnection);
+
+    readerThread.start();
+    QMetaObject::invokeMethod(reader.get(), &LSLStreamReader::onStartReading, Qt::QueuedConnection);
+
+    for (int waited = 0; !connected && waited < 100; ++waited)
+        sleepFor(0.1);
+    if (!connected) {
+        std::printf("LSL acquisition: stream not resolved\n");
+        reader->requestStop();
+        readerThread.quit();
+        readerThread.wait();
+        quitPusher = true;
+        pusher.join();
+        return 1;
+    }
+
+    std::printf("LSL acquisition: %d channels at %.0f Hz, %d rows per push, %.0f s per mode\n",
+                channels, rate, rows, seconds);
+
+    sleepFor(1.0);
+    probe.startCounting();
+    sleepFor(seconds - 1.0);
+    const Stats latency = probe.stopCounting();
+    printStats("LatencyOptimized", latency);
+
+    reader->setAcquisitionMode(LSLStreamReader::AcquisitionMode::CpuOptimized);
+    sleepFor(1.0);
+    probe.startCounting();
+    sleepFor(seconds - 1.0);
+    const Stats cpu = probe.stopCounting();
+    printStats("CpuOptimized", cpu);
+
+    /* Idle stop: nothing arrives, so the reader sits in its timed wait. */
+    pushing = false;
+    reader->setAcquisitionMode(LSLStreamReader::AcquisitionMode::LatencyOptimized);
+    sleepFor(0.5);
+    const auto stopStart = std::chrono::steady_clock::now();
+    reader->requestStop();
+    readerThread.quit();
+    readerThread.wait();
+    const double stopSec =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - stopStart).count();
+    std::printf("  stop              %6.1f ms (limit %.0f ms), inlet closed on reader thread: %s\n",
+                stopSec * 1e3, STOP_LIMIT_S * 1e3, closedOnReaderThread ? "yes" : "no");
+
+    reader.reset();
+    dispatcher.unsubscribe(&consumerContext);
+    quitPusher = true;
+    pusher.join();
+
+    bool ok = true;
+    if (latency.chunks == 0 || cpu.chunks == 0) {
+        std::printf("  FAIL: a mode delivered no chunks\n");
+        ok = false;
+    } else if (latency.median >= cpu.median) {
+        std::printf("  FAIL: latency-optimized median is not below the CPU-optimized one\n");
+        ok = false;
+    } else {
+        std::printf("  latency-optimized median %.1fx lower\n", cpu.median / latency.median);
+    }
+    if (stopSec > STOP_LIMIT_S || !closedOnReaderThread) {
+        std::printf("  FAIL: stop too slow or inlet not closed by the reader\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
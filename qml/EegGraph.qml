@@ -1,7 +1,6 @@
 import QtQuick
 import QtQuick.Controls
 import QtQuick.Layouts
-import QtGraphs
 import videoEeg
 
 Rectangle {
@@ -44,7 +43,6 @@ Rectangle {
     onSelectedChannelsChanged: {
         if(selectedChannels.length > 0) {
             updateAxisY()
-            eegGraph.createAllSeries(selectedChannels)
         }
     }
 
@@ -61,8 +59,8 @@ Rectangle {
         var spacing = dynamicChannelSpacing
         var margin = spacing * 0.5
 
-        yAxis.min = -margin
-        yAxis.max = (numChannels - 1) * spacing + margin
+        traceView.valueMin = -margin
+        traceView.valueMax = (numChannels - 1) * spacing + margin
     }
 
     function getChannelName(index) {
@@ -178,64 +176,34 @@ Rectangle {
             Layout.fillWidth: true
             Layout.fillHeight: true
 
-            GraphsView {
-                id: eegGraph
+            // Plot area: waveforms, time grid and X-axis labels
+            Item {
+                id: plotArea
                 anchors.fill: parent
                 anchors.margins: 16
+                anchors.bottomMargin: 36
 
-                theme: GraphsTheme {
-                    grid.mainColor: "#2d3e50"
-                    grid.subColor: "#1a2332"
-                    labelTextColor: "#8a9cb5"
-                    plotAreaBackgroundColor: "#0d0f12"
-                    backgroundColor: "#0d0f12"
-                    colorScheme: Qt.Dark
-                }
-
-                axisX: ValueAxis {
-                    id: xAxis
-                    min: 0
-                    max: timeWindowSeconds
-                    tickInterval: 1
-                    subTickCount: 9
-                    labelDecimals: 0
-                    gridVisible: true
-                }
-
-                axisY: ValueAxis {
-                    id: yAxis
-                    min: -50
-                    max: 1050
-                    labelsVisible: false
-                    gridVisible: true
+                EegTraceView {
+                    id: traceView
+                    anchors.fill: parent
+                    clip: true
+                    model: eegData
+                    channelColors: eegGraphContainer.channelColors
+                    gridColor: "#2d3e50"
+                    subGridColor: "#1a2332"
+                    valueMin: -50
+                    valueMax: 1050
                 }
 
-                property var activeSeries: []
-
-                function createAllSeries(channelList) {
-                    for (var i = 0; i < activeSeries.length; i++){
-                        eegGraph.removeSeries(activeSeries[i])
-                        activeSeries[i].destroy()
-                    }
-                    activeSeries = []
-
-                    var count = channelList.length
-
-                    for (var j = 0; j < count; j++){
-                        var series = seriesComponent.createObject(eegGraph, {
-                            "name": getChannelName(j),
-                            "color": getChannelColor(j)
-                        })
-
-                        var mapper = mapperComponent.createObject(series, {
-                            "model": eegData,
-                            "series": series,
-                            "xSection": 0,
-                            "ySection": j + 1
-                        })
-
-                        eegGraph.addSeries(series)
-                        activeSeries.push(series)
+                Repeater {
+                    model: Math.floor(timeWindowSeconds) + 1
+
+                    Label {
+                        x: (index / timeWindowSeconds) * plotArea.width - width / 2
+                        y: plotArea.height + 4
+                        text: index
+                        font.pixelSize: 10
+                        color: "#8a9cb5"
                     }
                 }
             }
@@ -243,16 +211,7 @@ Rectangle {
             // Marker overlay - displays markers as vertical lines with labels
             Item {
                 id: markerOverlay
-                anchors.fill: eegGraph
-                anchors.margins: 16
-
-                // Plot area dimensions (accounting for axis labels)
-                readonly property real plotLeftMargin: 0
-                readonly property real plotTopMargin: 10
-                readonly property real plotRightMargin: 10
-                readonly property real plotBottomMargin: 30
-                readonly property real plotWidth: width - plotLeftMargin - plotRightMargin
-                readonly property real plotHeight: height - plotTopMargin - plotBottomMargin
+                anchors.fill: plotArea
 
                 Repeater {
                     model: markerManager ? markerManager.markers : []
@@ -260,14 +219,11 @@ Rectangle {
                     Item {
                         id: markerItem
 
-                        // Calculate X position based on xPosition (0 to timeWindowSeconds)
-                        readonly property real xPos: markerOverlay.plotLeftMargin +
-                            (modelData.xPosition / timeWindowSeconds) * markerOverlay.plotWidth
-
-                        x: xPos
-                        y: markerOverlay.plotTopMargin
+                        // The overlay is exactly the trace plot area, so xPosition
+                        // (0 to timeWindowSeconds) maps linearly onto its width
+                        x: (modelData.xPosition / timeWindowSeconds) * markerOverlay.width
                         width: 2
-                        height: markerOverlay.plotHeight
+                        height: markerOverlay.height
 
                         // Vertical line
                         Rectangle {
@@ -306,8 +262,8 @@ Rectangle {
             // Calibration bar - professional "step" calibrator at bottom-right of graph
             Item {
                 id: calibrationBar
-                anchors.right: eegGraph.right
-                anchors.bottom: eegGraph.bottom
+                anchors.right: plotArea.right
+                anchors.bottom: plotArea.bottom
                 anchors.margins: 20
                 width: 80
                 height: Math.max(calibrationBar.stepHeight, 30) + 60
@@ -403,16 +359,4 @@ Rectangle {
             }
         }
     }
-
-    Component {
-        id: seriesComponent
-        LineSeries {
-            width: 1
-        }
-    }
-
-    Component {
-        id: mapperComponent
-        XYModelMapper {}
-    }
 }
@@ -48,8 +48,9 @@ ApplicationWindow {
         spacing: eegGraph.dynamicChannelSpacing
         timeWindowSeconds: timeSlider.value
 
-        onChannelsChanged: {
-            eegGraph.selectedChannels = channels
+        // One trace per montage derivation, not per selected channel
+        onChannelNamesChanged: {
+            eegGraph.selectedChannels = channelNames
         }
 
         onSamplingRateChanged: { /* sampling rate updated — no action needed */ }
@@ -67,7 +68,7 @@ ApplicationWindow {
         // Screen.pixelDensity returns pixels per millimeter; convert to DPI
         backend.scaler.screenDpi = Screen.pixelDensity * 25.4
         backend.registerDataModel(eegGraph.dataModel)
-        eegGraph.selectedChannels = channels
+        eegGraph.selectedChannels = backend.channelNames
         backend.startStream()
     }
 
@@ -247,6 +248,52 @@ ApplicationWindow {
                 }
             }
 
+            // WRITE BACKLOG BANNER
+            // Shown while the recording worker lags behind (slow or stalling
+            // disk). Data is still buffered; if it persists, EEG is dropped.
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.preferredHeight: visible ? 40 : 0
+                visible: RecordingManager.writeBacklogWarning && isRecording
+                color: dangerColor
+                z: 5
+
+                Behavior on Layout.preferredHeight {
+                    NumberAnimation { duration: 200 }
+                }
+
+                RowLayout {
+                    anchors.fill: parent
+                    anchors.leftMargin: 15
+                    anchors.rightMargin: 15
+                    spacing: 10
+
+                    Label {
+                        text: "DISK WRITES FALLING BEHIND"
+                        font.pixelSize: 12
+                        font.bold: true
+                        color: "#ffffff"
+                    }
+
+                    Label {
+                        text: (RecordingManager.bytesPending / (1024 * 1024)).toFixed(1) + " MB pending, "
+                              + "slowest write " + RecordingManager.maxWriteLatencyMs.toFixed(0) + " ms"
+                        font.pixelSize: 11
+                        color: "#f5f5f5"
+                    }
+
+                    Item { Layout.fillWidth: true }
+
+                    Label {
+                        visible: RecordingManager.droppedEegChunks > 0
+                        text: RecordingManager.droppedEegChunks + " EEG chunks lost"
+                        font.pixelSize: 11
+                        font.bold: true
+                        color: "#ffffff"
+                    }
+                }
+            }
+
             // MAIN CONTENT
             RowLayout {
                 Layout.fillWidth: true
@@ -300,6 +347,7 @@ ApplicationWindow {
                                                     saveFolderPath,
                                                     sessionName.length > 0 ? sessionName : generateSessionName(),
                                                     channelNamesList,
+                                                    channels,
                                                     cameraId,
                                                     backend.samplingRate
                                                 )
@@ -339,6 +387,35 @@ ApplicationWindow {
                                         }
                                     }
 
+                                    RowLayout {
+                                        Layout.fillWidth: true
+
+                                        Label {
+                                            text: "EEG file:"
+                                            font.pixelSize: 11
+                                            color: textSecondary
+                                        }
+
+                                        ComboBox {
+                                            id: eegFormatCombo
+                                            Layout.fillWidth: true
+                                            enabled: !isRecording
+                                            // Index order matches EegFileFormat
+                                            model: ["CSV (.csv)", "Binary (.bin)", "Compressed (.veeg)"]
+                                            currentIndex: RecordingManager.eegFormat
+
+                                            delegate: ItemDelegate {
+                                                width: eegFormatCombo.width
+                                                text: modelData
+                                                highlighted: eegFormatCombo.highlightedIndex === index
+                                            }
+
+                                            onActivated: function(index) {
+                                                RecordingManager.eegFormat = index
+                                            }
+                                        }
+                                    }
+
                                 }
 
                                 // EVENT MARKERS
@@ -474,6 +551,155 @@ ApplicationWindow {
                                             }
                                         }
                                     }
+
+                                    ColumnLayout {
+                                        Layout.fillWidth: true
+                                        spacing: 5
+
+                                        Label {
+                                            text: "Montage:"
+                                            font.pixelSize: 11
+                                            color: textSecondary
+                                        }
+
+                                        ComboBox {
+                                            id: montageCombo
+                                            Layout.fillWidth: true
+                                            // Index order matches EegBackend.Montage
+                                            model: ["Referential", "Common average", "Bipolar (double banana)", "Laplacian"]
+                                            currentIndex: backend.montage === EegBackend.Custom ? -1 : backend.montage
+                                            displayText: backend.montage === EegBackend.Custom ? "Custom" : currentText
+
+                                            delegate: ItemDelegate {
+                                                width: montageCombo.width
+                                                text: modelData
+                                                highlighted: montageCombo.highlightedIndex === index
+                                            }
+
+                                            onActivated: function(index) {
+                                                backend.montage = index
+                                            }
+                                        }
+                                    }
+
+                                    // Display filters — 0 Hz means off
+                                    ColumnLayout {
+                                        Layout.fillWidth: true
+                                        spacing: 5
+
+                                        Label {
+                                            text: "Filters:"
+                                            font.pixelSize: 11
+                                            color: textSecondary
+                                        }
+
+                                        GridLayout {
+                                            Layout.fillWidth: true
+                                            columns: 2
+                                            columnSpacing: 8
+                                            rowSpacing: 4
+
+                                            Label {
+                                                text: "HP"
+                                                font.pixelSize: 11
+                                                color: textSecondary
+                                            }
+
+                                            ComboBox {
+                                                id: highPassCombo
+                                                Layout.fillWidth: true
+                                                model: [0, 0.1, 0.3, 0.5, 1.0]
+                                                currentIndex: model.indexOf(backend.highPassHz)
+                                                displayText: currentValue > 0 ? currentValue + " Hz" : "Off"
+
+                                                delegate: ItemDelegate {
+                                                    width: highPassCombo.width
+                                                    text: modelData > 0 ? modelData + " Hz" : "Off"
+                                                    highlighted: highPassCombo.highlightedIndex === index
+                                                }
+
+                                                onActivated: function(index) {
+                                                    backend.highPassHz = model[index]
+                                                }
+                                            }
+
+                                            Label {
+                                                text: "LP"
+                                                font.pixelSize: 11
+                                                color: textSecondary
+                                            }
+
+                                            ComboBox {
+                                                id: lowPassCombo
+                                                Layout.fillWidth: true
+                                                model: [0, 15, 35, 70]
+                                                currentIndex: model.indexOf(backend.lowPassHz)
+                                                displayText: currentValue > 0 ? currentValue + " Hz" : "Off"
+
+                                                delegate: ItemDelegate {
+                                                    width: lowPassCombo.width
+                                                    text: modelData > 0 ? modelData + " Hz" : "Off"
+                                                    highlighted: lowPassCombo.highlightedIndex === index
+                                                }
+
+                                                onActivated: function(index) {
+                                                    backend.lowPassHz = model[index]
+                                                }
+                                            }
+
+                                            Label {
+                                                text: "Notch"
+                                                font.pixelSize: 11
+                                                color: textSecondary
+                                            }
+
+                                            ComboBox {
+                                                id: notchCombo
+                                                Layout.fillWidth: true
+                                                model: [0, 50, 60]
+                                                currentIndex: model.indexOf(backend.notchHz)
+                                                displayText: currentValue > 0 ? currentValue + " Hz" : "Off"
+
+                                                delegate: ItemDelegate {
+                                                    width: notchCombo.width
+                                                    text: modelData > 0 ? modelData + " Hz" : "Off"
+                                                    highlighted: notchCombo.highlightedIndex === index
+                                                }
+
+                                                onActivated: function(index) {
+                                                    backend.notchHz = model[index]
+                                                }
+                                            }
+                                        }
+                                    }
+
+                                    ColumnLayout {
+                                        Layout.fillWidth: true
+                                        spacing: 5
+
+                                        RowLayout {
+                                            Layout.fillWidth: true
+
+                                            Label {
+                                                text: "Low-latency acquisition:"
+                                                font.pixelSize: 11
+                                                color: textSecondary
+                                                Layout.fillWidth: true
+                                            }
+
+                                            Switch {
+                                                checked: backend.lowLatencyAcquisition
+                                                onToggled: backend.lowLatencyAcquisition = checked
+                                            }
+                                        }
+
+                                        Label {
+                                            text: "Latency: " + backend.acquisitionLatencyMs.toFixed(1) + " ms"
+                                            font.pixelSize: 10
+                                            color: textSecondary
+                                            visible: backend.isConnected
+                                        }
+                                    }
                                 }
 
                                 // ACTIONS
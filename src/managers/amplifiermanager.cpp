@@ -161,24 +161,31 @@ void AmplifierManager::startStream(const QString& amplifierId)
     {
         m_lslThread = new QThread(this);
         m_lslReader = std::make_unique<LSLStreamReader>();
+        m_lslReader->setAcquisitionMode(m_acquisitionMode);
+        m_lslReader->setDispatcher(&m_dispatcher);
         m_lslReader->moveToThread(m_lslThread);
 
-        /* Wire signal/slot connections across threads:
-         * - dataReceived:    LSL data → this manager → downstream consumers
+        /* Wire signal/slot connections across threads. EEG data itself does
+         * not go through signals: the reader publishes chunks straight into
+         * m_dispatcher on the worker thread (see eegchunkdispatcher.h).
          * - inletReady:      passes the raw lsl::stream_inlet* to EegSyncManager
-         *                    so it can call time_correction() for clock alignment
+         *                    so it can call time_correction() for clock alignment.
+         *                    Direct: runs on the reader thread, so the
+         *                    inletReady(nullptr) before delete returns only
+         *                    once no time_correction() uses the inlet
          * - samplingRate:    propagated to EegBackend/EegDataModel for buffer sizing
          * - connected/disc:  UI state updates
-         * - start/stopLsl:   control signals FROM this manager TO the reader */
-        connect(m_lslReader.get(), &LSLStreamReader::dataReceived, this, &AmplifierManager::onProcessData);
-        connect(m_lslReader.get(), &LSLStreamReader::inletReady, this, [](lsl::stream_inlet* inlet) {
-            EegSyncManager::instance()->setLslInlet(inlet);
-        });
+         * - startLsl:        control signal FROM this manager TO the reader.
+         *                    Stopping is a direct requestStop() call: the
+         *                    reader's event loop is blocked in readLoop(). */
+        connect(m_lslReader.get(), &LSLStreamReader::inletReady, this,
+                [sync = EegSyncManager::instance()](lsl::stream_inlet* inlet) {
+            sync->setLslInlet(inlet);
+        }, Qt::DirectConnection);
         connect(m_lslReader.get(), &LSLStreamReader::samplingRateDetected, this, &AmplifierManager::onSamplingRateDetected);
         connect(m_lslReader.get(), &LSLStreamReader::streamConnected, this, &AmplifierManager::streamConnected);
         connect(m_lslReader.get(), &LSLStreamReader::streamDisconnected, this, &AmplifierManager::streamDisconnected);
         connect(this, &AmplifierManager::startLslReading, m_lslReader.get(), &LSLStreamReader::onStartReading);
-        connect(this, &AmplifierManager::stopLslReading, m_lslReader.get(), &LSLStreamReader::onStopReading);
 
         m_lslThread->start();
     }
@@ -195,28 +202,26 @@ void AmplifierManager::stopStream()
     qDebug() << "Stopping stream";
 
     /* Phase 1: Stop the LSL reader loop.
-     * The 100ms sleep gives the readLoop() time to see m_isRunning==false
-     * and exit before we tear down the thread. */
+     * requestStop() is called directly: the worker thread is blocked inside
+     * onStartReading() and would never dequeue a stop slot. readLoop()
+     * returns at its next wait boundary and the reader closes the inlet on
+     * its own thread. */
     if (m_lslReader)
     {
-        emit stopLslReading();
-        QThread::msleep(100);
+        m_lslReader->requestStop();
     }
 
     /* Phase 2: Shut down the worker thread.
-     * quit() asks the event loop to stop; wait(3s) gives it time.
-     * terminate() is the last resort if the thread is stuck in a
-     * blocking LSL call. */
+     * quit() is queued behind onStartReading(), so the event loop exits
+     * once the reader has returned. No terminate(): killing the thread
+     * mid-publish could leave consumers (e.g. the recording tap handshake)
+     * in a half-finished state. */
     if (m_lslThread)
     {
         if (m_lslThread->isRunning())
         {
             m_lslThread->quit();
-            if (!m_lslThread->wait(3000))
-            {
-                m_lslThread->terminate();
-                m_lslThread->wait();
-            }
+            m_lslThread->wait();
         }
 
         m_lslThread->deleteLater();
@@ -258,19 +263,31 @@ void AmplifierManager::setSvarogPath(const QString& newSvarogPath)
     m_svarogPath = newSvarogPath;
 }
 
-// ============================================================================
-// Signal Relay (worker thread → main thread)
-// ============================================================================
+LSLStreamReader::AcquisitionMode AmplifierManager::acquisitionMode() const
+{
+    return m_acquisitionMode;
+}
 
-void AmplifierManager::onProcessData(const std::vector<std::vector<float>>& chunk,
-                                      const std::vector<double>& timestamps)
+void AmplifierManager::setAcquisitionMode(LSLStreamReader::AcquisitionMode mode)
 {
-    /* Simple relay: re-emit the data signal so that main-thread consumers
-     * (EegBackend, etc.) can connect to AmplifierManager rather than needing
-     * a direct reference to the LSLStreamReader on the worker thread. */
-    emit dataReceived(chunk, timestamps);
+    /* The reader's mode is an atomic, so it is safe to update it directly
+     * from the main thread while its readLoop() runs on the worker thread. */
+    m_acquisitionMode = mode;
+    if (m_lslReader)
+    {
+        m_lslReader->setAcquisitionMode(mode);
+    }
+}
+
+EegChunkDispatcher* AmplifierManager::dispatcher()
+{
+    return &m_dispatcher;
 }
 
+// ============================================================================
+// Signal Relay (worker thread → main thread)
+// ============================================================================
+
 void AmplifierManager::onSamplingRateDetected(double samplingRate)
 {
     /* Relay the sampling rate from LSLStreamReader to all consumers.
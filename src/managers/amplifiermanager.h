@@ -11,8 +11,9 @@
  *      2. Stream control — launches Svarog Streamer with "-a <id>" to begin
  *         data acquisition, then starts an LSLStreamReader on a worker thread
  *         to pull the resulting LSL stream.
- *      3. Data relay — re-emits raw EEG chunks from LSLStreamReader to all
- *         downstream consumers (EegBackend, RecordingManager, EegSyncManager).
+ *      3. Data fan-out — owns the EegChunkDispatcher into which
+ *         LSLStreamReader publishes raw EEG chunks; downstream consumers
+ *         (EegBackend, EegSyncManager, RecordingManager) subscribe to it.
  *
  *  DESIGN PATTERNS:
  *    Singleton (Meyer's) — single instance accessed via instance().
@@ -30,20 +31,22 @@
  *    └──────────────┘        │ (QProcess)         │        │ (QThread)       │
  *                            └───────────────────┘        └───────┬────────┘
  *                                                                  │
- *                                                    dataReceived signal
+ *                                                publish() on worker thread
  *                                                                  │
- *                                                         ┌───────▼────────┐
- *                                                         │AmplifierManager│
- *                                                         │  (re-emits)    │
- *                                                         └───┬───┬───┬───┘
- *                                                             │   │   │
- *                                          ┌──────────────────┘   │   └──────────────────┐
- *                                          ▼                      ▼                      ▼
- *                                    EegBackend           EegSyncManager         RecordingManager
- *                                   (display)            (time alignment)        (file storage)
+ *                                                       ┌─────────▼──────────┐
+ *                                                       │ EegChunkDispatcher │
+ *                                                       │ (owned by manager) │
+ *                                                       └─────┬─────────┬────┘
+ *                                                   queued    │         │  direct
+ *                                          ┌──────────────────┘         ├──────────────────┐
+ *                                          ▼                            ▼                  ▼
+ *                                    EegBackend                  EegSyncManager    RecordingManager
+ *                                    (display)                  (time alignment)    (file storage)
  *
  *  THREADING:
- *    Main thread: AmplifierManager itself, QProcess management, signal relay.
+ *    Main thread: AmplifierManager itself, QProcess management, state relay.
+ *    EEG chunks bypass the main thread here: they go from the worker
+ *    straight into m_dispatcher, which delivers per subscriber.
  *    Worker thread: m_lslThread hosts m_lslReader (LSLStreamReader).
  *    All cross-thread communication uses Qt::QueuedConnection (implicit for
  *    moveToThread objects).
@@ -59,9 +62,11 @@
  *       would timeout because no outlet exists yet.
  *
  *  SHUTDOWN SEQUENCE (stopStream):
- *    1. Signal LSLStreamReader to stop → sets m_isRunning = false
- *    2. Wait 100ms for the reader loop to exit gracefully
- *    3. Quit QThread event loop → wait up to 3s → terminate if stuck
+ *    1. LSLStreamReader::requestStop() (direct call, thread-safe)
+ *    2. The reader leaves readLoop() at its next wait boundary and closes
+ *       the inlet on its own thread
+ *    3. Quit QThread event loop → wait for it (never terminated: a killed
+ *       thread could leave a consumer mid-chunk)
  *    4. Terminate Svarog Streamer process → kill if unresponsive
  *
  * ==========================================================================
@@ -78,6 +83,8 @@
 
 #include "lslstreamreader.h"
 #include "amplifiermodel.h"
+#include "eegchunk.h"
+#include "eegchunkdispatcher.h"
 
 class AmplifierManager : public QObject
 {
@@ -125,12 +132,21 @@ public:
     QString svarogPath() const;
     void setSvarogPath(const QString& newSvarogPath);
 
+    /* How the LSL reader waits for data (see lslstreamreader.h).
+     * Remembered across streams and applied to the live reader immediately. */
+    LSLStreamReader::AcquisitionMode acquisitionMode() const;
+    void setAcquisitionMode(LSLStreamReader::AcquisitionMode mode);
+
+    /* Subscription point for raw EEG chunks (see eegchunkdispatcher.h).
+     * Lives as long as the manager, so subscriptions survive stream restarts. */
+    EegChunkDispatcher* dispatcher();
+
 signals:
-    /* Internal control signals — connected to LSLStreamReader slots via
-     * Qt::QueuedConnection to cross the thread boundary. These are emitted
-     * by startStream()/stopStream() to command the worker thread. */
+    /* Internal control signal — connected to LSLStreamReader::onStartReading
+     * via Qt::QueuedConnection to cross the thread boundary. Emitted by
+     * startStream(); stopStream() calls LSLStreamReader::requestStop()
+     * directly because the reader's event loop is busy in readLoop(). */
     void startLslReading();
-    void stopLslReading();
 
     /* Emitted when the acquisition state changes (connected/disconnected). */
     void acquisitionStatusChanged();
@@ -139,23 +155,13 @@ signals:
      * list of discovered amplifiers for the UI to display. */
     void amplifiersListRefreshed(const QList<Amplifier>& amplifiers);
 
-    /* Re-emitted from LSLStreamReader — these are the primary signals that
-     * EegBackend, EegSyncManager, and RecordingManager connect to.
-     * They carry data from the worker thread to the main thread. */
-    void dataReceived(const std::vector<std::vector<float>>& chunk,
-                      const std::vector<double>& timestamps);
+    /* Re-emitted from LSLStreamReader — stream state for EegBackend and the UI.
+     * EEG data itself is delivered through dispatcher(), not a signal. */
     void samplingRateDetected(double samplingRate);
     void streamConnected();
     void streamDisconnected();
 
 public slots:
-    /* Relay slot: receives raw EEG data from LSLStreamReader (worker thread)
-     * and re-emits it as dataReceived() for main-thread consumers.
-     * This indirection is necessary because LSLStreamReader is on a different
-     * thread and the signal must be re-emitted from a main-thread object. */
-    void onProcessData(const std::vector<std::vector<float>>& chunk,
-                       const std::vector<double>& timestamps);
-
     /* Relay slot: re-emits the sampling rate from LSLStreamReader. */
     void onSamplingRateDetected(double samplingRate);
 
@@ -175,8 +181,10 @@ private:
     // TODO: Make configurable via settings/options
     QString m_svarogPath{"C:\\Program Files (x86)\\Svarog Streamer\\svarog_streamer\\svarog_streamer.exe"};
 
+    EegChunkDispatcher m_dispatcher;                // Chunk fan-out, outlives the reader
     QThread* m_lslThread = nullptr;                 // Hosts m_lslReader worker
     std::unique_ptr<LSLStreamReader> m_lslReader;   // The actual LSL data puller
+    LSLStreamReader::AcquisitionMode m_acquisitionMode = LSLStreamReader::AcquisitionMode::LatencyOptimized;
 
     /* Cache of discovered amplifiers — populated by refresh methods,
      * queried by getAmplifierById() and EegBackend::channelNames(). */
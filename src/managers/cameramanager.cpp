@@ -658,7 +658,7 @@ void CameraManager::onVideoFrameChanged(const QVideoFrame& frame)
     // This timestamp flows through the entire synchronization pipeline:
     //   1. VideoBackend stores it in the frame ring buffer
     //   2. VideoDisplayWindow.qml receives it via frameReceived(lslTimestamp)
-    //   3. QML calls EegSyncManager.getEEGForFrame(lslTimestamp)
+    //   3. QML queues it and aligns the queue with EegSyncManager.getEEGForFrames()
     //   4. EegSyncManager applies time_correction(), searches EEG buffer,
     //      validates timestamp range, and returns matched EEG data + offsetMs
     //   5. QML updates the sync health overlay with the result
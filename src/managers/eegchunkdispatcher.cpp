@@ -0,0 +1,64 @@
+/*
+ * ==========================================================================
+ *  eegchunkdispatcher.cpp — Acquisition-Thread Fan-Out Implementation
+ * ==========================================================================
+ *  See eegchunkdispatcher.h for delivery modes and thread-safety rules.
+ * ==========================================================================
+ */
+
+#include "eegchunkdispatcher.h"
+#include <QMutexLocker>
+
+void EegChunkDispatcher::subscribe(QObject* context, Consumer consumer, Qt::ConnectionType type)
+{
+    if (!context || !consumer)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    auto updated = std::make_shared<SubscriberList>(*m_subscribers);
+    updated->append({context, std::move(consumer), type == Qt::DirectConnection});
+    m_subscribers = std::move(updated);
+}
+
+void EegChunkDispatcher::unsubscribe(QObject* context)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto updated = std::make_shared<SubscriberList>(*m_subscribers);
+    updated->removeIf([context](const Subscriber& s) { return s.context == context; });
+    m_subscribers = std::move(updated);
+}
+
+void EegChunkDispatcher::publish(const EegChunkPtr& chunk) const
+{
+    if (!chunk)
+        return;
+
+    std::shared_ptr<const SubscriberList> subscribers;
+    {
+        QMutexLocker locker(&m_mutex);
+        subscribers = m_subscribers;
+
+        /* Queued consumers are posted under the lock so that unsubscribe()
+         * from a destructor cannot race with a post to the dying object.
+         * Posting is non-blocking; only the chunk pointer is captured. */
+        for (const Subscriber& s : *subscribers)
+        {
+            if (s.direct)
+                continue;
+
+            QMetaObject::invokeMethod(s.context, [consumer = s.consumer, chunk]() {
+                consumer(chunk);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    /* Direct consumers run on the calling (LSL worker) thread, outside the
+     * lock so a slow consumer cannot stall subscribe()/unsubscribe(). */
+    for (const Subscriber& s : *subscribers)
+    {
+        if (s.direct)
+            s.consumer(chunk);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * ==========================================================================
+ *  eegchunkdispatcher.h — Acquisition-Thread Fan-Out for EEG Chunks
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Single subscription point for every consumer of raw EEG data.
+ *    LSLStreamReader calls publish() on the LSL worker thread for each
+ *    chunk it pulls; the dispatcher hands the shared chunk pointer to all
+ *    registered consumers in one step. This replaces the previous
+ *    two-hop relay (LSLStreamReader → AmplifierManager::onProcessData →
+ *    AmplifierManager::dataReceived → consumers), which cost an extra
+ *    event-loop trip and metatype copy on the main thread per chunk.
+ *
+ *  DESIGN PATTERN:
+ *    Observer / publish-subscribe. Owned by AmplifierManager so that
+ *    subscriptions survive stream restarts (the reader and its thread
+ *    are recreated; the dispatcher is not).
+ *
+ *  DELIVERY MODES (chosen per subscriber):
+ *    Qt::QueuedConnection — the consumer is posted to the context object's
+ *      thread (one hop). Used by EegBackend (main thread, display).
+ *    Qt::DirectConnection — the consumer runs synchronously on the LSL
+ *      worker thread inside publish(). Used by thread-safe, long-lived
+ *      consumers (EegSyncManager, RecordingManager's recording tap) so
+ *      their work never waits on the GUI.
+ *      Direct consumers must be fast and must not block.
+ *
+ *        LSLStreamReader::readLoop()   [LSL worker thread]
+ *                 │ publish(chunk)
+ *                 ▼
+ *        EegChunkDispatcher
+ *          ├─ Direct ─────▸ EegSyncManager::addEegSamples()   (worker thread)
+ *          ├─ Direct ─────▸ RecordingManager::onEegChunk()    (worker thread)
+ *          └─ Queued ─────▸ EegBackend::onDataReceived()      (main thread)
+ *
+ *  THREAD SAFETY:
+ *    The subscriber list is copy-on-write: subscribe()/unsubscribe()
+ *    build a new list under m_mutex; publish() only copies the shared
+ *    pointer to the current list. Queued posts happen while m_mutex is
+ *    held, so once unsubscribe() returns no further events are posted to
+ *    that context — a consumer may safely unsubscribe in its destructor.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGCHUNKDISPATCHER_H
+#define EEGCHUNKDISPATCHER_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <functional>
+#include <memory>
+#include "eegchunk.h"
+
+class EegChunkDispatcher
+{
+public:
+    using Consumer = std::function<void(const EegChunkPtr&)>;
+
+    EegChunkDispatcher() = default;
+    EegChunkDispatcher(const EegChunkDispatcher&) = delete;
+    EegChunkDispatcher& operator=(const EegChunkDispatcher&) = delete;
+
+    /* Registers a consumer. context identifies the subscription (for
+     * unsubscribe) and, for QueuedConnection, the thread to deliver on.
+     * Only Qt::DirectConnection and Qt::QueuedConnection are supported;
+     * anything else is treated as queued. */
+    void subscribe(QObject* context, Consumer consumer,
+                   Qt::ConnectionType type = Qt::QueuedConnection);
+
+    /* Removes every subscription registered with this context. */
+    void unsubscribe(QObject* context);
+
+    /* Called by LSLStreamReader on the LSL worker thread for every chunk. */
+    void publish(const EegChunkPtr& chunk) const;
+
+private:
+    struct Subscriber
+    {
+        QObject* context = nullptr;
+        Consumer consumer;
+        bool direct = false;
+    };
+    using SubscriberList = QList<Subscriber>;
+
+    mutable QMutex m_mutex;
+    std::shared_ptr<const SubscriberList> m_subscribers = std::make_shared<const SubscriberList>();
+};
+
+#endif // EEGCHUNKDISPATCHER_H
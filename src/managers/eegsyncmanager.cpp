@@ -8,6 +8,14 @@
  *
  *  KEY IMPLEMENTATION NOTES:
  *
+ *  LOCK-FREE READS
+ *    Every query follows the same pattern: take the ring with readRing(),
+ *    snapshot its window, read what it needs into locals, then
+ *    validate(window.first). If a write overtook the oldest readable row
+ *    in the meantime, the locals are discarded and the query repeats
+ *    (up to MAX_READ_ATTEMPTS). Results are built only from validated
+ *    copies, never from ring memory directly.
+ *
  *  getEEGForFrame() — THE SYNCHRONIZATION QUERY
  *    1. Increments m_totalQueryCount for per-session diagnostics.
  *    2. Applies time_correction() to convert video timestamp to EEG clock base.
@@ -17,7 +25,7 @@
  *         - Video started before EEG (timestamp < oldest EEG sample)
  *         - EEG stream is lagging behind video (timestamp > newest EEG sample)
  *         - Buffer sizes are mismatched (now fixed: both are 30 seconds)
- *    4. Performs interpolation (nearest neighbor or linear) and returns
+ *    4. Performs interpolation (nearest, linear, cubic or sinc) and returns
  *       the matched sample with its offset from the query timestamp.
  *
  *  markSessionStart() / markSessionEnd()
@@ -32,11 +40,30 @@
  */
 
 #include "eegsyncmanager.h"
+#include "amplifiermanager.h"
+#include "clockcorrectionworker.h"
 #include <QDebug>
 #include <QMutexLocker>
 #include <QQmlEngine>
 #include <algorithm>
 #include <cmath>
+#include <vector>
+
+namespace {
+
+/* Per-thread scratch for query copies. Queries come from a few threads
+ * (GUI, frame callbacks) and the width only changes with the montage, so
+ * after warm-up a query allocates nothing until it builds its QVariants. */
+template <typename T>
+T* scratch(size_t count)
+{
+    thread_local std::vector<T> buffer;
+    if (buffer.size() < count)
+        buffer.resize(count);
+    return buffer.data();
+}
+
+} // namespace
 
 EegSyncManager* EegSyncManager::s_instance = nullptr;
 
@@ -45,12 +72,17 @@ EegSyncManager::EegSyncManager(QObject* parent)
 {
     s_instance = this;
 
-    // Periodic LSL time_correction() refresh — 10 s interval balances
-    // accuracy (short-term drift stays < 1 ms) with the ~100 ms blocking
-    // cost of each time_correction() call.
-    m_timeCorrectionTimer = new QTimer(this);
-    m_timeCorrectionTimer->setInterval(10000);
-    connect(m_timeCorrectionTimer, &QTimer::timeout, this, &EegSyncManager::updateTimeCorrection);
+    // Periodic LSL time_correction() refresh on a dedicated thread: each
+    // call blocks for a network round trip, which must never stall the GUI
+    // or a sync query. The worker publishes a fitted model into
+    // m_clockModel; the target is set before moveToThread().
+    m_clockThread = new QThread(this);
+    m_clockWorker = new ClockCorrectionWorker();
+    m_clockWorker->setModelTarget(&m_clockModel);
+    m_clockWorker->moveToThread(m_clockThread);
+    connect(m_clockThread, &QThread::started, m_clockWorker, &ClockCorrectionWorker::start);
+    connect(m_clockThread, &QThread::finished, m_clockWorker, &QObject::deleteLater);
+    m_clockThread->start();
 
     // Throttle QML property notifications to 4 Hz. The buffer is updated
     // at ~50 Hz (EEG data rate); re-rendering the monitoring panel at the
@@ -60,11 +92,25 @@ EegSyncManager::EegSyncManager(QObject* parent)
     connect(m_statsTimer, &QTimer::timeout, this, &EegSyncManager::statsChanged);
     m_statsTimer->start();
 
+    // Ingest chunks directly on the LSL worker thread — the ring's only
+    // writer. This does not need the main thread and keeps sync data
+    // flowing even when the GUI is busy rendering.
+    AmplifierManager::instance()->dispatcher()->subscribe(this, [this](const EegChunkPtr& chunk) {
+        addEegSamples(*chunk);
+    }, Qt::DirectConnection);
+
     qInfo() << "[EegSyncManager] Created";
 }
 
 EegSyncManager::~EegSyncManager()
 {
+    AmplifierManager::instance()->dispatcher()->unsubscribe(this);
+
+    // Waits out an in-flight time_correction() (1 s timeout) so the
+    // worker never publishes into a destroyed m_clockModel.
+    m_clockThread->quit();
+    m_clockThread->wait(2000);
+
     if (s_instance == this)
         s_instance = nullptr;
     qInfo() << "[EegSyncManager] Destroyed";
@@ -90,50 +136,64 @@ EegSyncManager* EegSyncManager::create(QQmlEngine* qmlEngine, QJSEngine* jsEngin
 // Data Input
 // ============================================================================
 
-void EegSyncManager::addEegSamples(const std::vector<std::vector<float>>& chunk,
-                                    const std::vector<double>& timestamps,
-                                    const QVector<int>& channelIndices)
+void EegSyncManager::addEegSamples(const EegChunk& chunk)
 {
-    if (chunk.empty() || timestamps.empty())
+    if (chunk.isEmpty())
         return;
 
-    // LSL guarantees chunk.size() == timestamps.size(), but guard defensively
-    const int count = static_cast<int>(std::min(chunk.size(), timestamps.size()));
-
-    QMutexLocker locker(&m_mutex);
-
-    for (int i = 0; i < count; ++i)
+    EegMontagePtr montage;
     {
-        const auto& sample = chunk[i];
-
-        // Store only the selected channels to reduce memory footprint.
-        // A 64-channel amplifier produces 64× the data of 8 displayed channels;
-        // storing all channels would waste ~8× buffer capacity and increase
-        // copy overhead on every query.
-        std::vector<float> selected;
-        if (channelIndices.isEmpty())
-        {
-            selected = sample;
-        }
+        QMutexLocker locker(&m_configMutex);
+        montage = m_montage;
+    }
+    const bool derive = montage && !montage->isEmpty();
+    const int width = derive ? montage->derivationCount() : chunk.channelCount;
+    const int capacity = m_maxBufferSize.load(std::memory_order_relaxed);
+    const bool clear = m_clearRequested.exchange(false, std::memory_order_acq_rel);
+
+    // This thread is the only one that replaces the ring, so it may keep
+    // using its own reference; readers pick up the new one on their next
+    // readRing(). History survives a capacity change, not a width change
+    // (rows of different montages are not comparable).
+    std::shared_ptr<EegSyncRing> ring = readRing();
+    if (!ring || clear || ring->width() != width || ring->capacity() != capacity)
+    {
+        auto fresh = std::make_shared<EegSyncRing>(capacity, width);
+        if (ring && !clear && ring->width() == width)
+            fresh->appendNewestFrom(*ring);
+        std::atomic_store(&m_ring, fresh);
+        ring = std::move(fresh);
+    }
+
+    // Store only the montage derivations to reduce memory footprint.
+    // A 64-channel amplifier produces 64× the data of 8 displayed channels;
+    // storing all channels would waste ~8× buffer capacity and increase
+    // copy overhead on every query. Out-of-range channels read as 0.
+    ring->append(chunk.sampleCount, [&](int i, float* out) {
+        const float* sample = chunk.row(i);
+        if (derive)
+            montage->applyRow(sample, chunk.channelCount, out);
         else
-        {
-            selected.reserve(channelIndices.size());
-            for (int idx : channelIndices)
-            {
-                if (idx >= 0 && idx < static_cast<int>(sample.size()))
-                    selected.push_back(sample[idx]);
-                else
-                    selected.push_back(0.0f); // Guard against out-of-range indices
-            }
-        }
+            std::copy_n(sample, width, out);
+        return chunk.timestamps[i];
+    });
 
-        m_buffer.emplace_back(timestamps[i], std::move(selected));
-    }
+    publishBufferStats(*ring);
+}
 
-    // Enforce rolling window: pop oldest samples when over capacity.
-    // pop_front on std::deque is O(1), making this very cheap.
-    while (static_cast<int>(m_buffer.size()) > m_maxBufferSize)
-        m_buffer.pop_front();
+void EegSyncManager::publishBufferStats(const EegSyncRing& ring)
+{
+    // Written by this thread alone, so the window cannot move underneath.
+    const EegSyncRing::Window window = ring.window();
+    m_statBufferSize.store(static_cast<int>(window.size()), std::memory_order_relaxed);
+    m_statOldestTs.store(window.isEmpty() ? 0.0 : ring.timestamp(window.first), std::memory_order_relaxed);
+    m_statNewestTs.store(window.isEmpty() ? 0.0 : ring.timestamp(window.end - 1), std::memory_order_relaxed);
+}
+
+void EegSyncManager::setMontage(EegMontagePtr montage)
+{
+    QMutexLocker locker(&m_configMutex);
+    m_montage = std::move(montage);
 }
 
 // ============================================================================
@@ -146,18 +206,41 @@ QVariantMap EegSyncManager::getEEGForFrame(double videoTimestamp) const
     result["valid"] = false;
     result["outOfRange"] = false;
 
-    QMutexLocker locker(&m_mutex);
-
-    m_totalQueryCount++;
+    m_totalQueryCount.fetch_add(1, std::memory_order_relaxed);
 
-    if (m_buffer.empty() || videoTimestamp <= 0.0)
+    const std::shared_ptr<EegSyncRing> ring = readRing();
+    if (!ring || videoTimestamp <= 0.0)
         return result;
 
     // Subtract the drift correction offset to convert the video timestamp
     // from the PC clock base to the EEG device's LSL clock base.
     // Without this, the search would look for a time that does not exist
     // in the EEG buffer when the two clocks diverge.
-    double adjustedTs = videoTimestamp - m_timeCorrection;
+    const double adjustedTs = videoTimestamp - correctionAt(videoTimestamp);
+    const double samplingRate = m_samplingRate.load(std::memory_order_relaxed);
+    const int mode = m_interpolationMode.load(std::memory_order_relaxed);
+
+    // Read optimistically; everything below uses these validated copies.
+    const int width = ring->width();
+    float* channelValues = scratch<float>(static_cast<size_t>(width));
+    double oldest = 0.0;
+    double newest = 0.0;
+    double matchedTs = 0.0;
+    bool consistent = false;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS && !consistent; ++attempt)
+    {
+        const EegSyncRing::Window window = ring->window();
+        if (window.isEmpty())
+            return result;
+
+        oldest = ring->timestamp(window.first);
+        newest = ring->timestamp(window.end - 1);
+        matchedTs = sampleAt(*ring, window, findRow(*ring, window, adjustedTs),
+                             adjustedTs, mode, channelValues);
+        consistent = ring->validate(window.first);
+    }
+    if (!consistent)
+        return result;
 
     // --- Timestamp range validation ---
     // Check whether the query timestamp falls within the buffer's time range.
@@ -165,13 +248,11 @@ QVariantMap EegSyncManager::getEEGForFrame(double videoTimestamp) const
     // account for floating-point rounding at the buffer boundaries. Queries
     // outside this range indicate that the video and EEG streams are not
     // overlapping in time — the caller should check "outOfRange" in the result.
-    double oldest = m_buffer.front().lslTimestamp;
-    double newest = m_buffer.back().lslTimestamp;
-    double tolerance = (m_samplingRate > 0.0) ? (1.0 / m_samplingRate) : 0.004;
+    const double tolerance = (samplingRate > 0.0) ? (1.0 / samplingRate) : 0.004;
 
     if (adjustedTs < oldest - tolerance || adjustedTs > newest + tolerance)
     {
-        m_outOfRangeCount++;
+        const int outOfRange = m_outOfRangeCount.fetch_add(1, std::memory_order_relaxed) + 1;
 
         // Calculate how far outside the buffer the timestamp is, so the
         // caller can display a meaningful diagnostic ("EEG data is 200ms behind").
@@ -184,39 +265,35 @@ QVariantMap EegSyncManager::getEEGForFrame(double videoTimestamp) const
         result["outOfRange"] = true;
         result["rangeErrorMs"] = rangeErrorMs;
 
-        // Still attempt to return the nearest boundary sample so the caller
-        // has something to display, but mark it as out-of-range.
+        // Still return the nearest boundary sample so the caller has
+        // something to display, but mark it as out-of-range.
         // Only log a warning once per 100 occurrences to avoid log spam.
-        if (m_outOfRangeCount % 100 == 1)
+        if (outOfRange % 100 == 1)
         {
             qDebug() << "[EegSyncManager] Query out of range:"
                      << "videoTs=" << videoTimestamp
                      << "adjusted=" << adjustedTs
                      << "buffer=[" << oldest << "," << newest << "]"
                      << "errorMs=" << rangeErrorMs
-                     << "count=" << m_outOfRangeCount;
+                     << "count=" << outOfRange;
         }
     }
 
-    EegTimestampedSample sample = (m_interpolationMode == 1)
-        ? linearInterpolate(adjustedTs)
-        : nearestNeighbor(adjustedTs);
-
-    if (!sample.isValid())
+    if (matchedTs <= 0.0 || width == 0)
         return result;
 
-    double offsetMs = std::abs(adjustedTs - sample.lslTimestamp) * 1000.0;
-    m_lastSyncOffsetMs = offsetMs;
+    double offsetMs = std::abs(adjustedTs - matchedTs) * 1000.0;
+    m_lastSyncOffsetMs.store(offsetMs, std::memory_order_relaxed);
     updateRunningAverage(offsetMs);
 
     result["valid"] = true;
-    result["timestamp"] = sample.lslTimestamp;
+    result["timestamp"] = matchedTs;
     result["offsetMs"] = offsetMs;
 
     QVariantList channels;
-    channels.reserve(static_cast<int>(sample.channels.size()));
-    for (float val : sample.channels)
-        channels.append(static_cast<double>(val));
+    channels.reserve(width);
+    for (int ch = 0; ch < width; ++ch)
+        channels.append(static_cast<double>(channelValues[ch]));
     result["channels"] = channels;
 
     return result;
@@ -226,27 +303,56 @@ QVariantList EegSyncManager::getEEGRangeForFrame(double startTs, double endTs) c
 {
     QVariantList results;
 
-    QMutexLocker locker(&m_mutex);
-
-    if (m_buffer.empty() || startTs >= endTs)
+    const std::shared_ptr<EegSyncRing> ring = readRing();
+    if (!ring || startTs >= endTs)
         return results;
 
-    double adjustedStart = startTs - m_timeCorrection;
-    double adjustedEnd   = endTs   - m_timeCorrection;
-
-    // Binary search to jump directly to the first sample in range — O(log N)
-    // rather than scanning from the front of the buffer.
-    auto itStart = std::lower_bound(
-        m_buffer.begin(), m_buffer.end(), adjustedStart,
-        [](const EegTimestampedSample& s, double ts) { return s.lslTimestamp < ts; });
+    const std::shared_ptr<const EegClockModel> clock = std::atomic_load(&m_clockModel);
+    const double adjustedStart = startTs - (clock ? clock->correctionAt(startTs) : 0.0);
+    const double adjustedEnd   = endTs   - (clock ? clock->correctionAt(endTs) : 0.0);
+
+    // Copy the matching rows out first, then validate, then box them —
+    // QVariant construction is far slower than the copy and must not
+    // widen the window in which a write can overtake the read. The copy
+    // is one contiguous run per channel (channel-major ring).
+    const int width = ring->width();
+    double* timestamps = nullptr;
+    float* values = nullptr;
+    size_t count = 0;
+    bool consistent = false;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS && !consistent; ++attempt)
+    {
+        const EegSyncRing::Window window = ring->window();
+
+        // Both ends by lookup over the contiguous timestamp array.
+        const std::uint64_t first = findRow(*ring, window, adjustedStart);
+        std::uint64_t end = findRow(*ring, window, adjustedEnd);
+        while (end < window.end && ring->timestamp(end) <= adjustedEnd)
+            ++end;  // Include rows exactly at adjustedEnd
+        end = std::max(end, first);  // Torn timestamps; validate() rejects the read
+        count = static_cast<size_t>(end - first);
+
+        timestamps = scratch<double>(count);
+        for (size_t i = 0; i < count; ++i)
+            timestamps[i] = ring->timestamp(first + i);
+        values = scratch<float>(count * static_cast<size_t>(width));
+        for (int ch = 0; ch < width; ++ch)
+            ring->copyChannel(ch, first, count, values + static_cast<size_t>(ch) * count);
+
+        consistent = ring->validate(window.first);
+    }
+    if (!consistent)
+        return results;
 
-    for (auto it = itStart; it != m_buffer.end() && it->lslTimestamp <= adjustedEnd; ++it)
+    results.reserve(static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i)
     {
         QVariantMap entry;
-        entry["timestamp"] = it->lslTimestamp;
+        entry["timestamp"] = timestamps[i];
         QVariantList channels;
-        for (float val : it->channels)
-            channels.append(static_cast<double>(val));
+        channels.reserve(width);
+        for (int ch = 0; ch < width; ++ch)
+            channels.append(static_cast<double>(values[static_cast<size_t>(ch) * count + i]));
         entry["channels"] = channels;
         results.append(entry);
     }
@@ -254,60 +360,254 @@ QVariantList EegSyncManager::getEEGRangeForFrame(double startTs, double endTs) c
     return results;
 }
 
+bool EegSyncManager::getEEGForFrames(const QList<double>& videoTimestamps,
+                                     EegFrameBatch& batch) const
+{
+    const qsizetype frames = videoTimestamps.size();
+    batch = EegFrameBatch();
+    batch.eegTimestamps.fill(0.0, frames);
+    batch.offsetsMs.fill(0.0, frames);
+    batch.rangeErrorsMs.fill(0.0, frames);
+
+    m_totalQueryCount.fetch_add(static_cast<int>(frames), std::memory_order_relaxed);
+
+    const std::shared_ptr<EegSyncRing> ring = readRing();
+    if (!ring || frames == 0)
+        return false;
+
+    // One model for the whole batch, evaluated at each frame's timestamp.
+    const std::shared_ptr<const EegClockModel> clock = std::atomic_load(&m_clockModel);
+    const double samplingRate = m_samplingRate.load(std::memory_order_relaxed);
+    const double tolerance = (samplingRate > 0.0) ? (1.0 / samplingRate) : 0.004;
+    const int mode = m_interpolationMode.load(std::memory_order_relaxed);
+    const int width = ring->width();
+
+    batch.channelCount = width;
+    batch.values.fill(0.0f, frames * width);
+
+    // Same optimistic read as getEEGForFrame(), once for the whole batch:
+    // every frame is matched against the same window, then validated.
+    bool consistent = false;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS && !consistent; ++attempt)
+    {
+        const EegSyncRing::Window window = ring->window();
+        if (window.isEmpty())
+            return false;
+
+        const double oldest = ring->timestamp(window.first);
+        const double newest = ring->timestamp(window.end - 1);
+        float* values = batch.values.data();
+
+        std::uint64_t row = window.first;
+        double previousTs = 0.0;
+        bool placed = false;
+        for (qsizetype f = 0; f < frames; ++f)
+        {
+            const double videoTs = videoTimestamps[f];
+            batch.eegTimestamps[f] = 0.0;
+            batch.rangeErrorsMs[f] = 0.0;
+            if (videoTs <= 0.0)
+                continue;
+
+            // Merge-walk: advance from the previous frame's row while the
+            // frames are ascending and close; otherwise look the row up.
+            const double adjustedTs = videoTs - (clock ? clock->correctionAt(videoTs) : 0.0);
+            bool walked = placed && adjustedTs >= previousTs;
+            for (std::uint64_t steps = 0; walked && row < window.end
+                 && ring->timestamp(row) < adjustedTs; ++steps, ++row)
+            {
+                if (steps == MERGE_WALK_LIMIT)
+                    walked = false;
+            }
+            if (!walked)
+                row = findRow(*ring, window, adjustedTs);
+            placed = true;
+            previousTs = adjustedTs;
+
+            if (adjustedTs < oldest - tolerance)
+                batch.rangeErrorsMs[f] = (oldest - adjustedTs) * 1000.0;
+            else if (adjustedTs > newest + tolerance)
+                batch.rangeErrorsMs[f] = (adjustedTs - newest) * 1000.0;
+
+            const double matchedTs = sampleAt(*ring, window, row, adjustedTs, mode,
+                                              values + f * width);
+            batch.eegTimestamps[f] = matchedTs;
+            batch.offsetsMs[f] = std::abs(adjustedTs - matchedTs) * 1000.0;
+        }
+        consistent = ring->validate(window.first);
+    }
+    if (!consistent)
+    {
+        batch.eegTimestamps.fill(0.0);
+        return false;
+    }
+
+    int matched = 0;
+    int outOfRange = 0;
+    double offsetSum = 0.0;
+    double lastOffsetMs = 0.0;
+    for (qsizetype f = 0; f < frames; ++f)
+    {
+        if (batch.rangeErrorsMs[f] > 0.0)
+            ++outOfRange;
+        if (batch.eegTimestamps[f] > 0.0)
+        {
+            ++matched;
+            lastOffsetMs = batch.offsetsMs[f];
+            offsetSum += lastOffsetMs;
+        }
+    }
+    if (outOfRange > 0)
+        m_outOfRangeCount.fetch_add(outOfRange, std::memory_order_relaxed);
+    if (matched > 0)
+    {
+        m_lastSyncOffsetMs.store(lastOffsetMs, std::memory_order_relaxed);
+        updateRunningAverage(offsetSum / matched);
+    }
+    return true;
+}
+
+QVariantMap EegSyncManager::getEEGForFrames(const QList<double>& videoTimestamps) const
+{
+    EegFrameBatch batch;
+    getEEGForFrames(videoTimestamps, batch);
+
+    // The typed lists are implicitly shared into the variants, not copied.
+    QVariantMap result;
+    result["channelCount"] = batch.channelCount;
+    result["timestamps"] = QVariant::fromValue(batch.eegTimestamps);
+    result["offsetsMs"] = QVariant::fromValue(batch.offsetsMs);
+    result["rangeErrorsMs"] = QVariant::fromValue(batch.rangeErrorsMs);
+    result["values"] = QVariant::fromValue(batch.values);
+    return result;
+}
+
 // ============================================================================
 // Interpolation Algorithms
 // ============================================================================
 
-EegTimestampedSample EegSyncManager::nearestNeighbor(double adjustedTs) const
+std::uint64_t EegSyncManager::findRow(const EegSyncRing& ring,
+                                      const EegSyncRing::Window& window,
+                                      double adjustedTs) const
 {
-    // std::lower_bound returns an iterator to the first element >= adjustedTs.
-    // We then compare it with the previous element to find the true nearest.
-    auto it = std::lower_bound(
-        m_buffer.begin(), m_buffer.end(), adjustedTs,
-        [](const EegTimestampedSample& s, double ts) { return s.lslTimestamp < ts; });
+    bool predicted = false;
+    const std::uint64_t row = ring.lowerBound(window, adjustedTs, &predicted);
+    m_indexLookupCount.fetch_add(1, std::memory_order_relaxed);
+    if (predicted)
+        m_indexPredictedCount.fetch_add(1, std::memory_order_relaxed);
+    return row;
+}
 
-    if (it == m_buffer.end())   return m_buffer.back();
-    if (it == m_buffer.begin()) return m_buffer.front();
+double EegSyncManager::sampleAt(const EegSyncRing& ring,
+                                const EegSyncRing::Window& window,
+                                std::uint64_t row, double adjustedTs,
+                                int mode, float* out) const
+{
+    if (window.isEmpty())
+        return 0.0;
 
-    auto prevIt = std::prev(it);
-    double diffCurrent = std::abs(it->lslTimestamp - adjustedTs);
-    double diffPrev    = std::abs(prevIt->lslTimestamp - adjustedTs);
+    switch (mode)
+    {
+    case Linear: return interpolate(ring, window, row, adjustedTs, EegInterpKernel::Mode::Linear, out);
+    case Cubic:  return interpolate(ring, window, row, adjustedTs, EegInterpKernel::Mode::Cubic, out);
+    case Sinc:   return interpolate(ring, window, row, adjustedTs, EegInterpKernel::Mode::Sinc, out);
+    default:     return nearestNeighbor(ring, window, row, adjustedTs, out);
+    }
+}
+
+double EegSyncManager::nearestNeighbor(const EegSyncRing& ring,
+                                       const EegSyncRing::Window& window,
+                                       std::uint64_t row, double adjustedTs,
+                                       float* out) const
+{
+    // `row` is the first row >= adjustedTs.
+    // We then compare it with the previous row to find the true nearest.
+    std::uint64_t nearest = row;
 
-    return (diffPrev < diffCurrent) ? *prevIt : *it;
+    if (nearest == window.end)
+        nearest = window.end - 1;
+    else if (nearest != window.first)
+    {
+        double diffCurrent = std::abs(ring.timestamp(nearest) - adjustedTs);
+        double diffPrev    = std::abs(ring.timestamp(nearest - 1) - adjustedTs);
+        if (diffPrev < diffCurrent)
+            --nearest;
+    }
+
+    ring.copyRow(nearest, out);
+    return ring.timestamp(nearest);
 }
 
-EegTimestampedSample EegSyncManager::linearInterpolate(double adjustedTs) const
+double EegSyncManager::interpolate(const EegSyncRing& ring,
+                                   const EegSyncRing::Window& window,
+                                   std::uint64_t row, double adjustedTs,
+                                   EegInterpKernel::Mode mode, float* out) const
 {
-    auto it = std::lower_bound(
-        m_buffer.begin(), m_buffer.end(), adjustedTs,
-        [](const EegTimestampedSample& s, double ts) { return s.lslTimestamp < ts; });
+    const std::uint64_t it = row;
 
     // At the edges of the buffer there is no bracketing pair — fall back
     // to the boundary sample rather than extrapolating beyond known data.
-    if (it == m_buffer.end())   return m_buffer.back();
-    if (it == m_buffer.begin()) return m_buffer.front();
+    if (it == window.end || it == window.first)
+    {
+        const std::uint64_t edge = (it == window.end) ? window.end - 1 : window.first;
+        ring.copyRow(edge, out);
+        return ring.timestamp(edge);
+    }
 
-    auto prevIt = std::prev(it);
+    const std::uint64_t prevIt = it - 1;
+    const double prevTs = ring.timestamp(prevIt);
+    const double nextTs = ring.timestamp(it);
 
-    double dt = it->lslTimestamp - prevIt->lslTimestamp;
-    if (dt <= 0.0) return *prevIt; // Degenerate case: duplicate timestamps
+    double dt = nextTs - prevTs;
+    if (dt <= 0.0) // Degenerate case: duplicate timestamps
+    {
+        ring.copyRow(prevIt, out);
+        return prevTs;
+    }
 
     // alpha ∈ [0, 1]: how far adjustedTs is between prevIt and it
-    double alpha = std::clamp((adjustedTs - prevIt->lslTimestamp) / dt, 0.0, 1.0);
-
-    const auto& chA = prevIt->channels;
-    const auto& chB = it->channels;
-    int numCh = static_cast<int>(std::min(chA.size(), chB.size()));
-
-    std::vector<float> interpolated(numCh);
-    for (int i = 0; i < numCh; ++i)
-        interpolated[i] = static_cast<float>(chA[i] * (1.0 - alpha) + chB[i] * alpha);
+    double alpha = std::clamp((adjustedTs - prevTs) / dt, 0.0, 1.0);
 
     // Reference timestamp: use whichever boundary is closer so that
     // the returned offsetMs calculation in getEEGForFrame() is meaningful.
-    double refTs = (alpha < 0.5) ? prevIt->lslTimestamp : it->lslTimestamp;
+    const double referenceTs = (alpha < 0.5) ? prevTs : nextTs;
+
+    // Tap rows around the bracketing pair, clamped into the window so the
+    // higher-order modes still work one or two rows from either end.
+    const int taps = EegInterpKernel::tapCount(mode);
+    std::uint64_t tapRows[EegInterpKernel::MAX_TAPS];
+    float weights[EegInterpKernel::MAX_TAPS];
+    const std::int64_t firstTap = static_cast<std::int64_t>(it) + EegInterpKernel::firstTapOffset(mode);
+    for (int k = 0; k < taps; ++k)
+    {
+        tapRows[k] = static_cast<std::uint64_t>(std::clamp<std::int64_t>(
+            firstTap + k, static_cast<std::int64_t>(window.first),
+            static_cast<std::int64_t>(window.end - 1)));
+    }
+    EegInterpKernel::weights(mode, alpha, weights);
+
+    // Near the newest data (live frame lookups) the taps are whole
+    // contiguous rows in the ring's row-major recent window. That window
+    // is overwritten sooner than the planes, so check it here; if the
+    // writer got there first, redo the query from the planes, which the
+    // caller validates as usual.
+    if (ring.inRecent(window, tapRows[0]))
+    {
+        const float* rows[EegInterpKernel::MAX_TAPS];
+        for (int k = 0; k < taps; ++k)
+            rows[k] = ring.recentRow(tapRows[k]);
+        EegInterpKernel::weightedRows(rows, weights, taps, ring.width(), out);
+        if (ring.validateRecent(tapRows[0]))
+            return referenceTs;
+    }
 
-    return EegTimestampedSample(refTs, std::move(interpolated));
+    int slots[EegInterpKernel::MAX_TAPS];
+    for (int k = 0; k < taps; ++k)
+        slots[k] = static_cast<int>(ring.slot(tapRows[k]));
+    EegInterpKernel::weightedTaps(ring.channel(0), ring.capacity(), slots, weights, taps,
+                                  ring.width(), out);
+
+    return referenceTs;
 }
 
 // ============================================================================
@@ -316,48 +616,28 @@ EegTimestampedSample EegSyncManager::linearInterpolate(double adjustedTs) const
 
 void EegSyncManager::setLslInlet(lsl::stream_inlet* inlet)
 {
-    m_lslInlet = inlet;
-
+    m_clockWorker->setInlet(inlet);
     if (inlet)
-    {
-        updateTimeCorrection(); // Get an initial correction immediately
-        m_timeCorrectionTimer->start();
-        qInfo() << "[EegSyncManager] LSL inlet set, time correction timer started";
-    }
-    else
-    {
-        m_timeCorrectionTimer->stop();
-    }
+        qInfo() << "[EegSyncManager] LSL inlet set, time correction refresh started";
 }
 
-void EegSyncManager::updateTimeCorrection()
+double EegSyncManager::correctionAt(double videoTimestamp) const
 {
-    if (!m_lslInlet)
-        return;
+    const std::shared_ptr<const EegClockModel> clock = std::atomic_load(&m_clockModel);
+    return clock ? clock->correctionAt(videoTimestamp) : 0.0;
+}
 
-    try
-    {
-        m_prevTimeCorrection = m_timeCorrection;
-
-        // time_correction() blocks for up to 1 s while performing a
-        // network round-trip to the LSL transmitter. This is acceptable
-        // at a 10 s polling interval but must not be called on the hot path.
-        m_timeCorrection   = m_lslInlet->time_correction(1.0);
-        m_timeCorrectionMs = m_timeCorrection;
-
-        // Drift = how much the correction changed since the last update.
-        // Persistent drift indicates that the two clocks are running at
-        // measurably different rates (expected for USB devices: ~±50 ppm).
-        double delta = (m_timeCorrection - m_prevTimeCorrection) * 1000.0; // ms
-        m_clockDriftMs = delta;
-
-        qDebug() << "[EegSyncManager] Time correction:" << m_timeCorrection * 1000.0
-                 << "ms, drift:" << delta << "ms";
-    }
-    catch (const std::exception& e)
-    {
-        qWarning() << "[EegSyncManager] time_correction() failed:" << e.what();
-    }
+double EegSyncManager::timeCorrectionMs() const
+{
+    return correctionAt(lsl::local_clock()) * 1000.0;
+}
+
+double EegSyncManager::clockDriftMs() const
+{
+    // Drift per refresh interval, comparable to the step the old
+    // sample-and-hold correction made every 10 s.
+    const std::shared_ptr<const EegClockModel> clock = std::atomic_load(&m_clockModel);
+    return clock ? clock->slope * 10.0 * 1000.0 : 0.0;
 }
 
 // ============================================================================
@@ -366,55 +646,58 @@ void EegSyncManager::updateTimeCorrection()
 
 void EegSyncManager::setInterpolationMode(int mode)
 {
-    m_interpolationMode = (mode == 1) ? 1 : 0;
+    m_interpolationMode.store((mode >= Nearest && mode <= Sinc) ? mode : Nearest,
+                              std::memory_order_relaxed);
 }
 
 void EegSyncManager::clearBuffer()
 {
-    QMutexLocker locker(&m_mutex);
-    m_buffer.clear();
-    m_lastSyncOffsetMs  = 0.0;
-    m_avgSyncOffsetMs   = 0.0;
-    m_offsetSampleCount = 0;
-    m_offsetSum         = 0.0;
+    // Only the writer replaces the ring; it drops the old one on the next
+    // chunk. Query statistics are reader-side and reset right away.
+    m_clearRequested.store(true, std::memory_order_release);
+    {
+        QMutexLocker locker(&m_queryStatsMutex);
+        m_offsetSampleCount = 0;
+        m_offsetSum         = 0.0;
+    }
+    m_lastSyncOffsetMs.store(0.0, std::memory_order_relaxed);
+    m_avgSyncOffsetMs.store(0.0, std::memory_order_relaxed);
     emit statsChanged();
 }
 
 void EegSyncManager::setSamplingRate(double rate)
 {
-    if (rate <= 0.0 || qFuzzyCompare(m_samplingRate, rate))
+    if (rate <= 0.0 || qFuzzyCompare(samplingRate(), rate))
         return;
 
-    m_samplingRate = rate;
+    m_samplingRate.store(rate, std::memory_order_relaxed);
 
     // Resize buffer to hold exactly 30 s of data at the actual rate.
     // This must be done dynamically because the nominal rate in the LSL
     // stream metadata sometimes differs from the actual hardware rate.
-    m_maxBufferSize = static_cast<int>(rate * 30.0);
+    // The writer reallocates the ring with its next chunk.
+    m_maxBufferSize.store(static_cast<int>(rate * 30.0), std::memory_order_relaxed);
     emit maxBufferSizeChanged();
     emit samplingRateChanged();
 
     qInfo() << "[EegSyncManager] Sampling rate:" << rate
-            << "Hz, buffer:" << m_maxBufferSize << "samples"
+            << "Hz, buffer:" << maxBufferSize() << "samples"
             << ", samples/frame:" << samplesPerFrame();
 }
 
 double EegSyncManager::samplesPerFrame() const
 {
-    return (m_videoFps > 0.0) ? (m_samplingRate / m_videoFps) : 0.0;
+    return (m_videoFps > 0.0) ? (samplingRate() / m_videoFps) : 0.0;
 }
 
 void EegSyncManager::setMaxBufferSize(int size)
 {
-    if (size <= 0 || size == m_maxBufferSize)
+    if (size <= 0 || size == maxBufferSize())
         return;
 
-    m_maxBufferSize = size;
+    // Applied by the writer with its next chunk; the newest rows are kept.
+    m_maxBufferSize.store(size, std::memory_order_relaxed);
     emit maxBufferSizeChanged();
-
-    QMutexLocker locker(&m_mutex);
-    while (static_cast<int>(m_buffer.size()) > m_maxBufferSize)
-        m_buffer.pop_front();
 }
 
 // ============================================================================
@@ -423,45 +706,44 @@ void EegSyncManager::setMaxBufferSize(int size)
 
 int EegSyncManager::bufferSize() const
 {
-    QMutexLocker locker(&m_mutex);
-    return static_cast<int>(m_buffer.size());
+    return m_statBufferSize.load(std::memory_order_relaxed);
 }
 
 double EegSyncManager::oldestTimestamp() const
 {
-    QMutexLocker locker(&m_mutex);
-    return m_buffer.empty() ? 0.0 : m_buffer.front().lslTimestamp;
+    return m_statOldestTs.load(std::memory_order_relaxed);
 }
 
 double EegSyncManager::newestTimestamp() const
 {
-    QMutexLocker locker(&m_mutex);
-    return m_buffer.empty() ? 0.0 : m_buffer.back().lslTimestamp;
+    return m_statNewestTs.load(std::memory_order_relaxed);
 }
 
 double EegSyncManager::bufferDurationSec() const
 {
-    QMutexLocker locker(&m_mutex);
-    if (m_buffer.size() < 2) return 0.0;
-    return m_buffer.back().lslTimestamp - m_buffer.front().lslTimestamp;
+    if (bufferSize() < 2) return 0.0;
+    return newestTimestamp() - oldestTimestamp();
 }
 
 QString EegSyncManager::healthStatus() const
 {
-    if (m_lastSyncOffsetMs > 15.0) return QStringLiteral("DESYNC");
-    if (m_lastSyncOffsetMs >  5.0) return QStringLiteral("WARNING");
+    const double lastOffsetMs = lastSyncOffsetMs();
+    if (lastOffsetMs > 15.0) return QStringLiteral("DESYNC");
+    if (lastOffsetMs >  5.0) return QStringLiteral("WARNING");
     return QStringLiteral("SYNCED");
 }
 
 void EegSyncManager::updateRunningAverage(double offsetMs) const
 {
+    QMutexLocker locker(&m_queryStatsMutex);
+
     m_offsetSum += offsetMs;
     m_offsetSampleCount++;
 
     // Compute running average continuously, and reset the accumulator once
     // the window is full to avoid floating-point precision degradation over
     // long recording sessions.
-    m_avgSyncOffsetMs = m_offsetSum / m_offsetSampleCount;
+    m_avgSyncOffsetMs.store(m_offsetSum / m_offsetSampleCount, std::memory_order_relaxed);
 
     if (m_offsetSampleCount >= RUNNING_AVG_WINDOW)
     {
@@ -477,8 +759,10 @@ void EegSyncManager::updateRunningAverage(double offsetMs) const
 void EegSyncManager::markSessionStart()
 {
     m_sessionStartTime = lsl::local_clock();
-    m_outOfRangeCount  = 0;
-    m_totalQueryCount  = 0;
+    m_outOfRangeCount.store(0, std::memory_order_relaxed);
+    m_totalQueryCount.store(0, std::memory_order_relaxed);
+    m_indexLookupCount.store(0, std::memory_order_relaxed);
+    m_indexPredictedCount.store(0, std::memory_order_relaxed);
     emit sessionStartTimeChanged();
 
     qInfo() << "[EegSyncManager] Session started at LSL time:" << m_sessionStartTime;
@@ -486,33 +770,47 @@ void EegSyncManager::markSessionStart()
 
 void EegSyncManager::markSessionEnd()
 {
-    qInfo() << "[EegSyncManager] Session ended. Queries:" << m_totalQueryCount
-            << "Out-of-range:" << m_outOfRangeCount
-            << "(" << (m_totalQueryCount > 0
-                       ? QString::number(100.0 * m_outOfRangeCount / m_totalQueryCount, 'f', 1) + "%"
+    const int totalQueries = totalQueryCount();
+    const int outOfRange = outOfRangeCount();
+    qInfo() << "[EegSyncManager] Session ended. Queries:" << totalQueries
+            << "Out-of-range:" << outOfRange
+            << "(" << (totalQueries > 0
+                       ? QString::number(100.0 * outOfRange / totalQueries, 'f', 1) + "%"
                        : "N/A")
-            << ")";
+            << ")"
+            << "Index prediction:" << QString::number(indexPredictionRate(), 'f', 1) + "%";
 
     m_sessionStartTime = 0.0;
-    m_outOfRangeCount  = 0;
-    m_totalQueryCount  = 0;
+    m_outOfRangeCount.store(0, std::memory_order_relaxed);
+    m_totalQueryCount.store(0, std::memory_order_relaxed);
+    m_indexLookupCount.store(0, std::memory_order_relaxed);
+    m_indexPredictedCount.store(0, std::memory_order_relaxed);
     emit sessionStartTimeChanged();
 }
 
-bool EegSyncManager::isTimestampInRange(double videoTimestamp) const
+double EegSyncManager::indexPredictionRate() const
 {
-    QMutexLocker locker(&m_mutex);
+    const int lookups = m_indexLookupCount.load(std::memory_order_relaxed);
+    if (lookups <= 0)
+        return 0.0;
+    return 100.0 * m_indexPredictedCount.load(std::memory_order_relaxed) / lookups;
+}
 
-    if (m_buffer.empty() || videoTimestamp <= 0.0)
+bool EegSyncManager::isTimestampInRange(double videoTimestamp) const
+{
+    if (bufferSize() == 0 || videoTimestamp <= 0.0)
         return false;
 
-    double adjustedTs = videoTimestamp - m_timeCorrection;
-    double oldest     = m_buffer.front().lslTimestamp;
-    double newest     = m_buffer.back().lslTimestamp;
+    // The published range lags the ring by at most one chunk, which the
+    // tolerance below does not cover but callers of a pre-check accept.
+    double adjustedTs = videoTimestamp - correctionAt(videoTimestamp);
+    double oldest     = oldestTimestamp();
+    double newest     = newestTimestamp();
 
     // Tolerance: one inter-sample interval prevents false negatives
     // at the exact buffer boundaries due to floating-point imprecision.
-    double tolerance = (m_samplingRate > 0.0) ? (1.0 / m_samplingRate) : 0.004;
+    const double rate = samplingRate();
+    double tolerance = (rate > 0.0) ? (1.0 / rate) : 0.004;
 
     return (adjustedTs >= oldest - tolerance) && (adjustedTs <= newest + tolerance);
 }
@@ -12,8 +12,10 @@
  *  DESIGN PATTERNS:
  *    Singleton (QML_SINGLETON) — one shared instance across EegBackend
  *    (writer) and VideoBackend / VideoDisplayWindow (readers).
- *    Monitor — QMutex guards the buffer for safe concurrent access from
- *    the main thread (reads) and the hot-path EEG update (writes).
+ *    Single writer / many readers — samples live in an EegSyncRing that
+ *    the LSL worker thread appends to while queries read it lock-free
+ *    (seqlock validation, see eegsyncring.h). Readers never block the
+ *    writer and never block each other.
  *
  *  THE CLOCK DRIFT PROBLEM:
  *    The EEG amplifier's hardware clock and the PC's system clock run at
@@ -23,26 +25,48 @@
  *
  *    LSL's time_correction() solves this: it performs a network round-trip
  *    measurement and returns the offset to add to local_clock() values to
- *    convert them to the LSL-global time base. We refresh this correction
- *    every 10 seconds and apply it to every timestamp lookup, keeping
- *    synchronization accurate over 24-hour recordings.
+ *    convert them to the LSL-global time base. ClockCorrectionWorker takes
+ *    a measurement every 10 seconds on its own thread and fits offset +
+ *    drift rate over the last few minutes (EegClockModel); each lookup
+ *    evaluates the model at its own video timestamp, so the correction
+ *    tracks the drift between measurements instead of stepping every
+ *    10 s, keeping synchronization accurate over 24-hour recordings.
  *
  *  DATA FLOW:
- *    [WRITE]  EegBackend::onDataReceived()
- *               → addEegSamples(chunk, timestamps, channelIndices)
- *                   • Stores raw μV values with LSL timestamps
- *                   • Enforces rolling max-size (30 s × sampling rate)
+ *    [WRITE]  EegChunkDispatcher (direct subscriber, LSL worker thread)
+ *               → addEegSamples(chunk)
+ *                   • Stores the derivations of the active montage
+ *                     (setMontage, pushed by EegBackend) in unfiltered μV,
+ *                     with LSL timestamps. The referential montage is the
+ *                     plain channel selection.
+ *                   • Fixed-capacity ring (30 s × sampling rate); the
+ *                     oldest rows are overwritten in place. One timestamp
+ *                     array + one channel-major sample block + a row-major
+ *                     copy of the newest rows, no per-sample allocation
  *
  *    [READ]   VideoBackend / VideoDisplayWindow
  *               → getEEGForFrame(videoTimestamp)   — single-sample lookup
  *               → getEEGRangeForFrame(start, end)  — range query for a frame interval
  *
  *  INTERPOLATION MODES:
- *    Mode 0 (nearest neighbor) — O(log N) binary search, returns closest
- *      sample. Suitable for low-latency display annotation.
+ *    Mode 0 (nearest neighbor) — returns the closest sample. The row is
+ *      predicted in O(1) from the regular-sampling model of the ring and
+ *      falls back to an O(log N) binary search across gaps (see
+ *      eegsyncring.h; indexPredictionRate reports the fast-path share).
+ *      Suitable for low-latency display annotation.
  *    Mode 1 (linear)           — Interpolates between the two samples
  *      bracketing the query timestamp. Provides smoother results for
  *      analysis where the inter-sample interval (~4 ms at 256 Hz) matters.
+ *    Mode 2 (cubic)            — Catmull-Rom over 4 samples around the
+ *      query; follows curvature that linear interpolation cuts off.
+ *    Mode 3 (sinc)             — Lanczos-3 windowed sinc over 6 samples,
+ *      the closest to band-limited reconstruction.
+ *    All interpolating modes compute every channel in one pass into the
+ *    caller's buffer (eeginterpkernel.h). Queries within the ring's
+ *    row-major recent window (the newest EegSyncRing::RECENT_ROWS rows,
+ *    where live frames land) use unit-stride vector loads: a 128-channel
+ *    linear query costs ~0.1–0.3 µs, sinc ~1 µs. Older rows go through
+ *    the channel-major planes, one cache line per channel (~4–8 µs).
  *
  *  BUFFER SIZING:
  *    Default: 7680 samples = 30 s × 256 Hz. Recalculated when the actual
@@ -66,9 +90,24 @@
  *    when they start at different wall-clock times.
  *
  *  THREAD SAFETY:
- *    addEegSamples()         — called on the main thread from EegBackend
- *    getEEGForFrame()        — may be called from QML / UI thread
- *    All methods lock m_mutex before accessing m_buffer.
+ *    addEegSamples()         — the only writer; called on the LSL worker
+ *                              thread by the dispatcher, independent of
+ *                              GUI load. Also the only thread that
+ *                              replaces m_ring (capacity / width change,
+ *                              clear request).
+ *    setMontage()            — main thread; m_configMutex guards the
+ *                              pointer, taken once per chunk by the writer
+ *    getEEGForFrame() etc.   — any thread; atomic_load of m_ring, then
+ *                              lock-free reads validated against the writer
+ *    setLslInlet()           — LSL worker thread (direct connection);
+ *                              blocks until no time_correction() call
+ *                              uses the previous inlet
+ *    m_clockModel            — replaced by ClockCorrectionWorker on its
+ *                              thread (atomic_store), read by queries with
+ *                              atomic_load; time_correction() never runs
+ *                              on a query or GUI thread
+ *    Stats properties        — plain atomics published by the writer and
+ *                              by queries; no lock on the QML polling path
  *
  * ==========================================================================
  */
@@ -78,31 +117,36 @@
 
 #include <QObject>
 #include <QMutex>
+#include <QThread>
 #include <QTimer>
 #include <QVector>
 #include <QVariantMap>
 #include <QVariantList>
 #include <QQmlEngine>
 #include <QtQml/qqmlregistration.h>
-#include <deque>
-#include <vector>
+#include <atomic>
+#include <memory>
 #include <lsl_cpp.h>
+#include "eegchunk.h"
+#include "eegclockmodel.h"
+#include "eeginterpkernel.h"
+#include "eegmontage.h"
+#include "eegsyncring.h"
+
+class ClockCorrectionWorker;
 
 /*
- * Timestamped EEG sample — the atomic unit stored in the sync buffer.
- * Intentionally lightweight: only the selected channels are stored (not
- * all hardware channels) to reduce memory footprint and copy cost.
+ * Result of a batch frame query (EegSyncManager::getEEGForFrames), one
+ * entry per requested frame, in request order. Typed and flat so a whole
+ * session's worth of frames can be aligned without boxing every value.
  */
-struct EegTimestampedSample
+struct EegFrameBatch
 {
-    double lslTimestamp = 0.0;
-    std::vector<float> channels;
-
-    EegTimestampedSample() = default;
-    EegTimestampedSample(double ts, std::vector<float> vals)
-        : lslTimestamp(ts), channels(std::move(vals)) {}
-
-    bool isValid() const { return lslTimestamp > 0.0 && !channels.empty(); }
+    int channelCount = 0;
+    QList<double> eegTimestamps;    // Matched EEG timestamp (0 = no match)
+    QList<double> offsetsMs;        // |adjusted videoTs − matched EEG ts|
+    QList<double> rangeErrorsMs;    // Distance outside the buffer range (0 = inside)
+    QList<float> values;            // [frame * channelCount + channel], μV
 };
 
 class EegSyncManager : public QObject
@@ -134,8 +178,19 @@ class EegSyncManager : public QObject
     Q_PROPERTY(bool isSessionActive READ isSessionActive NOTIFY sessionStartTimeChanged FINAL)
     Q_PROPERTY(int outOfRangeCount READ outOfRangeCount NOTIFY statsChanged FINAL)
     Q_PROPERTY(int totalQueryCount READ totalQueryCount NOTIFY statsChanged FINAL)
+    Q_PROPERTY(double indexPredictionRate READ indexPredictionRate NOTIFY statsChanged FINAL)
 
 public:
+    /* Sample lookup mode for getEEGForFrame() / getEEGForFrames(). */
+    enum InterpolationMode
+    {
+        Nearest,
+        Linear,
+        Cubic,
+        Sinc
+    };
+    Q_ENUM(InterpolationMode)
+
     static EegSyncManager* instance();
     static EegSyncManager* create(QQmlEngine* qmlEngine, QJSEngine* jsEngine);
 
@@ -143,26 +198,34 @@ public:
     ~EegSyncManager();
 
     // -----------------------------------------------------------------------
-    // Data input — called by EegBackend on the main thread
+    // Data input — fed by EegChunkDispatcher on the LSL worker thread
     // -----------------------------------------------------------------------
 
     /*
      * Appends a chunk of raw EEG samples to the rolling sync buffer.
      *
-     * Only the channels listed in channelIndices are stored. This mirrors
-     * the user's channel selection in the display, keeping sync data
-     * consistent with what is shown and recorded.
+     * Only the derivations of the montage set by setMontage() are stored.
+     * This mirrors the display, so a sync query returns the same traces
+     * (bipolar, average, …) the user is looking at. The recording is not
+     * affected — it always keeps the raw hardware channels.
      *
-     * If channelIndices is empty, all hardware channels are stored.
-     * The buffer is trimmed to m_maxBufferSize after each insertion.
+     * If no montage is set, all hardware channels are stored. Rows go
+     * into the fixed-capacity ring without allocating; a new ring is made
+     * only when the capacity or the derivation count changes (history is
+     * kept across a capacity change, not across a width change).
      *
-     * @param chunk          Raw EEG data [sample][channel] in μV
-     * @param timestamps     LSL timestamp per sample (from lsl::pull_chunk)
-     * @param channelIndices Selected channel indices into the chunk rows
+     * @param chunk  Raw EEG data (interleaved μV + LSL timestamps)
      */
-    void addEegSamples(const std::vector<std::vector<float>>& chunk,
-                       const std::vector<double>& timestamps,
-                       const QVector<int>& channelIndices);
+    void addEegSamples(const EegChunk& chunk);
+
+    /*
+     * Sets the montage addEegSamples() applies. Called by EegBackend
+     * whenever the channel selection or the montage changes; safe to call
+     * while chunks are being ingested on the worker thread (the pointer is
+     * swapped under m_configMutex, the montage itself is immutable). If
+     * the derivation count changes, the buffer restarts empty.
+     */
+    void setMontage(EegMontagePtr montage);
 
     // -----------------------------------------------------------------------
     // Synchronization queries — called by VideoBackend / QML
@@ -204,11 +267,40 @@ public:
      */
     Q_INVOKABLE QVariantList getEEGRangeForFrame(double startTs, double endTs) const;
 
+    /*
+     * Batch form of getEEGForFrame() for many frames at once (high-FPS
+     * cameras, post-hoc alignment of a whole session). The timestamps
+     * should be ascending: one lookup places the first frame, later frames
+     * are found by walking forward from the previous match (a merge-walk
+     * of frames against EEG rows), all under one consistent ring snapshot.
+     * Out-of-order timestamps are still answered, each with its own lookup.
+     *
+     * Counts toward the same per-session statistics as getEEGForFrame();
+     * the batch's mean offset enters the running average once.
+     *
+     * @return false if the buffer is empty or could not be read
+     *         consistently; `batch` then holds no matches.
+     */
+    bool getEEGForFrames(const QList<double>& videoTimestamps, EegFrameBatch& batch) const;
+
+    /*
+     * QML form of the batch query. Result keys:
+     *   "channelCount"  — int
+     *   "timestamps"    — list<double>: matched EEG timestamps (0 = none)
+     *   "offsetsMs"     — list<double>
+     *   "rangeErrorsMs" — list<double>: 0 when the frame is inside the buffer
+     *   "values"        — list<float>: frame-major, channelCount per frame
+     */
+    Q_INVOKABLE QVariantMap getEEGForFrames(const QList<double>& videoTimestamps) const;
+
     // -----------------------------------------------------------------------
     // Configuration
     // -----------------------------------------------------------------------
 
-    Q_INVOKABLE void setInterpolationMode(int mode); // 0=nearest, 1=linear
+    Q_INVOKABLE void setInterpolationMode(int mode); // InterpolationMode; out of range = Nearest
+
+    /* Requests an empty buffer. The writer drops the ring with the next
+     * chunk; sync statistics reset immediately. */
     Q_INVOKABLE void clearBuffer();
 
     // -----------------------------------------------------------------------
@@ -225,7 +317,8 @@ public:
 
     /*
      * Clears the session start timestamp and resets per-session counters
-     * (out-of-range count, total query count). Called at session end.
+     * (out-of-range count, total query count, index prediction rate).
+     * Called at session end.
      */
     Q_INVOKABLE void markSessionEnd();
 
@@ -233,8 +326,12 @@ public:
     bool isSessionActive() const { return m_sessionStartTime > 0.0; }
 
     // --- Diagnostic counters (per session) ---
-    int outOfRangeCount() const { return m_outOfRangeCount; }
-    int totalQueryCount() const { return m_totalQueryCount; }
+    int outOfRangeCount() const { return m_outOfRangeCount.load(std::memory_order_relaxed); }
+    int totalQueryCount() const { return m_totalQueryCount.load(std::memory_order_relaxed); }
+
+    /* Percentage of timestamp→row lookups resolved by the regular-sampling
+     * prediction rather than binary search (0 before the first lookup). */
+    double indexPredictionRate() const;
 
     /*
      * Returns true if videoTimestamp falls within the current buffer range
@@ -252,13 +349,13 @@ public:
      * exactly 30 seconds of data at the actual rate.
      */
     void setSamplingRate(double rate);
-    double samplingRate() const { return m_samplingRate; }
+    double samplingRate() const { return m_samplingRate.load(std::memory_order_relaxed); }
 
     /* Expected number of EEG samples per video frame: samplingRate / videoFPS */
     double samplesPerFrame() const;
 
     int bufferSize() const;
-    int maxBufferSize() const { return m_maxBufferSize; }
+    int maxBufferSize() const { return m_maxBufferSize.load(std::memory_order_relaxed); }
     void setMaxBufferSize(int size);
 
     double oldestTimestamp() const;
@@ -266,10 +363,12 @@ public:
     double bufferDurationSec() const;
 
     // Sync quality accessors
-    double lastSyncOffsetMs() const { return m_lastSyncOffsetMs; }
-    double avgSyncOffsetMs() const { return m_avgSyncOffsetMs; }
-    double clockDriftMs() const { return m_clockDriftMs; }
-    double timeCorrectionMs() const { return m_timeCorrectionMs * 1000.0; }
+    double lastSyncOffsetMs() const { return m_lastSyncOffsetMs.load(std::memory_order_relaxed); }
+    double avgSyncOffsetMs() const { return m_avgSyncOffsetMs.load(std::memory_order_relaxed); }
+    /* Fitted drift accumulated over one 10 s refresh interval, and the
+     * correction the model gives for "now". 0 before the first measurement. */
+    double clockDriftMs() const;
+    double timeCorrectionMs() const;
 
     /*
      * Health thresholds (empirical for clinical EEG-video synchronization):
@@ -282,8 +381,10 @@ public:
     /*
      * Provides the LSL stream inlet used for time_correction() queries.
      * Must be called after the LSL stream is resolved (in AmplifierManager
-     * after lsl::resolve_stream succeeds). Without this, m_timeCorrection
-     * stays at 0.0 and no drift correction is applied.
+     * after lsl::resolve_stream succeeds), and with nullptr before the
+     * inlet is deleted — that call waits for an in-flight measurement to
+     * finish. Without an inlet no clock model is fitted and no drift
+     * correction is applied.
      */
     void setLslInlet(lsl::stream_inlet* inlet);
 
@@ -294,47 +395,91 @@ signals:
     void sessionStartTimeChanged();
 
 private:
-    /* Performs a blocking time_correction() call (1 s timeout) to update
-     * m_timeCorrection. Called once on setLslInlet() and then every 10 s
-     * by m_timeCorrectionTimer to track long-term clock drift. */
-    void updateTimeCorrection();
-
-    /* O(log N) binary search returning the sample with the timestamp
-     * closest to adjustedTs (EEG time base after drift correction). */
-    EegTimestampedSample nearestNeighbor(double adjustedTs) const;
-
-    /* Linear interpolation between the two samples bracketing adjustedTs.
-     * Falls back to nearestNeighbor at buffer boundaries. */
-    EegTimestampedSample linearInterpolate(double adjustedTs) const;
+    /* Clock correction (seconds) to subtract from a local video timestamp,
+     * from the latest fitted model; 0 until the first measurement. */
+    double correctionAt(double videoTimestamp) const;
+
+    /* Current ring for lock-free reading (may be null before data). */
+    std::shared_ptr<EegSyncRing> readRing() const { return std::atomic_load(&m_ring); }
+
+    /* First row at or after adjustedTs (EegSyncRing::lowerBound), counting
+     * whether the O(1) prediction resolved it. */
+    std::uint64_t findRow(const EegSyncRing& ring, const EegSyncRing::Window& window,
+                          double adjustedTs) const;
+
+    /* Sample for adjustedTs (EEG time base after drift correction), given
+     * `row` = the first row at or after it (findRow or a merge-walk).
+     * Dispatches on `mode`, writes ring.width() values to `out` and
+     * returns the matched timestamp (0 if the window is empty).
+     * Reads `window` of `ring` without validating; the caller does. */
+    double sampleAt(const EegSyncRing& ring, const EegSyncRing::Window& window,
+                    std::uint64_t row, double adjustedTs, int mode, float* out) const;
+
+    /* The row closest to adjustedTs: `row` or the one before it. */
+    double nearestNeighbor(const EegSyncRing& ring, const EegSyncRing::Window& window,
+                           std::uint64_t row, double adjustedTs, float* out) const;
+
+    /* Linear, cubic or sinc interpolation around the rows bracketing
+     * adjustedTs (`row` − 1 and `row`), all channels at once with
+     * EegInterpKernel. Taps beyond the buffer repeat the boundary row;
+     * at the very edges the boundary row itself is returned. Reads the
+     * ring's row-major recent window when the taps are in it (validated
+     * here), the channel planes otherwise (validated by the caller). */
+    double interpolate(const EegSyncRing& ring, const EegSyncRing::Window& window,
+                       std::uint64_t row, double adjustedTs, EegInterpKernel::Mode mode,
+                       float* out) const;
+
+    /* Frames further apart than this many rows are placed by findRow()
+     * instead of walking row by row. */
+    static constexpr std::uint64_t MERGE_WALK_LIMIT = 64;
+
+    /* Writer side: publishes buffer size and time range for the stats
+     * properties after each chunk. */
+    void publishBufferStats(const EegSyncRing& ring);
 
     /* Maintains a rolling average of sync offset over RUNNING_AVG_WINDOW
      * frames. Resets the accumulator once the window is filled to prevent
-     * unbounded growth of m_offsetSum. */
+     * unbounded growth of m_offsetSum. Guarded by m_queryStatsMutex. */
     void updateRunningAverage(double offsetMs) const;
 
     static EegSyncManager* s_instance;
 
-    mutable QMutex m_mutex;
-    std::deque<EegTimestampedSample> m_buffer; // Sorted ascending by lslTimestamp
-    int m_maxBufferSize = 7680;                // 30 s × 256 Hz default
+    /* The sample ring. Replaced only by the writer thread (atomic_store);
+     * readers take a reference with readRing(). Rows are sorted ascending
+     * by lslTimestamp. */
+    std::shared_ptr<EegSyncRing> m_ring;
+    std::atomic<int> m_maxBufferSize{7680};    // 30 s × 256 Hz default; applied by the writer
+    std::atomic<bool> m_clearRequested{false}; // Set by clearBuffer(), consumed by the writer
+
+    /* A failed validation means a write overtook the query; a few retries
+     * are plenty since writes arrive every few milliseconds at most. */
+    static constexpr int MAX_READ_ATTEMPTS = 4;
+
+    QMutex m_configMutex;                      // Guards m_montage only
+    EegMontagePtr m_montage;                   // Derivations to store (null = all channels)
+
+    // Buffer stats, published by the writer after each chunk
+    std::atomic<int> m_statBufferSize{0};
+    std::atomic<double> m_statOldestTs{0.0};
+    std::atomic<double> m_statNewestTs{0.0};
 
-    double m_samplingRate = 256.0;
-    int m_interpolationMode = 0; // 0=nearest, 1=linear
+    std::atomic<double> m_samplingRate{256.0};
+    std::atomic<int> m_interpolationMode{Nearest}; // InterpolationMode
     double m_videoFps = 30.0;
 
-    // LSL clock drift correction
-    lsl::stream_inlet* m_lslInlet = nullptr;
-    double m_timeCorrection = 0.0;      // Current correction offset in seconds
-    double m_prevTimeCorrection = 0.0;  // Previous value — used to compute drift rate
-    QTimer* m_timeCorrectionTimer = nullptr;
+    // LSL clock drift correction — measured on m_clockThread, published
+    // here by atomic_store (see THREAD SAFETY)
+    QThread* m_clockThread = nullptr;
+    ClockCorrectionWorker* m_clockWorker = nullptr;
+    std::shared_ptr<const EegClockModel> m_clockModel;
 
     // Sync quality monitoring
-    mutable double m_lastSyncOffsetMs = 0.0;
-    mutable double m_avgSyncOffsetMs = 0.0;
-    double m_clockDriftMs = 0.0;
-    double m_timeCorrectionMs = 0.0;
+    mutable std::atomic<double> m_lastSyncOffsetMs{0.0};
+    mutable std::atomic<double> m_avgSyncOffsetMs{0.0};
 
-    // Running average accumulators
+    // Running average accumulators — shared by concurrent queries only;
+    // the writer never takes this lock
+    mutable QMutex m_queryStatsMutex;
     mutable int m_offsetSampleCount = 0;
     mutable double m_offsetSum = 0.0;
     static constexpr int RUNNING_AVG_WINDOW = 100;
@@ -343,8 +488,10 @@ private:
     double m_sessionStartTime = 0.0;    // LSL timestamp at session start (0 = no active session)
 
     // Diagnostic counters (per session, reset on markSessionEnd)
-    mutable int m_outOfRangeCount = 0;  // Number of getEEGForFrame() calls with timestamp outside buffer
-    mutable int m_totalQueryCount = 0;  // Total getEEGForFrame() calls during session
+    mutable std::atomic<int> m_outOfRangeCount{0};  // Number of getEEGForFrame() calls with timestamp outside buffer
+    mutable std::atomic<int> m_totalQueryCount{0};  // Total getEEGForFrame() calls during session
+    mutable std::atomic<int> m_indexLookupCount{0};    // Timestamp→row lookups (findRow)
+    mutable std::atomic<int> m_indexPredictedCount{0}; // … of which resolved by prediction
 
     // Throttled stats notify timer — emits statsChanged() at 4 Hz to QML
     QTimer* m_statsTimer = nullptr;
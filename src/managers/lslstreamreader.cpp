@@ -7,7 +7,9 @@
  */
 
 #include "lslstreamreader.h"
+#include "eegchunkdispatcher.h"
 #include <QDebug>
+#include <algorithm>
 
 LSLStreamReader::LSLStreamReader(QObject* parent)
     : QObject(parent)
@@ -15,31 +17,59 @@ LSLStreamReader::LSLStreamReader(QObject* parent)
 
 LSLStreamReader::~LSLStreamReader()
 {
-    /* Safety net: if the worker thread is being destroyed while still running,
-     * ensure the inlet is cleanly closed to avoid dangling LSL connections. */
-    onStopReading();
+    /* Safety net: onStartReading() closes the inlet itself before it
+     * returns, so this only matters if the reader is destroyed without its
+     * thread ever having run the slot to completion. */
+    requestStop();
+    closeInlet();
+}
+
+void LSLStreamReader::requestStop()
+{
+    /* Only a flag: the worker thread is inside onStartReading() and cannot
+     * process queued slots, so it must notice the stop on its own. */
+    m_stopRequested = true;
+}
+
+void LSLStreamReader::setAcquisitionMode(AcquisitionMode mode)
+{
+    if (m_acquisitionMode.exchange(mode) != mode)
+    {
+        qDebug() << "LSL acquisition mode:" << mode;
+    }
 }
 
 void LSLStreamReader::onStartReading()
 {
-    /* Guard against duplicate invocations — can happen if the user clicks
-     * "connect" rapidly or if a delayed QTimer::singleShot fires twice. */
-    if (m_isRunning)
+    /* A start queued behind a stop (or a duplicate start from a delayed
+     * QTimer::singleShot) must not reopen the stream. */
+    if (m_stopRequested)
     {
-        qDebug() << "LSL reader already running";
+        qDebug() << "LSL reader stopped, ignoring start request";
         return;
     }
 
     try {
         /*
          * resolve_stream() performs a network multicast/broadcast to discover
-         * any LSL outlet publishing type="EEG". The 5-second timeout allows
-         * for Svarog Streamer startup latency. Only the first matching stream
-         * is used — multi-amplifier setups are not currently supported.
+         * any LSL outlet publishing type="EEG". The 5-second budget allows
+         * for Svarog Streamer startup latency; it is spent in short slices so
+         * a stop request does not have to wait for it. Only the first
+         * matching stream is used — multi-amplifier setups are not currently
+         * supported.
          */
         qDebug() << "Resolving LSL stream";
-        std::vector<lsl::stream_info> results = lsl::resolve_stream("type", "EEG", 1, 5.0);
+        std::vector<lsl::stream_info> results;
+        for (double waited = 0.0; results.empty() && waited < RESOLVE_TIMEOUT_S && !m_stopRequested;
+             waited += RESOLVE_SLICE_S)
+        {
+            results = lsl::resolve_stream("type", "EEG", 1, RESOLVE_SLICE_S);
+        }
 
+        if (m_stopRequested)
+        {
+            return;
+        }
         if (results.empty())
         {
             emit errorOccurred("No EEG stream found");
@@ -51,7 +81,10 @@ void LSLStreamReader::onStartReading()
         qDebug() << "LSL stream sampling rate:" << samplingRate << "Hz";
 
         m_inlet = new lsl::stream_inlet(info);
-        qDebug() << "Connected to LSL stream";
+        m_channelCount = info.channel_count();
+        m_firstRow.assign(m_channelCount, 0.0f);
+        m_dejitter.reset(samplingRate);
+        qDebug() << "Connected to LSL stream," << m_channelCount << "channels";
 
         /* Notify downstream components in dependency order:
          * 1. inletReady    → EegSyncManager needs the inlet for time_correction()
@@ -61,21 +94,29 @@ void LSLStreamReader::onStartReading()
         emit samplingRateDetected(samplingRate);
         emit streamConnected();
 
-        m_isRunning = true;
         readLoop();
+
+        /* The fit is only touched by this thread, so report it here. */
+        if (m_dejitter.isEnabled())
+        {
+            qDebug() << "LSL timestamp dejitter: fitted rate"
+                     << (m_dejitter.period() > 0.0 ? 1.0 / m_dejitter.period() : 0.0)
+                     << "Hz, residual jitter" << m_dejitter.residualRms() * 1000.0
+                     << "ms RMS," << m_dejitter.bridgedGaps() << "dropouts bridged,"
+                     << m_dejitter.gapResets() << "gap resets";
+        }
     }
     catch (const std::exception& e)
     {
         emit errorOccurred(QString("LSL error: %1").arg(e.what()));
     }
+
+    /* Still on the worker thread, so no pull can be using the inlet. */
+    closeInlet();
 }
 
-void LSLStreamReader::onStopReading()
+void LSLStreamReader::closeInlet()
 {
-    /* Atomic write breaks the readLoop() while-condition. The loop will
-     * exit within one poll cycle (~20ms). */
-    m_isRunning = false;
-
     if (m_inlet)
     {
         /* Signal nullptr first so EegSyncManager releases its reference
@@ -89,24 +130,26 @@ void LSLStreamReader::onStopReading()
 
 void LSLStreamReader::readLoop()
 {
-    std::vector<std::vector<float>> chunk;
-    std::vector<double> timestamps;
-
-    while (m_isRunning)
+    while (!m_stopRequested)
     {
+        const bool cpuOptimized = (m_acquisitionMode == AcquisitionMode::CpuOptimized);
+
         try
         {
-            /*
-             * pull_chunk() retrieves all samples buffered since the last call.
-             * Returns immediately if no data is available (non-blocking).
-             * Typical chunk size: ~5-10 samples at 256 Hz with 20ms poll interval.
-             */
-            m_inlet->pull_chunk(chunk, timestamps);
-            if (!chunk.empty())
+            if (cpuOptimized)
             {
-                emit dataReceived(chunk, timestamps);
-                chunk.clear();
-                timestamps.clear();
+                /* Non-blocking: take everything buffered since the last poll.
+                 * Loops in case more than MAX_CHUNK_SAMPLES accumulated. */
+                while (EegChunkPtr chunk = pullAvailable())
+                {
+                    publish(chunk);
+                }
+            }
+            else if (EegChunkPtr chunk = waitForChunk())
+            {
+                /* Blocking: waitForChunk() sleeps inside LSL until the first
+                 * sample is queued, so there is no poll interval to wait out. */
+                publish(chunk);
             }
         }
         catch (const std::exception& e)
@@ -115,8 +158,89 @@ void LSLStreamReader::readLoop()
         }
 
         /* 20ms sleep = ~50 Hz poll rate. This prevents CPU spinning while
-         * remaining responsive enough for real-time EEG display. At 256 Hz
-         * sampling, each poll yields ~5 samples on average. */
-        QThread::sleep(std::chrono::milliseconds(20));
+         * remaining responsive enough for real-time EEG display. Only needed
+         * in CPU mode — the latency-optimized wait already blocks in LSL. */
+        if (cpuOptimized)
+        {
+            QThread::sleep(std::chrono::milliseconds(CPU_POLL_INTERVAL_MS));
+        }
+    }
+}
+
+EegChunkPtr LSLStreamReader::waitForChunk()
+{
+    /* pull_sample() with a timeout blocks on the inlet's internal queue and
+     * returns the moment a sample is pushed into it (timestamp 0.0 means the
+     * timeout expired). pull_chunk_multiplexed(timeout) is not suitable here
+     * because it waits for the whole buffer to fill, not for the first sample. */
+    double ts = m_inlet->pull_sample(m_firstRow.data(), m_channelCount, LATENCY_WAIT_TIMEOUT_S);
+    if (ts == 0.0)
+    {
+        return nullptr;
+    }
+
+    /* Collect whatever else already arrived in the same network packet so a
+     * multi-sample push from the outlet is still delivered as one chunk. */
+    return pullAvailable(ts);
+}
+
+EegChunkPtr LSLStreamReader::pullAvailable(double firstTimestamp)
+{
+    const size_t channels = static_cast<size_t>(m_channelCount);
+    const size_t leading = (firstTimestamp > 0.0) ? 1 : 0;
+    const size_t queued = std::min(m_inlet->samples_available(), MAX_CHUNK_SAMPLES);
+    const size_t capacity = leading + queued;
+
+    if (capacity == 0 || channels == 0)
+    {
+        return nullptr;
+    }
+
+    /* Recycled chunk: resize() stays within the capacity of earlier pulls,
+     * so in steady state nothing is allocated. pull_chunk_multiplexed() then
+     * writes straight into the buffers — no per-sample vectors, no copy. */
+    std::shared_ptr<EegChunk> chunk = m_chunkPool.acquire();
+    chunk->channelCount = m_channelCount;
+    chunk->samples.resize(capacity * channels);
+    chunk->timestamps.resize(capacity);
+
+    size_t rows = 0;
+    if (leading)
+    {
+        std::copy(m_firstRow.begin(), m_firstRow.end(), chunk->samples.begin());
+        chunk->timestamps[0] = firstTimestamp;
+        rows = 1;
+    }
+
+    if (queued > 0)
+    {
+        const size_t written = m_inlet->pull_chunk_multiplexed(
+            chunk->samples.data() + rows * channels,
+            chunk->timestamps.data() + rows,
+            queued * channels, queued, 0.0);
+        rows += written / channels;
+    }
+
+    if (rows == 0)
+    {
+        return nullptr; // Dropping the handle returns the chunk to the pool
+    }
+
+    /* samples_available() is an upper bound; shrinking the logical size
+     * keeps the allocation and never reallocates. */
+    chunk->sampleCount = static_cast<int>(rows);
+    chunk->samples.resize(rows * channels);
+    chunk->timestamps.resize(rows);
+
+    /* Still exclusively ours: fix the timestamps before any consumer sees them. */
+    m_dejitter.process(chunk->timestamps.data(), rows);
+    return chunk;
+}
+
+void LSLStreamReader::publish(const EegChunkPtr& chunk)
+{
+    if (m_dispatcher)
+    {
+        m_dispatcher->publish(chunk);
     }
 }
@@ -20,39 +20,85 @@
  *    │  LSL Worker Thread (managed by AmplifierManager)           │
  *    │                                                            │
  *    │  onStartReading()                                          │
- *    │    ├─ lsl::resolve_stream("type","EEG") — blocks up to 5s │
+ *    │    ├─ lsl::resolve_stream("type","EEG") — up to 5s        │
  *    │    ├─ new lsl::stream_inlet(info)                          │
  *    │    ├─ emit inletReady / samplingRateDetected / connected   │
- *    │    └─ readLoop()  ←── tight poll loop                      │
- *    │         ├─ inlet->pull_chunk()                             │
- *    │         ├─ emit dataReceived(chunk, timestamps)            │
- *    │         └─ sleep 20ms  ←── yield to prevent CPU spin       │
+ *    │    ├─ readLoop()  ←── acquisition loop                     │
+ *    │    │    ├─ LatencyOptimized: block in pull_sample() until  │
+ *    │    │    │    the first sample arrives, then drain the rest │
+ *    │    │    ├─ CpuOptimized: drain queue + sleep 20ms          │
+ *    │    │    └─ EegChunkDispatcher::publish(EegChunkPtr)        │
+ *    │    └─ closeInlet()  ←── once requestStop() ends the loop   │
  *    └─────────────────────────────────────────────────────────────┘
- *              │ signals (Qt::QueuedConnection)
+ *              │ data: dispatcher fan-out (direct or queued per consumer)
+ *              │ control/state: signals (Qt::QueuedConnection)
  *              ▼
- *    ┌──────────────────────────┐
- *    │  Main Thread             │
- *    │  AmplifierManager slots  │
- *    └──────────────────────────┘
+ *    ┌──────────────────────────────────────────┐
+ *    │  Consumers (see eegchunkdispatcher.h)    │
+ *    │  AmplifierManager slots (state signals)  │
+ *    └──────────────────────────────────────────┘
  *
  *  DATA FORMAT:
- *    chunk      — std::vector<std::vector<float>>  [sample_index][channel_index]
- *                 Values in microvolts (μV), as delivered by Svarog Streamer.
- *    timestamps — std::vector<double>  [sample_index]
- *                 LSL timestamps (lsl::local_clock() domain, seconds since epoch).
+ *    EegChunkPtr (see eegchunk.h) — shared, immutable, interleaved buffer
+ *    taken from m_chunkPool (see eegchunkpool.h) and filled in place by
+ *    pull_chunk_multiplexed():
+ *      samples    — [sample_index * channelCount + channel_index]
+ *                   Values in microvolts (μV), as delivered by Svarog Streamer.
+ *      timestamps — [sample_index]
+ *                   LSL timestamps (sender's lsl::local_clock() domain),
+ *                   dejittered in place before publishing (see below).
+ *
+ *  TIMESTAMP DEJITTERING:
+ *    Raw LSL timestamps carry driver, network and poll-interval jitter
+ *    (up to the 20 ms CPU-optimized poll). m_dejitter fits the sample
+ *    index to time by RLS against the stream's nominal_srate (see
+ *    eegtimestampdejitter.h) and pullAvailable() overwrites each chunk's
+ *    timestamps with the fit. It runs once here, on the acquisition
+ *    thread, so the sync buffer, recording and display all get the same
+ *    regular timestamps. Irregular streams (nominal_srate 0) pass through.
  *
  *  LIFECYCLE:
  *    1. AmplifierManager creates LSLStreamReader, moves it to QThread.
  *    2. startLslReading signal → onStartReading() slot resolves stream.
- *    3. readLoop() runs until m_isRunning is set to false.
- *    4. stopLslReading signal → onStopReading() sets m_isRunning = false.
- *    5. AmplifierManager quits the thread and destroys the reader.
+ *    3. readLoop() runs until m_stopRequested is set.
+ *    4. AmplifierManager calls requestStop() directly from the main
+ *       thread. A queued stop slot would never run: the worker thread's
+ *       event loop is blocked inside onStartReading() for the whole
+ *       session.
+ *    5. readLoop() returns at its next wait boundary and onStartReading()
+ *       closes the inlet on the worker thread, then returns to the event
+ *       loop.
+ *    6. AmplifierManager quits the thread, waits for it and destroys the
+ *       reader. A stopped reader ignores further start requests;
+ *       startStream() creates a new one.
+ *
+ *  ACQUISITION MODES:
+ *    LatencyOptimized (default) — the loop blocks inside LSL's
+ *      pull_sample(timeout) and wakes as soon as a sample is queued by
+ *      the inlet, then drains everything else that is already available
+ *      with non-blocking pulls. Samples reach consumers within the
+ *      network/driver latency instead of waiting out a poll interval.
+ *      The wait timeout (LATENCY_WAIT_TIMEOUT_S) does not add latency
+ *      to data: it only ends an idle wait. Chunks are smaller and more
+ *      frequent (the outlet's push size).
+ *
+ *    CpuOptimized — the original fixed-interval poll: pull_chunk() is
+ *      non-blocking, followed by a 20 ms sleep (~50 Hz poll rate). Fewer
+ *      wake-ups and larger chunks, at the cost of up to 20 ms added
+ *      latency and bursty delivery (~40 samples per chunk at 2 kHz).
+ *
+ *    The mode can be switched at runtime from any thread; the loop picks
+ *    up the new value on its next iteration.
  *
- *  WHY 20ms SLEEP:
- *    pull_chunk() is non-blocking when no data is available. Without a
- *    sleep, the loop would spin at 100% CPU. 20ms gives ~50 Hz poll rate
- *    which is well above the typical EEG packet rate (~4 Hz at 256 Hz
- *    sampling with default LSL chunk sizes).
+ *    requestStop() is seen once the current wait, pull or sleep returns:
+ *    after at most LATENCY_WAIT_TIMEOUT_S while idle in LatencyOptimized,
+ *    CPU_POLL_INTERVAL_MS in CpuOptimized, and RESOLVE_SLICE_S while the
+ *    stream is still being resolved. Publishing a chunk is never
+ *    interrupted.
+ *
+ *    bench/lslacquisition_bench.cpp runs this reader against a local
+ *    outlet and checks that LatencyOptimized delivers with a lower
+ *    median latency than CpuOptimized and how long an idle stop takes.
  *
  * ==========================================================================
  */
@@ -65,26 +111,48 @@
 #include <lsl_cpp.h>
 #include <vector>
 #include <atomic>
+#include "eegchunk.h"
+#include "eegchunkpool.h"
+#include "eegtimestampdejitter.h"
+
+class EegChunkDispatcher;
 
 class LSLStreamReader : public QObject
 {
     Q_OBJECT
 
 public:
+    /* Controls how readLoop() waits for new data. See header docs. */
+    enum class AcquisitionMode
+    {
+        LatencyOptimized,   // Block in LSL until data arrives
+        CpuOptimized        // Fixed 20 ms poll interval
+    };
+    Q_ENUM(AcquisitionMode)
+
     explicit LSLStreamReader(QObject* parent = nullptr);
 
-    /* Destructor calls onStopReading() to ensure clean shutdown
-     * of the LSL inlet even if the caller forgets to stop explicitly. */
+    /* Destructor calls requestStop() and closeInlet() to ensure clean
+     * shutdown of the LSL inlet even if the caller forgets to stop
+     * explicitly. Only valid once the worker thread has finished. */
     ~LSLStreamReader();
 
-signals:
-    /* Emitted on every successful pull_chunk with non-empty data.
-     * This is the primary data signal — the heart of the entire EEG pipeline.
-     * chunk:      [sample][channel] raw EEG in μV
-     * timestamps: [sample] LSL timestamps in seconds */
-    void dataReceived(const std::vector<std::vector<float>>& chunk,
-                      const std::vector<double>& timestamps);
+    /* Thread-safe: asks readLoop() (or a stream resolution still in
+     * progress) to return so onStartReading() can close the inlet on the
+     * worker thread. Does not block; the caller then quits and waits for
+     * the thread. The request is permanent for this reader. */
+    void requestStop();
+
+    /* Thread-safe: may be called from the main thread while readLoop()
+     * is running on the worker thread. */
+    AcquisitionMode acquisitionMode() const { return m_acquisitionMode.load(); }
+    void setAcquisitionMode(AcquisitionMode mode);
+
+    /* Target for every pulled chunk. Must be set before onStartReading()
+     * and outlive the reader (AmplifierManager owns both). */
+    void setDispatcher(EegChunkDispatcher* dispatcher) { m_dispatcher = dispatcher; }
 
+signals:
     /* Emitted when the LSL inlet is created (non-null) or destroyed (nullptr).
      * EegSyncManager uses the inlet pointer to call time_correction()
      * for compensating clock drift between the amplifier and local machine. */
@@ -109,29 +177,83 @@ signals:
 
 public slots:
     /* Slot triggered by AmplifierManager::startLslReading signal.
-     * Resolves the LSL stream on the network, opens an inlet, and enters
-     * the blocking readLoop(). This entire method runs on the worker thread. */
+     * Resolves the LSL stream on the network, opens an inlet, runs the
+     * blocking readLoop() until requestStop(), then closes the inlet.
+     * This entire method runs on the worker thread. */
     void onStartReading();
 
-    /* Slot triggered by AmplifierManager::stopLslReading signal.
-     * Sets m_isRunning = false to break the readLoop(), then tears down
-     * the inlet. Thread-safe: m_isRunning is std::atomic<bool>. */
-    void onStopReading();
-
 private:
     /* Blocking acquisition loop — runs on the worker thread until
-     * m_isRunning is cleared by onStopReading(). Continuously calls
-     * pull_chunk() with a 20ms sleep between iterations. */
+     * requestStop() sets m_stopRequested. Waits for data according
+     * to m_acquisitionMode (see header docs). */
     void readLoop();
 
-    /* Atomic flag for cross-thread stop signaling. Set to true in
-     * onStartReading(), cleared by onStopReading(). The readLoop()
-     * checks this on every iteration. */
-    std::atomic<bool> m_isRunning{false};
+    /* Emits inletReady(nullptr), deletes the inlet and emits
+     * streamDisconnected(). No-op without an inlet. Called on the worker
+     * thread after readLoop() returns, so no pull is using the inlet. */
+    void closeInlet();
+
+    /* LatencyOptimized wait: blocks up to LATENCY_WAIT_TIMEOUT_S for the
+     * first sample, then collects every sample already queued in the inlet.
+     * Returns nullptr if the timeout expired without data. */
+    EegChunkPtr waitForChunk();
+
+    /* Moves everything currently queued in the inlet (up to MAX_CHUNK_SAMPLES)
+     * into a recycled chunk from m_chunkPool with a single
+     * pull_chunk_multiplexed() call. If firstTimestamp > 0, m_firstRow
+     * already holds one sample that was pulled by the blocking wait and
+     * becomes row 0. Timestamps are dejittered before returning.
+     * Returns nullptr if empty. */
+    EegChunkPtr pullAvailable(double firstTimestamp = 0.0);
+
+    /* Hands a chunk to every subscriber of m_dispatcher. Runs on the
+     * worker thread; no main-thread relay is involved. */
+    void publish(const EegChunkPtr& chunk);
+
+    /* Atomic flag for cross-thread stop signaling. Set by requestStop()
+     * from any thread and never cleared. The resolve loop and readLoop()
+     * check it between waits, so a stop is seen after at most one
+     * RESOLVE_SLICE_S, LATENCY_WAIT_TIMEOUT_S or CPU_POLL_INTERVAL_MS. */
+    std::atomic<bool> m_stopRequested{false};
 
     /* Raw LSL inlet pointer — created in onStartReading(), destroyed
-     * in onStopReading(). Null when no stream is active. */
+     * in closeInlet(). Null when no stream is active. */
     lsl::stream_inlet* m_inlet = nullptr;
+
+    /* Fan-out for acquired chunks — owned by AmplifierManager. */
+    EegChunkDispatcher* m_dispatcher = nullptr;
+
+    /* Channel count of the resolved stream — row width of every chunk. */
+    int m_channelCount = 0;
+
+    /* Landing buffer for the blocking single-sample wait. Sized once per
+     * stream so the wait itself never allocates. */
+    std::vector<float> m_firstRow;
+
+    /* Source of every published chunk. Buffers return to it when the last
+     * consumer drops its handle, so steady-state pulls do not allocate. */
+    EegChunkPool m_chunkPool;
+
+    /* Acquisition-time timestamp fit (see TIMESTAMP DEJITTERING). Reset
+     * per stream; only touched on the worker thread. */
+    EegTimestampDejitter m_dejitter;
+
+    std::atomic<AcquisitionMode> m_acquisitionMode{AcquisitionMode::LatencyOptimized};
+
+    /* Upper bound on how long the latency-optimized wait blocks before
+     * re-checking m_stopRequested when no data arrives. Does not delay
+     * data delivery. */
+    static constexpr double LATENCY_WAIT_TIMEOUT_S = 0.1;
+    static constexpr int CPU_POLL_INTERVAL_MS = 20;
+
+    /* Stream resolution budget, spent in slices so requestStop() is seen
+     * during a resolution that finds nothing. */
+    static constexpr double RESOLVE_TIMEOUT_S = 5.0;
+    static constexpr double RESOLVE_SLICE_S = 0.5;
+
+    /* Caps a single chunk so a long stall does not produce one huge
+     * allocation; the remainder is picked up by the next pull. */
+    static constexpr size_t MAX_CHUNK_SAMPLES = 4096;
 };
 
 #endif // LSLSTREAMREADER_H
@@ -11,6 +11,7 @@
 #include "recordingworker.h"
 #include "cameramanager.h"
 #include "eegsyncmanager.h"
+#include "amplifiermanager.h"
 
 #include <QDir>
 #include <QDirIterator>
@@ -62,12 +63,18 @@ RecordingManager::RecordingManager(QObject* parent)
     // See MEMORY.md: "Qt::QueuedConnection signals with complex types are
     // silently dropped unless registered with qRegisterMetaType<T>()."
     qRegisterMetaType<RecordingSummary>("RecordingSummary");
-    qRegisterMetaType<QVector<QVector<float>>>("QVector<QVector<float>>");
-    qRegisterMetaType<QVector<double>>("QVector<double>");
-    qRegisterMetaType<QVector<float>>("QVector<float>");
+    qRegisterMetaType<QVector<int>>("QVector<int>");
+    qRegisterMetaType<EegFileFormat>("EegFileFormat");
     qRegisterMetaType<QJsonObject>("QJsonObject");
 
-    // Flush timer - forces EEG batch write every 5 seconds
+    // EEG recording tap — runs on the LSL acquisition thread, so recording
+    // throughput does not depend on the main thread being responsive.
+    // The tap stays closed (no-op) until startRecording().
+    AmplifierManager::instance()->dispatcher()->subscribe(this, [this](const EegChunkPtr& chunk) {
+        onEegChunk(chunk);
+    }, Qt::DirectConnection);
+
+    // Flush timer - persists session state every 5 seconds
     m_flushTimer = new QTimer(this);
     m_flushTimer->setInterval(5000);
     connect(m_flushTimer, &QTimer::timeout, this, &RecordingManager::onFlushTimer);
@@ -87,6 +94,8 @@ RecordingManager::RecordingManager(QObject* parent)
 
 RecordingManager::~RecordingManager()
 {
+    AmplifierManager::instance()->dispatcher()->unsubscribe(this);
+
     if (m_isRecording)
         stopRecording();
     cleanupWorkerThread();
@@ -95,6 +104,7 @@ RecordingManager::~RecordingManager()
 bool RecordingManager::startRecording(const QString& saveFolderPath,
                                        const QString& sessionName,
                                        const QStringList& channelNames,
+                                       const QVariantList& channels,
                                        const QString& cameraId,
                                        double samplingRate)
 {
@@ -122,8 +132,16 @@ bool RecordingManager::startRecording(const QString& saveFolderPath,
     m_config.saveFolderPath = saveFolderPath;
     m_config.sessionName = sessionName;
     m_config.channelNames = channelNames;
+    m_config.channels.clear();
+    for (const QVariant& ch : channels)
+        m_config.channels.append(ch.toInt());
     m_config.cameraId = cameraId;
     m_config.samplingRate = samplingRate;
+    m_config.eegFormat = m_eegFormat;
+    m_config.durability = m_durability;
+    m_config.durabilityIntervalMs = m_durabilityIntervalMs;
+    m_config.durabilityBytes = m_durabilityBytes;
+    emit durabilityChanged(); // Loss window depends on the session's data rate
 
     // Reset state
     m_sessionStartLslTime = lsl::local_clock();
@@ -140,13 +158,29 @@ bool RecordingManager::startRecording(const QString& saveFolderPath,
     m_recordedFrames = 0;
     m_eegFileSize = 0;
     m_videoFileSize = 0;
-    m_eegBatch.clear();
-    m_timestampBatch.clear();
+    m_droppedEegChunks = 0;
+    m_droppedFrameRows = 0;
+    m_queueStats.reset();
 
-    // Create worker thread
+    // Create worker thread. The worker is the ring's only consumer; it is
+    // handed the ring before moveToThread so it never races the setter.
     cleanupWorkerThread();
+
+    // With the old worker gone and the tap closed, this thread is the only
+    // consumer: discard anything a previous session left behind so it
+    // cannot end up in this session's file (possibly with another width).
+    int staleChunks = 0;
+    for (EegChunkPtr stale; m_eegRing.tryPop(stale);)
+        ++staleChunks;
+    if (staleChunks > 0)
+        qWarning() << "[RecordingManager] Discarded" << staleChunks
+                   << "EEG chunks left over from the previous session";
     m_workerThread = new QThread(this);
     m_worker = new RecordingWorker();
+    m_worker->setEegRing(&m_eegRing);
+    m_worker->setQueueStats(&m_queueStats);
+    m_worker->setDurabilityPolicy(m_config.durability, m_config.durabilityIntervalMs,
+                                  m_config.durabilityBytes);
     m_worker->moveToThread(m_workerThread);
 
     // Connect worker response signals
@@ -162,8 +196,6 @@ bool RecordingManager::startRecording(const QString& saveFolderPath,
     // Connect command signals to worker slots (type-safe, no invokeMethod)
     connect(this, &RecordingManager::requestInitFiles,
             m_worker, &RecordingWorker::initializeFiles, Qt::QueuedConnection);
-    connect(this, &RecordingManager::requestWriteEegBatch,
-            m_worker, &RecordingWorker::writeEegBatch, Qt::QueuedConnection);
     connect(this, &RecordingManager::requestWritePauseMarker,
             m_worker, &RecordingWorker::writePauseMarker, Qt::QueuedConnection);
     connect(this, &RecordingManager::requestWriteMarker,
@@ -190,9 +222,15 @@ bool RecordingManager::startRecording(const QString& saveFolderPath,
                           m_config.framesFilePath(),
                           m_config.metadataFilePath(),
                           channelNames,
+                          m_config.channels,
+                          m_config.eegFormat,
                           sessionName,
                           samplingRate);
 
+    // Open the tap only after the init command is queued: chunks pushed
+    // from here on wait in the ring until the worker starts draining.
+    setEegTapEnabled(true);
+
     // Start video recording if camera is selected
     if (!cameraId.isEmpty()) {
         auto* cam = CameraManager::instance();
@@ -242,11 +280,13 @@ void RecordingManager::pauseRecording()
     m_isPaused = true;
     m_pauseStartLslTime = lsl::local_clock();
 
-    // Flush any pending EEG data before pause
-    flushEegBatch();
+    // Stop feeding the ring. The worker drains everything already queued
+    // before it writes the marker, so no pre-pause sample is lost.
+    setEegTapEnabled(false);
 
     // Write pause marker
     double sessTime = sessionTimeSec(m_pauseStartLslTime);
+    notePostedCommand();
     emit requestWritePauseMarker("PAUSE_START", m_pauseStartLslTime, sessTime);
 
     // Stop video recording
@@ -265,9 +305,13 @@ void RecordingManager::resumeRecording()
     m_totalPausedDuration += (resumeTime - m_pauseStartLslTime);
     m_isPaused = false;
 
-    // Write resume marker
+    // Write resume marker. The tap may reopen before the worker gets to
+    // it: the worker holds the ring from PAUSE_START until the PAUSE_STOP
+    // row is written, so post-resume samples still land after it.
     double sessTime = sessionTimeSec(resumeTime);
+    notePostedCommand();
     emit requestWritePauseMarker("PAUSE_STOP", resumeTime, sessTime);
+    setEegTapEnabled(true);
 
     // Start new video segment
     if (!m_config.cameraId.isEmpty()) {
@@ -290,8 +334,17 @@ void RecordingManager::stopRecording()
         m_isPaused = false;
     }
 
-    // Flush remaining EEG data
-    flushEegBatch();
+    // Close the tap; closeFiles() drains the remaining ring contents
+    setEegTapEnabled(false);
+    if (m_droppedEegChunks > 0) {
+        qWarning() << "[RecordingManager]" << m_droppedEegChunks.load()
+                   << "EEG chunks dropped (recording ring full)";
+    }
+    if (m_droppedFrameRows > 0) {
+        qWarning() << "[RecordingManager]" << m_droppedFrameRows
+                   << "frame index rows dropped (worker backlog)";
+    }
+    qDebug() << "[RecordingManager] Longest EEG write:" << maxWriteLatencyMs() << "ms";
 
     // Stop video
     stopVideoRecording();
@@ -327,11 +380,15 @@ void RecordingManager::stopRecording()
     emit isRecordingChanged();
     emit isPausedChanged();
 
-    // Reset disk space warning
+    // Reset disk space and backlog warnings
     if (m_diskSpaceWarning) {
         m_diskSpaceWarning = false;
         emit diskSpaceWarningChanged();
     }
+    if (m_writeBacklogWarning) {
+        m_writeBacklogWarning = false;
+        emit writeBacklogWarningChanged();
+    }
 
     // Notify EegSyncManager that the session has ended. Logs per-session
     // diagnostic summary (total queries, out-of-range ratio) and resets counters.
@@ -345,40 +402,42 @@ void RecordingManager::stopRecording()
     qDebug() << "[RecordingManager] Recording stopped. Duration:" << duration << "s";
 }
 
-void RecordingManager::writeEegData(const std::vector<std::vector<float>>& chunk,
-                                     const std::vector<double>& timestamps,
-                                     const QVector<int>& channelIndices)
+void RecordingManager::onEegChunk(const EegChunkPtr& chunk)
 {
-    static int callCount = 0;
-    if (++callCount <= 5) {
-        qDebug() << "[RecordingManager] writeEegData call#" << callCount
-                 << "isRecording:" << m_isRecording
-                 << "this:" << this << "s_instance:" << s_instance
-                 << "chunk:" << chunk.size() << "chIdx:" << channelIndices.size();
-    }
-
-    if (!m_isRecording || m_isPaused)
-        return;
-
-    // Extract selected channels and add to batch
-    for (size_t i = 0; i < chunk.size(); ++i) {
-        QVector<float> selectedChannels;
-        selectedChannels.reserve(channelIndices.size());
-
-        for (int chIdx : channelIndices) {
-            if (chIdx < static_cast<int>(chunk[i].size()))
-                selectedChannels.append(chunk[i][chIdx]);
-            else
-                selectedChannels.append(0.0f);
+    // Runs on the LSL acquisition thread. The in-flight counter is raised
+    // before the gate is checked so setEegTapEnabled(false) can wait for
+    // this push to land before the worker's final drain. Store-then-load
+    // on both sides (Dekker): only seq_cst keeps either side from reading
+    // a stale value, acquire/release does not order a store before a load.
+    m_eegTapInFlight.fetch_add(1, std::memory_order_seq_cst);
+
+    if (m_eegTapEnabled.load(std::memory_order_seq_cst)) {
+        // Counted before the push so the worker can never drain bytes
+        // that are not yet queued (keeps bytesPending non-negative).
+        const qint64 bytes = qint64(chunk->byteSize());
+        m_queueStats.eegBytesQueued.fetch_add(bytes, std::memory_order_release);
+        if (!m_eegRing.tryPush(chunk)) {
+            m_queueStats.eegBytesQueued.fetch_sub(bytes, std::memory_order_release);
+            // Worker has stalled long enough to fill the ring. Dropping keeps
+            // acquisition (and the display/sync consumers) running.
+            if (m_droppedEegChunks.fetch_add(1, std::memory_order_relaxed) == 0)
+                qWarning() << "[RecordingManager] Recording ring full — dropping EEG chunks";
         }
-
-        m_eegBatch.append(selectedChannels);
-        m_timestampBatch.append(timestamps[i]);
     }
 
-    // Flush when batch is full
-    if (m_eegBatch.size() >= EEG_BATCH_SIZE) {
-        flushEegBatch();
+    m_eegTapInFlight.fetch_sub(1, std::memory_order_release);
+}
+
+void RecordingManager::setEegTapEnabled(bool enabled)
+{
+    // seq_cst, paired with onEegChunk(): see the comment there.
+    m_eegTapEnabled.store(enabled, std::memory_order_seq_cst);
+
+    if (!enabled) {
+        // A push that passed the gate just before the store takes a few
+        // hundred nanoseconds to finish; wait it out so the ring is final.
+        while (m_eegTapInFlight.load(std::memory_order_seq_cst) != 0)
+            QThread::yieldCurrentThread();
     }
 }
 
@@ -389,9 +448,66 @@ void RecordingManager::writeMarker(const QString& type, const QString& label,
         return;
 
     double sessTime = sessionTimeSec(lslTimestamp);
+    notePostedCommand(); // Never dropped: markers are clinical annotations
     emit requestWriteMarker(type, label, lslTimestamp, sessTime);
 }
 
+void RecordingManager::setEegFormat(int format)
+{
+    // The format is fixed for the lifetime of a session's EEG file.
+    if (m_isRecording || format == int(m_eegFormat)
+        || format < int(EegFileFormat::Csv) || format > int(EegFileFormat::Compressed))
+        return;
+
+    m_eegFormat = EegFileFormat(format);
+    emit eegFormatChanged();
+    emit durabilityChanged(); // The data rate, and so the Size window, changed
+}
+
+void RecordingManager::setDurabilityPolicy(int policy)
+{
+    // Applied when the next session's worker is created.
+    if (m_isRecording || policy == int(m_durability))
+        return;
+    if (policy < int(DurabilityPolicy::EveryBatch) || policy > int(DurabilityPolicy::Size)) {
+        qWarning() << "[RecordingManager] Unknown durability policy:" << policy;
+        return;
+    }
+
+    m_durability = DurabilityPolicy(policy);
+    emit durabilityChanged();
+}
+
+void RecordingManager::setDurabilityIntervalMs(int intervalMs)
+{
+    if (m_isRecording || intervalMs <= 0 || intervalMs == m_durabilityIntervalMs)
+        return;
+
+    m_durabilityIntervalMs = intervalMs;
+    emit durabilityChanged();
+}
+
+void RecordingManager::setDurabilityBytes(qint64 bytes)
+{
+    if (m_isRecording || bytes <= 0 || bytes == m_durabilityBytes)
+        return;
+
+    m_durabilityBytes = bytes;
+    emit durabilityChanged();
+}
+
+double RecordingManager::maxDataLossWindowSec() const
+{
+    // Data rate of the current (or last) session; unknown before the first.
+    const int channelCount = m_config.channels.isEmpty() ? m_config.channelNames.size()
+                                                         : m_config.channels.size();
+    const double bytesPerSec = RecordingWorker::eegBytesPerSec(m_eegFormat, channelCount,
+                                                               m_config.samplingRate);
+    const double windowMs = RecordingWorker::maxDataLossWindowMs(
+        m_durability, m_durabilityIntervalMs, m_durabilityBytes, bytesPerSec);
+    return windowMs < 0.0 ? -1.0 : windowMs / 1000.0;
+}
+
 double RecordingManager::recordedDurationSec() const
 {
     if (!m_isRecording)
@@ -468,21 +584,28 @@ void RecordingManager::onFrameReady(double lslTimestamp)
     if (!m_isRecording || m_isPaused || !m_worker)
         return;
 
+    // Numbering follows the video even when a row has to be dropped.
     m_recordedFrames++;
+
+    // Bound the worker's event queue: a stalled disk would otherwise let
+    // 30 posted events per second pile up for as long as the stall lasts.
+    if (m_queueStats.commandsPending.load(std::memory_order_relaxed) >= MAX_PENDING_COMMANDS) {
+        if (m_droppedFrameRows++ == 0)
+            qWarning() << "[RecordingManager] Worker backlog full — dropping frame index rows";
+        return;
+    }
+
     QString segmentFile = QFileInfo(m_config.videoSegmentFilePath(m_videoSegmentCount)).fileName();
 
+    notePostedCommand();
     emit requestWriteFrameTimestamp(lslTimestamp, m_recordedFrames, segmentFile);
 }
 
 void RecordingManager::onFlushTimer()
 {
-    if (!m_eegBatch.isEmpty()) {
-        flushEegBatch();
-    }
-
-    // Piggy-back session state persistence on the 5-second flush timer.
-    // This ensures the state file is always within 5 seconds of the actual
-    // recording progress. On crash, at most 5 seconds of state is lost.
+    // EEG data is drained by the worker on its own timer; this timer only
+    // keeps the crash-recovery state file current, always within 5 seconds
+    // of the actual recording progress. On crash, at most 5 seconds of state is lost.
     if (m_isRecording) {
         persistSessionState();
     }
@@ -532,9 +655,32 @@ void RecordingManager::onStatsTimer()
         m_videoFileSize = totalVideoSize;
     }
 
+    checkWriteBacklog();
     emit statsUpdated();
 }
 
+void RecordingManager::checkWriteBacklog()
+{
+    const double ringFill = double(m_eegRing.size()) / double(m_eegRing.capacity());
+    const int commands = m_queueStats.commandsPending.load(std::memory_order_relaxed);
+
+    if (!m_writeBacklogWarning) {
+        if (ringFill < EEG_RING_HIGH_WATER && commands < COMMAND_HIGH_WATER)
+            return;
+        m_writeBacklogWarning = true;
+        qWarning() << "[RecordingManager] Write backlog high — ring" << qRound(ringFill * 100)
+                   << "% full," << commands << "commands queued," << bytesPending()
+                   << "bytes pending, longest write" << maxWriteLatencyMs() << "ms";
+        emit writeBacklogHigh(bytesPending());
+        emit writeBacklogWarningChanged();
+    } else if (ringFill < EEG_RING_LOW_WATER && commands < COMMAND_HIGH_WATER / 2) {
+        // Hysteresis: a disk hovering at the threshold does not flap the banner.
+        m_writeBacklogWarning = false;
+        qDebug() << "[RecordingManager] Write backlog cleared";
+        emit writeBacklogWarningChanged();
+    }
+}
+
 void RecordingManager::onCameraCapturingChanged()
 {
     auto* cam = CameraManager::instance();
@@ -549,31 +695,6 @@ void RecordingManager::onCameraCapturingChanged()
 
 // --- Private methods ---
 
-void RecordingManager::flushEegBatch()
-{
-    if (m_eegBatch.isEmpty() || !m_worker)
-        return;
-
-    // Lambda capture approach instead of emit requestWriteEegBatch():
-    // QVector<QVector<float>> is a nested template type. Even after
-    // qRegisterMetaType<QVector<QVector<float>>>(), Qt's queued signal
-    // delivery can silently drop the payload if the argument type is not
-    // recognized correctly by the meta-object system.
-    // Capturing the data by value in a lambda and using invokeMethod with
-    // Qt::QueuedConnection sidesteps the metatype machinery entirely —
-    // the lambda owns the data and delivers it directly to the worker slot.
-    QVector<QVector<float>> batchCopy      = m_eegBatch;
-    QVector<double>         timestampsCopy = m_timestampBatch;
-    RecordingWorker*        worker         = m_worker;
-
-    QMetaObject::invokeMethod(worker, [worker, batchCopy, timestampsCopy]() {
-        worker->writeEegBatch(batchCopy, timestampsCopy);
-    }, Qt::QueuedConnection);
-
-    m_eegBatch.clear();
-    m_timestampBatch.clear();
-}
-
 void RecordingManager::startVideoRecording()
 {
     auto* cameraMgr = CameraManager::instance();
@@ -659,6 +780,8 @@ QJsonObject RecordingManager::buildSessionStateJson() const
     state["amplifierId"] = m_config.amplifierId;
     state["cameraId"] = m_config.cameraId;
     state["samplingRate"] = m_config.samplingRate;
+    state["eegFormat"] = eegFileFormatName(m_config.eegFormat);
+    state["durabilityPolicy"] = int(m_config.durability);
 
     QJsonArray chNames;
     for (const auto& name : m_config.channelNames)
@@ -690,9 +813,15 @@ void RecordingManager::persistSessionState()
         return;
 
     QJsonObject state = buildSessionStateJson();
+    notePostedCommand();
     emit requestWriteSessionState(state, m_config.sessionStateFilePath());
 }
 
+void RecordingManager::notePostedCommand()
+{
+    m_queueStats.commandsPending.fetch_add(1, std::memory_order_relaxed);
+}
+
 // ==========================================================================
 //  Crash Detection — called from QML at startup
 // ==========================================================================
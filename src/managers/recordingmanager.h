@@ -11,24 +11,24 @@
  *
  *  DESIGN PATTERNS:
  *    Singleton (QML_SINGLETON) — session state must be globally accessible
- *    from EegBackend (data writer), QML toolbar (controls), and VideoBackend.
+ *    from the QML toolbar (controls), VideoBackend, and the EEG tap.
  *    Command pattern — "request" signals carry typed data to the worker thread
  *    without using QMetaObject::invokeMethod strings (type-safe cross-thread).
  *
  *  THREADING MODEL:
  *
- *    Main Thread                       Worker Thread
- *    ──────────────                    ──────────────
- *    EegBackend::onDataReceived()
- *      → writeEegData()
- *          accumulates m_eegBatch
- *          (EEG_BATCH_SIZE = 100)
- *          → flushEegBatch()
- *              QMetaObject::invokeMethod(worker,
- *                  writeEegBatch, QueuedConnection)
- *                                          → RecordingWorker::writeEegBatch()
- *                                              → m_eegStream << rows
- *                                              → fsync
+ *    LSL Acquisition Thread            Worker Thread
+ *    ──────────────────────            ──────────────
+ *    EegChunkDispatcher (direct)
+ *      → onEegChunk(chunk)
+ *          m_eegRing.tryPush(chunk)  ──▸  m_eegRing (lock-free SPSC)
+ *                                          → RecordingWorker::drainEegRing()
+ *                                              every EEG_DRAIN_INTERVAL_MS
+ *                                              → one write() per drain
+ *                                              → fdatasync per DurabilityPolicy
+ *
+ *    Main Thread
+ *    ──────────────
  *
  *    CameraManager::frameTimestampUpdated()
  *      → onFrameReady(lslTimestamp)
@@ -36,8 +36,8 @@
  *                                          → RecordingWorker::writeFrameTimestamp()
  *
  *    QML: stopRecording()
- *      → flushEegBatch() + stopVideoRecording()
- *          emit requestCloseFiles()
+ *      → setEegTapEnabled(false) + stopVideoRecording()
+ *          emit requestCloseFiles()          (worker drains the ring first)
  *                                          → RecordingWorker::closeFiles()
  *                                              emit filesClosed(summary)
  *      ← onFilesClosed(summary)
@@ -45,23 +45,48 @@
  *
  *  PAUSE/RESUME & VIDEO SEGMENTATION:
  *    On pauseRecording():
- *      1. Flush current EEG batch to disk (no data loss at boundary).
+ *      1. Close the EEG tap; the worker drains the ring before the marker
+ *         (no data loss at boundary).
  *      2. Write PAUSE_START marker to both EEG and markers CSVs.
  *      3. Stop QMediaRecorder → closes current MKV segment.
  *    On resumeRecording():
  *      1. Accumulate paused wall-clock time in m_totalPausedDuration.
- *      2. Write PAUSE_STOP marker.
+ *      2. Post the PAUSE_STOP marker, then reopen the EEG tap. The worker
+ *         holds the ring from PAUSE_START until that row is written, so
+ *         post-resume samples follow it even if they are queued first.
  *      3. Increment m_videoSegmentCount → new MKV filename (_seg002.mkv).
  *      4. Start new QMediaRecorder instance on the same capture session.
  *    sessionTimeSec() subtracts m_totalPausedDuration from elapsed LSL time,
  *    yielding continuous session-relative timestamps in the markers CSV.
  *
- *  EEG BATCHING:
- *    writeEegData() is called ~50 times/sec from EegBackend. Accumulating
- *    100 samples before flushing reduces syscalls from 50/sec to ~2-3/sec.
- *    flushEegBatch() uses QMetaObject::invokeMethod with a lambda capture
- *    rather than the requestWriteEegBatch signal, which avoids QueuedConnection
- *    silent-drop issues with nested QVector<QVector<float>> metatypes.
+ *  EEG RECORDING TAP:
+ *    EEG data never passes through the main thread. RecordingManager
+ *    subscribes to AmplifierManager's EegChunkDispatcher with a direct
+ *    connection, so onEegChunk() runs on the LSL acquisition thread and
+ *    pushes the shared chunk handle into m_eegRing. RecordingWorker drains
+ *    the ring on a timer in its own thread and writes every queued chunk
+ *    with one write(); disk syncs follow the session's durability policy.
+ *    A stalled QML scene (resize, re-layout) therefore cannot delay disk
+ *    writes.
+ *
+ *    The tap is gated by m_eegTapEnabled (open while recording and not
+ *    paused). setEegTapEnabled(false) waits for any in-flight push to
+ *    finish, so once it returns no further chunk can enter the ring and a
+ *    subsequent drain (pause marker, close) sees everything.
+ *
+ *    If the ring is full (worker stalled for several seconds) the chunk
+ *    is dropped and counted rather than blocking acquisition.
+ *
+ *  WRITE BACKLOG (back-pressure):
+ *    Every path into the worker is bounded: EEG by the ring capacity,
+ *    frame rows by MAX_PENDING_COMMANDS queued commands (excess rows are
+ *    dropped and counted; the MKV itself is unaffected). m_queueStats
+ *    tracks ring bytes not yet written, queued commands and the longest
+ *    drain write. The stats timer raises writeBacklogWarning (and emits
+ *    writeBacklogHigh) once the ring is EEG_RING_HIGH_WATER full or
+ *    COMMAND_HIGH_WATER commands are queued, and clears it with
+ *    hysteresis — so a failing disk is visible seconds before any data
+ *    is dropped.
  *
  *  PENDING VIDEO START:
  *    startRecording() may be called before CameraManager::startCapture().
@@ -71,7 +96,7 @@
  *    where RecordingManager is started from QML before the camera is live.
  *
  *  DATA FLOW SUMMARY:
- *    AmplifierManager → EegBackend → writeEegData() → batch → worker CSV
+ *    LSLStreamReader → dispatcher → onEegChunk() → SPSC ring → worker CSV
  *    CameraManager::frameTimestampUpdated() → onFrameReady() → worker CSV
  *    CameraManager::captureSession() → QMediaRecorder → MKV file
  *    Worker::filesClosed() → recordingStopped() → QML summary dialog
@@ -92,11 +117,16 @@
 #include <QMediaRecorder>
 #include <QMediaCaptureSession>
 #include <QJsonObject>
+#include <QVariantList>
+#include <atomic>
 #include <vector>
 #include <lsl_cpp.h>
 
 #include "sessionconfig.h"
 #include "recordingsummary.h"
+#include "recordingqueuestats.h"
+#include "eegchunk.h"
+#include "spscring.h"
 
 class RecordingWorker;
 
@@ -116,6 +146,26 @@ class RecordingManager : public QObject
     Q_PROPERTY(qint64 diskSpaceMB READ diskSpaceMB NOTIFY statsUpdated FINAL)
     Q_PROPERTY(bool diskSpaceWarning READ diskSpaceWarning NOTIFY diskSpaceWarningChanged FINAL)
     Q_PROPERTY(double estimatedRemainingHours READ estimatedRemainingHours NOTIFY statsUpdated FINAL)
+    /* Write back-pressure telemetry (see WRITE BACKLOG in the header docs). */
+    Q_PROPERTY(int eegQueueDepth READ eegQueueDepth NOTIFY statsUpdated FINAL)
+    Q_PROPERTY(int pendingWriteCommands READ pendingWriteCommands NOTIFY statsUpdated FINAL)
+    Q_PROPERTY(qint64 bytesPending READ bytesPending NOTIFY statsUpdated FINAL)
+    Q_PROPERTY(double maxWriteLatencyMs READ maxWriteLatencyMs NOTIFY statsUpdated FINAL)
+    Q_PROPERTY(qint64 droppedEegChunks READ droppedEegChunks NOTIFY statsUpdated FINAL)
+    Q_PROPERTY(qint64 droppedFrameRows READ droppedFrameRows NOTIFY statsUpdated FINAL)
+    Q_PROPERTY(bool writeBacklogWarning READ writeBacklogWarning NOTIFY writeBacklogWarningChanged FINAL)
+    /* EEG file format for the next session (EegFileFormat as int:
+     * 0 = CSV, 1 = RawFloat32, 2 = Compressed; see sessionconfig.h).
+     * Ignored while a session is running. */
+    Q_PROPERTY(int eegFormat READ eegFormat WRITE setEegFormat NOTIFY eegFormatChanged FINAL)
+    /* Disk-sync policy for the next session (DurabilityPolicy as int:
+     * 0 = every batch, 1 = interval, 2 = size). Ignored while recording. */
+    Q_PROPERTY(int durabilityPolicy READ durabilityPolicy WRITE setDurabilityPolicy NOTIFY durabilityChanged FINAL)
+    Q_PROPERTY(int durabilityIntervalMs READ durabilityIntervalMs WRITE setDurabilityIntervalMs NOTIFY durabilityChanged FINAL)
+    Q_PROPERTY(qint64 durabilityBytes READ durabilityBytes WRITE setDurabilityBytes NOTIFY durabilityChanged FINAL)
+    /* Worst-case seconds of EEG a power cut could lose under the current
+     * policy; -1 if unknown (Size policy before the data rate is known). */
+    Q_PROPERTY(double maxDataLossWindowSec READ maxDataLossWindowSec NOTIFY durabilityChanged FINAL)
 
 public:
     static RecordingManager* instance();
@@ -129,42 +179,32 @@ public:
     // -----------------------------------------------------------------------
 
     /* Validates the save path, checks disk space, starts the worker thread,
-     * initializes CSV files, and optionally starts video recording.
+     * initializes CSV files, opens the EEG tap, and optionally starts video
+     * recording. channels holds the hardware channel indices to record
+     * (matching channelNames); empty records every channel.
      * Returns false (and emits recordingError) if preconditions are not met.
      * The worker thread is recreated fresh for each session. */
     Q_INVOKABLE bool startRecording(const QString& saveFolderPath,
                                     const QString& sessionName,
                                     const QStringList& channelNames,
+                                    const QVariantList& channels,
                                     const QString& cameraId,
                                     double samplingRate);
 
-    /* Flushes current EEG batch, writes PAUSE_START markers, stops video.
-     * EEG data received while paused is silently discarded (isPaused guard
-     * in writeEegData). */
+    /* Closes the EEG tap, writes PAUSE_START markers, stops video.
+     * EEG data acquired while paused never enters the ring. */
     Q_INVOKABLE void pauseRecording();
 
     /* Resumes after pause: accumulates paused duration, writes PAUSE_STOP,
      * starts a new video segment (m_videoSegmentCount++). */
     Q_INVOKABLE void resumeRecording();
 
-    /* Flushes remaining EEG data, stops video, disconnects camera signals,
+    /* Closes the EEG tap, stops video, disconnects camera signals,
      * sums MKV segment sizes, and delegates file closure to the worker.
      * The recordingStopped() signal fires asynchronously after the worker
      * emits filesClosed() (which may be seconds later on slow media). */
     Q_INVOKABLE void stopRecording();
 
-    // -----------------------------------------------------------------------
-    // Data input — called from EegBackend on the main thread (hot path)
-    // -----------------------------------------------------------------------
-
-    /* Accumulates incoming EEG chunk into m_eegBatch. Flushes the batch
-     * to the worker thread when EEG_BATCH_SIZE (100 samples) is reached.
-     * No-op when not recording or paused — guard is a branch on m_isRecording
-     * and m_isPaused which is very cheap. */
-    void writeEegData(const std::vector<std::vector<float>>& chunk,
-                      const std::vector<double>& timestamps,
-                      const QVector<int>& channelIndices);
-
     /* Immediately routes a single event marker to the worker (no batching).
      * Markers are time-critical and low-frequency so immediate dispatch is safe. */
     void writeMarker(const QString& type, const QString& label, double lslTimestamp);
@@ -183,6 +223,25 @@ public:
     Q_INVOKABLE bool checkDiskSpace(const QString& path, qint64 requiredMB = 500);
 
     bool diskSpaceWarning() const { return m_diskSpaceWarning; }
+
+    int eegQueueDepth() const { return int(m_eegRing.size()); }
+    int pendingWriteCommands() const { return m_queueStats.commandsPending.load(); }
+    qint64 bytesPending() const { return m_queueStats.eegBytesPending(); }
+    double maxWriteLatencyMs() const { return m_queueStats.maxWriteLatencyUs.load() / 1000.0; }
+    qint64 droppedEegChunks() const { return m_droppedEegChunks.load(); }
+    qint64 droppedFrameRows() const { return m_droppedFrameRows; }
+    bool writeBacklogWarning() const { return m_writeBacklogWarning; }
+
+    int eegFormat() const { return int(m_eegFormat); }
+    void setEegFormat(int format);
+
+    int durabilityPolicy() const { return int(m_durability); }
+    void setDurabilityPolicy(int policy);
+    int durabilityIntervalMs() const { return m_durabilityIntervalMs; }
+    void setDurabilityIntervalMs(int intervalMs);
+    qint64 durabilityBytes() const { return m_durabilityBytes; }
+    void setDurabilityBytes(qint64 bytes);
+    double maxDataLossWindowSec() const;
     double estimatedRemainingHours() const;
 
     // -----------------------------------------------------------------
@@ -199,6 +258,9 @@ signals:
     void isPausedChanged();
     void statsUpdated();
     void diskSpaceWarningChanged();
+    void writeBacklogWarningChanged();
+    void eegFormatChanged();
+    void durabilityChanged();
     void recordingStarted(const QString& sessionName);
     void recordingStopped(const QString& sessionName,
                          const QString& savePath,
@@ -213,22 +275,24 @@ signals:
      * but has not yet hit the critical threshold (1 GB). QML shows
      * an amber banner. Carries remaining MB for display. */
     void diskSpaceLow(qint64 remainingMB);
+    /* Emitted when the worker falls behind past the high-water mark (EEG
+     * ring half full or too many queued commands). Carries the EEG bytes
+     * not yet written. QML shows a red banner while writeBacklogWarning. */
+    void writeBacklogHigh(qint64 bytesPending);
 
     // -----------------------------------------------------------------------
     // Command signals — used as a type-safe cross-thread RPC mechanism.
     // These signals are connected to the worker's public slots with
     // Qt::QueuedConnection. Emitting them from the main thread posts a
     // message to the worker thread's event queue without blocking.
-    // NOTE: The EEG batch flush uses QMetaObject::invokeMethod instead
-    // (see flushEegBatch()) to avoid metatype registration complexity
-    // with nested QVector<QVector<float>>.
+    // NOTE: EEG samples do not use a command signal — they reach the worker
+    // through m_eegRing (see EEG RECORDING TAP in the header docs).
     // -----------------------------------------------------------------------
     void requestInitFiles(const QString& eegPath, const QString& markersPath,
                           const QString& framesPath, const QString& metadataPath,
-                          const QStringList& channelNames, const QString& sessionName,
+                          const QStringList& channelNames, const QVector<int>& channelIndices,
+                          EegFileFormat eegFormat, const QString& sessionName,
                           double samplingRate);
-    void requestWriteEegBatch(const QVector<QVector<float>>& samples,
-                              const QVector<double>& timestamps);
     void requestWritePauseMarker(const QString& type, double lslTimestamp, double sessionTimeSec);
     void requestWriteMarker(const QString& type, const QString& label,
                             double lslTimestamp, double sessionTimeSec);
@@ -252,12 +316,27 @@ private slots:
     void onCameraCapturingChanged();
 
 private:
-    void flushEegBatch();
+    /* Dispatcher consumer — runs on the LSL acquisition thread. Pushes the
+     * chunk into m_eegRing when the tap is open; never blocks. */
+    void onEegChunk(const EegChunkPtr& chunk);
+
+    /* Opens/closes the acquisition-thread tap. Closing waits until no
+     * onEegChunk() call is mid-push, so the ring is final afterwards. */
+    void setEegTapEnabled(bool enabled);
+
     void startVideoRecording();
     void stopVideoRecording();
     double sessionTimeSec(double lslTimestamp) const;
     void cleanupWorkerThread();
     void persistSessionState();
+
+    /* Counts a command signal about to be posted to the worker; the worker
+     * uncounts it when the slot runs. */
+    void notePostedCommand();
+
+    /* High-water / low-water evaluation for writeBacklogWarning. Called
+     * from the stats timer. */
+    void checkWriteBacklog();
     QJsonObject buildSessionStateJson() const;
 
     static RecordingManager* s_instance;
@@ -271,6 +350,10 @@ private:
 
     // Session config
     SessionConfig m_config;
+    EegFileFormat m_eegFormat = EegFileFormat::Csv; // Applied to m_config at start
+    DurabilityPolicy m_durability = SessionConfig().durability;          // Ditto
+    int    m_durabilityIntervalMs = SessionConfig().durabilityIntervalMs;
+    qint64 m_durabilityBytes      = SessionConfig().durabilityBytes;
     bool m_isRecording = false;
     bool m_isPaused = false;
 
@@ -281,10 +364,26 @@ private:
     int    m_videoSegmentCount    = 1;   // Increments on each resumeRecording()
     bool   m_pendingVideoStart    = false; // True if waiting for camera to start
 
-    // EEG batching — accumulate samples to reduce disk I/O frequency
-    QVector<QVector<float>> m_eegBatch;
-    QVector<double>         m_timestampBatch;
-    static constexpr int EEG_BATCH_SIZE = 100; // ~0.4 s at 256 Hz
+    // EEG recording tap — acquisition thread → ring → RecordingWorker.
+    // Capacity is in chunks: in latency-optimized acquisition a chunk can be
+    // a single sample, so 8192 still covers ~4 s at 2 kHz of worker stall.
+    static constexpr size_t EEG_RING_CAPACITY = 8192;
+    SpscRing<EegChunkPtr> m_eegRing{EEG_RING_CAPACITY};
+    std::atomic<bool>   m_eegTapEnabled{false};
+    std::atomic<int>    m_eegTapInFlight{0};     // onEegChunk() calls past the gate
+    std::atomic<qint64> m_droppedEegChunks{0};   // Rejected by a full ring
+
+    // Write back-pressure — shared with the worker (see recordingqueuestats.h).
+    // Frame rows are the only unbounded command stream (30/s); past
+    // MAX_PENDING_COMMANDS they are dropped and counted instead of letting
+    // the worker's event queue grow without limit. Markers are never dropped.
+    RecordingQueueStats m_queueStats;
+    qint64 m_droppedFrameRows = 0;
+    bool   m_writeBacklogWarning = false;
+    static constexpr int MAX_PENDING_COMMANDS = 4096;     // ~2 min of frames at 30 fps
+    static constexpr int COMMAND_HIGH_WATER   = 1024;     // ~30 s of frames
+    static constexpr double EEG_RING_HIGH_WATER = 0.50;   // Fraction of ring capacity
+    static constexpr double EEG_RING_LOW_WATER  = 0.25;   // Warning clears below this
 
     // Live statistics — updated by worker callbacks and stats timer
     qint64 m_recordedSamples = 0;
@@ -293,7 +392,7 @@ private:
     qint64 m_videoFileSize   = 0;
 
     // Periodic maintenance timers
-    QTimer* m_flushTimer     = nullptr; // Forces EEG batch flush every 5 s
+    QTimer* m_flushTimer     = nullptr; // Persists session state every 5 s
     QTimer* m_diskCheckTimer = nullptr; // Checks free disk space every 60 s
     QTimer* m_statsTimer     = nullptr; // Refreshes UI statistics every 1 s
 
@@ -0,0 +1,80 @@
+/*
+ * ==========================================================================
+ *  eegchunk.h — Contiguous, Ref-Counted EEG Sample Chunk
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    The unit of data that flows through the entire EEG pipeline. One
+ *    EegChunk holds every sample pulled from the LSL inlet in a single
+ *    acquisition step, for all hardware channels, plus one LSL timestamp
+ *    per sample.
+ *
+ *  MEMORY LAYOUT (interleaved / multiplexed, as LSL delivers it):
+ *
+ *    samples:    [s0c0 s0c1 ... s0cN | s1c0 s1c1 ... s1cN | ...]
+ *    timestamps: [t0                  | t1                  | ...]
+ *
+ *    value(sample, channel) = samples[sample * channelCount + channel]
+ *
+ *    This is exactly the buffer format of lsl::stream_inlet::
+ *    pull_chunk_multiplexed(), so LSLStreamReader fills the vectors in
+ *    place with no per-sample allocation and no intermediate copy. The
+ *    previous std::vector<std::vector<float>> layout cost one heap
+ *    allocation per sample row.
+ *
+ *  OWNERSHIP:
+ *    Chunks are immutable once published and travel as EegChunkPtr
+ *    (std::shared_ptr<const EegChunk>). Queued signal delivery and fan-out
+ *    to several consumers only copy the pointer; the sample data itself is
+ *    written once by the reader and never copied between pipeline stages.
+ *    When the last consumer drops its reference the chunk returns to the
+ *    reader's EegChunkPool and its buffers are reused for a later pull.
+ *
+ *  DATA FLOW:
+ *    LSLStreamReader (pull_chunk_multiplexed into EegChunk)
+ *      → EegChunkDispatcher::publish()
+ *          ├─ EegSyncManager::addEegSamples(const EegChunk&)   [direct]
+ *          ├─ RecordingManager tap → SPSC ring → RecordingWorker [direct]
+ *          └─ EegBackend                                       [queued]
+ *               └─ EegDisplayScaler::transformChunk(const EegChunk&)
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGCHUNK_H
+#define EEGCHUNK_H
+
+#include <QMetaType>
+#include <memory>
+#include <vector>
+
+struct EegChunk
+{
+    int channelCount = 0;           // Hardware channels per sample row
+    int sampleCount  = 0;           // Number of sample rows in this chunk
+    std::vector<float>  samples;    // [sample * channelCount + channel], μV
+    std::vector<double> timestamps; // [sample], LSL time base (seconds)
+
+    bool isEmpty() const { return sampleCount == 0 || channelCount == 0; }
+
+    /* Payload size in memory (samples + timestamps), for queue accounting. */
+    size_t byteSize() const {
+        return samples.size() * sizeof(float) + timestamps.size() * sizeof(double);
+    }
+
+    /* Pointer to the first channel of a sample row. */
+    const float* row(int sample) const {
+        return samples.data() + static_cast<size_t>(sample) * channelCount;
+    }
+
+    float value(int sample, int channel) const {
+        return samples[static_cast<size_t>(sample) * channelCount + channel];
+    }
+};
+
+/* Immutable shared handle — the only form in which chunks cross threads. */
+using EegChunkPtr = std::shared_ptr<const EegChunk>;
+
+Q_DECLARE_METATYPE(EegChunkPtr)
+
+#endif // EEGCHUNK_H
@@ -10,13 +10,11 @@
 #include "eegdatamodel.h"
 #include <QtCore/qnumeric.h>
 #include <algorithm>
+#include <cmath>
 
 EegDataModel::EegDataModel()
 {
     qInfo() << "EEGDATAMODEL CREATED " << this;
-    /* Start the elapsed timer immediately so that the first emitDataChanged()
-     * call has a valid reference point for rate-limiting. */
-    m_updateTimer.start();
 }
 
 // ============================================================================
@@ -28,7 +26,7 @@ int EegDataModel::rowCount(const QModelIndex &parent) const
     /* Returns 0 before first data arrival (buffer not yet allocated),
      * then returns the fixed buffer size for the remainder of the session. */
     Q_UNUSED(parent);
-    if (!m_bufferInitialized || m_data.empty())
+    if (!m_bufferInitialized || m_numChannels == 0)
     {
         return 0;
     }
@@ -40,13 +38,18 @@ int EegDataModel::columnCount(const QModelIndex &parent) const
     /* Column count = 1 (X-axis time column) + N (one per EEG channel).
      * Returns 0 before the buffer is initialized. */
     Q_UNUSED(parent);
-    return m_data.size();
+    if (!m_bufferInitialized || m_numChannels == 0)
+    {
+        return 0;
+    }
+    return m_numChannels + 1;
 }
 
 QVariant EegDataModel::data(const QModelIndex &index, int role) const
 {
-    /* Called by QML's LineSeries/XYSeries to fetch individual data points.
-     * Only Qt::DisplayRole is supported — returns the raw double value.
+    /* Generic item-model access (debugging, table views). The live display
+     * (EegTraceView) reads channelSamples() instead of going through here.
+     * Only Qt::DisplayRole is supported — returns the value as a double.
      * Returns an invalid QVariant for out-of-bounds or non-display requests. */
     if (!index.isValid()) return QVariant();
 
@@ -55,10 +58,18 @@ QVariant EegDataModel::data(const QModelIndex &index, int role) const
         int col = index.column();
         int row = index.row();
 
-        if (col < m_data.size() && row < m_data[col].size())
+        if (row < 0 || row >= rowCount() || col < 0 || col >= columnCount())
+        {
+            return QVariant();
+        }
+
+        /* X is a pure function of the row — the same value the write loop
+         * used to store for every sample. */
+        if (col == 0)
         {
-            return m_data[col][row];
+            return static_cast<double>(row) / m_samplingRate;
         }
+        return static_cast<double>(channelData(col - 1)[row]);
     }
     return QVariant();
 }
@@ -69,39 +80,26 @@ QVariant EegDataModel::data(const QModelIndex &index, int role) const
 
 void EegDataModel::initializeBuffer(int numChannels)
 {
-    if (m_bufferInitialized && m_numChannels == numChannels && !m_data.empty() && m_data[0].size() == m_maxSamples)
+    const size_t bufferSize = static_cast<size_t>(numChannels) * static_cast<size_t>(m_maxSamples);
+    if (m_bufferInitialized && m_numChannels == numChannels && m_samples.size() == bufferSize)
     {
         return;
     }
 
     beginResetModel();
 
-    /* Allocate columns: [0]=X-axis + [1..N]=channels.
-     * All vectors are pre-sized to m_maxSamples for zero-reallocation writes. */
-    m_data.clear();
-    m_data.resize(numChannels + 1);
-
-    for (int col = 0; col <= numChannels; ++col)
-    {
-        m_data[col].resize(m_maxSamples);
-    }
-
-    /* Initialize X-axis with time values; fill channel columns with GAP_VALUE
-     * so the initial waveform appears blank (no spurious lines). */
-    for (int i = 0; i < m_maxSamples; ++i)
-    {
-        m_data[0][i] = static_cast<double>(i) / m_samplingRate;
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            m_data[ch + 1][i] = GAP_VALUE;
-        }
-    }
+    /* One allocation for all channels, pre-sized for zero-reallocation
+     * writes. Filled with GAP_VALUE so the initial waveform appears blank
+     * (no spurious lines). The X column needs no storage. */
+    m_samples.assign(bufferSize, GAP_VALUE);
+    m_numChannels = numChannels;
+    initializeLod();
 
     m_currentIndex = 0;
     m_writePosition = 0;
-    m_numChannels = numChannels;
     m_bufferInitialized = true;
     m_minMaxDirty = true;
+    m_pendingUpdate = false;    // The reset itself tells views to re-read everything
 
     endResetModel();
 
@@ -110,77 +108,202 @@ void EegDataModel::initializeBuffer(int numChannels)
             << m_timeWindowSeconds << "seconds window";
 }
 
+void EegDataModel::initializeLod()
+{
+    m_lod.clear();
+    for (int bucketRows = LOD_BASE_ROWS; ; bucketRows *= 2)
+    {
+        const int bucketCount = (m_maxSamples + bucketRows - 1) / bucketRows;
+        if (bucketCount < LOD_MIN_BUCKETS)
+        {
+            break;
+        }
+
+        LodLevel level;
+        level.bucketRows = bucketRows;
+        level.bucketCount = bucketCount;
+        level.min.assign(static_cast<size_t>(m_numChannels) * bucketCount, GAP_VALUE);
+        level.max.assign(static_cast<size_t>(m_numChannels) * bucketCount, GAP_VALUE);
+        m_lod.push_back(std::move(level));
+    }
+}
+
 // ============================================================================
-// Rate-Limited UI Notification
+// Min/Max LOD Pyramid
 // ============================================================================
 
-void EegDataModel::emitDataChanged(int startRow, int endRow)
+void EegDataModel::updateLod(int firstRow, int lastRow)
 {
-    /*
-     * At 256 Hz with 20ms LSL poll intervals, updateAllData() is called ~50
-     * times per second with ~5 samples each. Without rate limiting, this would
-     * trigger 50 dataChanged signals per second. The QML renderer cannot keep
-     * up, causing frame drops and input lag.
-     *
-     * Solution: accumulate changed-row ranges and flush at most once per 16ms.
-     * Pending ranges are merged (union of min/max) so no changes are lost.
-     */
-    qint64 elapsed = m_updateTimer.elapsed();
-
-    if (elapsed < MIN_UPDATE_INTERVAL_MS)
+    /* std::fmin/fmax return the non-NaN operand, so gap rows drop out of
+     * the envelope and a bucket made only of gap rows stays NaN. */
+    for (size_t l = 0; l < m_lod.size(); ++l)
     {
-        if (m_pendingUpdate)
+        LodLevel& level = m_lod[l];
+        const int firstBucket = firstRow / level.bucketRows;
+        const int lastBucket = lastRow / level.bucketRows;
+
+        for (int ch = 0; ch < m_numChannels; ++ch)
         {
-            m_pendingStartRow = std::min(m_pendingStartRow, startRow);
-            m_pendingEndRow = std::max(m_pendingEndRow, endRow);
+            float* outMin = level.min.data() + size_t(ch) * level.bucketCount;
+            float* outMax = level.max.data() + size_t(ch) * level.bucketCount;
+
+            if (l == 0)
+            {
+                /* Finest level: rescan the raw rows of each touched bucket. */
+                const float* rows = channelData(ch);
+                for (int k = firstBucket; k <= lastBucket; ++k)
+                {
+                    const int begin = k * level.bucketRows;
+                    const int end = std::min(begin + level.bucketRows, m_maxSamples);
+                    float lo = GAP_VALUE;
+                    float hi = GAP_VALUE;
+                    for (int r = begin; r < end; ++r)
+                    {
+                        lo = std::fmin(lo, rows[r]);
+                        hi = std::fmax(hi, rows[r]);
+                    }
+                    outMin[k] = lo;
+                    outMax[k] = hi;
+                }
+            }
+            else
+            {
+                /* Coarser levels: fold the two child buckets of the level
+                 * below (the last bucket may have only one child). */
+                const LodLevel& below = m_lod[l - 1];
+                const float* inMin = below.min.data() + size_t(ch) * below.bucketCount;
+                const float* inMax = below.max.data() + size_t(ch) * below.bucketCount;
+                for (int k = firstBucket; k <= lastBucket; ++k)
+                {
+                    const int a = 2 * k;
+                    const int b = std::min(a + 1, below.bucketCount - 1);
+                    outMin[k] = std::fmin(inMin[a], inMin[b]);
+                    outMax[k] = std::fmax(inMax[a], inMax[b]);
+                }
+            }
         }
-        else
+    }
+}
+
+int EegDataModel::lodLevelForWidth(double pixelColumns) const
+{
+    /* Up to ~2 raw points per pixel column the plain trace is cheap enough
+     * and shows the true waveform shape; beyond that, take the finest
+     * envelope with at most one bucket (one vertical min/max bar) per column. */
+    if (m_lod.empty() || pixelColumns <= 0 || m_maxSamples <= 2.0 * pixelColumns)
+    {
+        return -1;
+    }
+
+    for (size_t l = 0; l < m_lod.size(); ++l)
+    {
+        if (m_lod[l].bucketCount <= pixelColumns)
         {
-            m_pendingUpdate = true;
-            m_pendingStartRow = startRow;
-            m_pendingEndRow = endRow;
+            return static_cast<int>(l);
         }
-        return;
     }
+    return static_cast<int>(m_lod.size()) - 1;
+}
 
+// ============================================================================
+// Frame-Clocked UI Notification
+// ============================================================================
+
+void EegDataModel::markPending(qint64 begin, qint64 end)
+{
+    /*
+     * Chunks arrive far more often than frames at low latency (every LSL
+     * push), so writes only extend the dirty arc here. Views are told once
+     * per frame by flushPendingChanges(), driven by the window's frame clock,
+     * so nothing is flushed early (mid-frame) or late (stale tail after the
+     * stream stops).
+     */
     if (m_pendingUpdate)
     {
-        startRow = std::min(m_pendingStartRow, startRow);
-        endRow = std::max(m_pendingEndRow, endRow);
-        m_pendingUpdate = false;
+        m_pendingBegin = std::min(m_pendingBegin, begin);
+        m_pendingEnd = std::max(m_pendingEnd, end);
+        return;
+    }
+
+    m_pendingUpdate = true;
+    m_pendingBegin = begin;
+    m_pendingEnd = end;
+    emit changesPending();
+}
+
+void EegDataModel::flushPendingChanges()
+{
+    if (!m_pendingUpdate)
+    {
+        return;
+    }
+    m_pendingUpdate = false;
+
+    /* The Y range follows the same cadence as the repaint: at most one
+     * minMaxChanged per flush, however many chunks arrived in between. */
+    if (m_minMaxDirty)
+    {
+        refreshMinMax();
     }
 
-    QModelIndex topLeft = index(startRow, 0);
-    QModelIndex bottomRight = index(endRow, m_data.size() - 1);
-    emit QAbstractItemModel::dataChanged(topLeft, bottomRight);
+    /* Writes advance sequentially around the ring, so everything touched
+     * since the last flush is one circular arc — at most two row ranges
+     * once it crosses the end of the buffer, never a whole-buffer fallback
+     * unless a full window's worth really was written. */
+    const int length = static_cast<int>(std::min<qint64>(m_pendingEnd - m_pendingBegin, m_maxSamples));
+    const int first = static_cast<int>(m_pendingBegin % m_maxSamples);
+    const int lastColumn = columnCount() - 1;
 
-    m_updateTimer.restart();
+    if (length <= 0)
+    {
+        return;
+    }
+    if (first + length <= m_maxSamples)
+    {
+        emit dataChanged(index(first, 0), index(first + length - 1, lastColumn));
+    }
+    else
+    {
+        emit dataChanged(index(first, 0), index(m_maxSamples - 1, lastColumn));
+        emit dataChanged(index(0, 0), index(first + length - 1 - m_maxSamples, lastColumn));
+    }
 }
 
 // ============================================================================
 // Min/Max Tracking
 // ============================================================================
 
-void EegDataModel::updateMinMaxCache(double value)
+void EegDataModel::refreshMinMax()
 {
-    /* Skip GAP_VALUE sentinels (NaN) — they would corrupt the Y-axis range.
-     * NaN comparisons always return false, so we must use qIsNaN() explicitly. */
-    if (qIsNaN(value)) return;
+    /*
+     * The range of what is on screen right now, not of everything ever seen:
+     * the ring is exactly the visible window, so once an electrode-pop
+     * transient is overwritten by the sweep the range shrinks back.
+     *
+     * The coarsest pyramid level already summarizes the whole ring in
+     * 64–127 buckets per channel, so this is a fold over a few thousand
+     * floats, not over every sample. Gap buckets are NaN and drop out
+     * through std::fmin/fmax. Buffers too short for a pyramid (< 256 rows)
+     * are scanned directly.
+     */
+    m_minMaxDirty = false;
 
-    bool changed = false;
-    if (value < m_cachedMin)
-    {
-        m_cachedMin = value;
-        changed = true;
-    }
-    if (value > m_cachedMax)
-    {
-        m_cachedMax = value;
-        changed = true;
-    }
+    const std::vector<float>& mins = m_lod.empty() ? m_samples : m_lod.back().min;
+    const std::vector<float>& maxs = m_lod.empty() ? m_samples : m_lod.back().max;
+    float lo = GAP_VALUE;
+    float hi = GAP_VALUE;
+    for (float v : mins) lo = std::fmin(lo, v);
+    for (float v : maxs) hi = std::fmax(hi, v);
+
+    /* All-gap buffer (fresh or just reset) maps back to the "no data" state
+     * that minValue()/maxValue() report defaults for. */
+    const double newMin = qIsNaN(lo) ? std::numeric_limits<double>::infinity() : lo;
+    const double newMax = qIsNaN(hi) ? -std::numeric_limits<double>::infinity() : hi;
 
-    if (changed)
+    if (newMin != m_cachedMin || newMax != m_cachedMax)
     {
+        m_cachedMin = newMin;
+        m_cachedMax = newMax;
         emit minMaxChanged();
     }
 }
@@ -196,8 +319,31 @@ void EegDataModel::updateAllData(const QVector<QVector<double>>& incomingData)
         return;
     }
 
-    int newSamples = incomingData[0].size();
-    int numChannels = incomingData.size();
+    /* Convert-and-copy into the runs handed out by writeSamples(). A
+     * channel shorter than the first keeps its previous values for the
+     * missing rows, as before. */
+    writeSamples(incomingData.size(), incomingData[0].size(),
+                 [&incomingData](float* const* dest, int firstSample, int count) {
+        for (int ch = 0; ch < incomingData.size(); ++ch)
+        {
+            const QVector<double>& source = incomingData[ch];
+            const int available = std::clamp(static_cast<int>(source.size()) - firstSample, 0, count);
+            const double* in = source.constData() + firstSample;
+            float* out = dest[ch];
+            for (int i = 0; i < available; ++i)
+            {
+                out[i] = static_cast<float>(in[i]);
+            }
+        }
+    });
+}
+
+void EegDataModel::writeSamples(int numChannels, int newSamples, const SampleWriter& writer)
+{
+    if (numChannels <= 0 || newSamples <= 0)
+    {
+        return;
+    }
 
     if (!m_bufferInitialized || m_numChannels != numChannels)
     {
@@ -206,22 +352,28 @@ void EegDataModel::updateAllData(const QVector<QVector<double>>& incomingData)
 
     int startWriteIndex = m_currentIndex % m_maxSamples;
 
-    /* Write incoming samples into the circular buffer.
-     * m_currentIndex is a monotonic counter; modulo gives the buffer position. */
-    for (int s = 0; s < newSamples; ++s)
+    /* Hand the writer the destination rows in place, all channels at once.
+     * m_currentIndex is a monotonic counter; modulo gives the buffer position.
+     * Each channel's ring is contiguous, so a chunk lands as straight runs
+     * split only at the wrap — one writer call per run, usually one.
+     * The value range is not tracked here; see refreshMinMax(). */
+    m_writeDest.resize(numChannels);
+    int s = 0;
+    int pos = startWriteIndex;
+    while (s < newSamples)
     {
-        int writeIndex = m_currentIndex % m_maxSamples;
-
-        m_data[0][writeIndex] = static_cast<double>(writeIndex) / m_samplingRate;
+        const int run = std::min(newSamples - s, m_maxSamples - pos);
         for (int ch = 0; ch < numChannels; ++ch)
         {
-            double value = incomingData[ch][s];
-            m_data[ch + 1][writeIndex] = value;
-            updateMinMaxCache(value);
+            m_writeDest[ch] = channelData(ch) + pos;
         }
-
-        m_currentIndex++;
+        writer(m_writeDest.data(), s, run);
+        s += run;
+        pos = (pos + run) % m_maxSamples;
     }
+    m_minMaxDirty = true;
+
+    m_currentIndex += newSamples;
 
     int endWriteIndex = (m_currentIndex - 1 + m_maxSamples) % m_maxSamples;
 
@@ -231,31 +383,36 @@ void EegDataModel::updateAllData(const QVector<QVector<double>>& incomingData)
     /* Write GAP_VALUE ahead of the cursor to create the visual line break.
      * This is what gives the EEG display its characteristic "sweeping" appearance
      * where the cursor erases old data as it moves forward. */
-    for (int g = 1; g <= GAP_SIZE; ++g)
+    const int gapStart = (endWriteIndex + 1) % m_maxSamples;
+    const int gapLength = std::min(GAP_SIZE, m_maxSamples);
+    const int gapFirstRun = std::min(gapLength, m_maxSamples - gapStart);
+    for (int ch = 0; ch < m_numChannels; ++ch)
     {
-        int gapIndex = (endWriteIndex + g) % m_maxSamples;
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            m_data[ch + 1][gapIndex] = GAP_VALUE;
-        }
+        float* dest = channelData(ch);
+        std::fill_n(dest + gapStart, gapFirstRun, GAP_VALUE);
+        std::fill_n(dest, gapLength - gapFirstRun, GAP_VALUE);
     }
 
-    /* Determine the row range that changed for incremental notification.
-     * On wraparound (rare), fall back to full-buffer notification. */
-    int changedStart, changedEnd;
-
-    if (startWriteIndex <= endWriteIndex)
+    /* Refresh the envelope buckets under the chunk and the gap — one
+     * contiguous run of rows starting at startWriteIndex, split at the wrap. */
+    const int touchedRows = newSamples + gapLength;
+    if (touchedRows >= m_maxSamples)
     {
-        changedStart = startWriteIndex;
-        changedEnd = std::min(endWriteIndex + GAP_SIZE, m_maxSamples - 1);
+        updateLod(0, m_maxSamples - 1);
     }
     else
     {
-        changedStart = 0;
-        changedEnd = m_maxSamples - 1;
+        const int lastTouched = startWriteIndex + touchedRows - 1;
+        updateLod(startWriteIndex, std::min(lastTouched, m_maxSamples - 1));
+        if (lastTouched >= m_maxSamples)
+        {
+            updateLod(0, lastTouched - m_maxSamples);
+        }
     }
 
-    emitDataChanged(changedStart, changedEnd);
+    /* Rows [start of this chunk, end of the new gap) in write-counter
+     * units; views hear about them at the next frame flush. */
+    markPending(m_currentIndex - newSamples, m_currentIndex + gapLength);
 }
 
 // ============================================================================
@@ -265,9 +422,9 @@ void EegDataModel::updateAllData(const QVector<QVector<double>>& incomingData)
 double EegDataModel::minValue() const
 {
     /* Returns a safe default (0.0) before any real data has arrived.
-     * Once data starts flowing, returns the smallest Y pixel value seen.
-     * Note: this cache only grows (monotonic) — it never shrinks, which means
-     * the Y-axis range may become overly wide after large transients. */
+     * Once data starts flowing, returns the smallest Y pixel value currently
+     * in the window, as of the last dataChanged flush. It shrinks again when
+     * large transients scroll out of the window (see refreshMinMax()). */
     if (m_cachedMin == std::numeric_limits<double>::infinity())
     {
         return 0.0;
@@ -287,6 +444,11 @@ double EegDataModel::maxValue() const
     return m_cachedMax;
 }
 
+int EegDataModel::channelCount() const
+{
+    return m_bufferInitialized ? m_numChannels : 0;
+}
+
 int EegDataModel::writePosition() const
 {
     return m_writePosition;
@@ -4,7 +4,7 @@
  * ==========================================================================
  *
  *  PURPOSE:
- *    Provides the data backend for the EegGraph.qml waveform renderer.
+ *    Provides the data backend for the EegGraph.qml waveform display.
  *    Implements a fixed-size circular buffer that continuously receives
  *    scaled EEG samples and exposes them through Qt's QAbstractTableModel
  *    interface for efficient, incremental QML updates.
@@ -17,20 +17,20 @@
  *  CIRCULAR BUFFER ARCHITECTURE:
  *
  *    ┌──────────────────────────────────────────────────────────────┐
- *    │  Column 0: X-axis (time in seconds)                        │
+ *    │  Column 0: X-axis (time in seconds, computed in data())    │
  *    │  Column 1..N: Channel data (scaled pixel values)           │
  *    │                                                            │
  *    │  ┌─────────────────────────────────────────────────────┐   │
  *    │  │ ... old data ... │ GAP │ ← writePos → │ new data │   │
  *    │  └─────────────────────────────────────────────────────┘   │
  *    │                       ▲                                    │
- *    │              GAP_SIZE samples set to GAP_VALUE (1e9)       │
- *    │              so QML LineSeries breaks the line here        │
+ *    │              GAP_SIZE samples set to GAP_VALUE (NaN)       │
+ *    │              so the trace renderer breaks the line here    │
  *    └──────────────────────────────────────────────────────────────┘
  *
  *    The buffer wraps around: when m_currentIndex reaches m_maxSamples,
  *    it modulo-wraps to 0 and begins overwriting the oldest data.
- *    A "gap" of GAP_SIZE samples (set to GAP_VALUE = 1e9) is written
+ *    A "gap" of GAP_SIZE samples (set to GAP_VALUE = NaN) is written
  *    AHEAD of the write cursor to create a visible break in the waveform,
  *    giving the classic "scrolling EEG" appearance.
  *
@@ -41,24 +41,70 @@
  *    When either samplingRate or timeWindowSeconds changes, the buffer is
  *    reallocated via recalculateMaxSamples() → initializeBuffer().
  *
+ *  STORAGE LAYOUT:
+ *    One contiguous, channel-major float array:
+ *
+ *      m_samples[ch * m_maxSamples + row]
+ *
+ *    Each channel's ring is a single run of memory, so updateAllData()
+ *    writes a chunk as at most two straight copies per channel (before and
+ *    after the wrap) — loops the compiler vectorizes — instead of striding
+ *    across per-channel QVectors. Values are display pixels, for which
+ *    float32 is far more precision than a screen has. The X column is not
+ *    stored at all: it is always row / samplingRate, computed in data().
+ *    256 channels × 30 s × 2 kHz: 61 MB, versus 123 MB for the former
+ *    double columns plus a stored X column.
+ *
+ *  LOD PYRAMID (min/max envelope):
+ *    At 2 kHz × 30 s a channel holds 60 000 rows for a plot ~1500 px wide.
+ *    Drawing every row wastes 40 segments per pixel column; plain
+ *    decimation would drop spikes. Each channel therefore also keeps a
+ *    pyramid of min/max envelopes:
+ *
+ *      level 0:  bucket = LOD_BASE_ROWS (4) rows     min[k], max[k]
+ *      level 1:  bucket = 8 rows                     from level 0 pairs
+ *      level n:  bucket = 4 · 2ⁿ rows                from level n-1 pairs
+ *
+ *    Levels stop once a level would have fewer than LOD_MIN_BUCKETS
+ *    buckets. updateAllData() refreshes only the buckets covering the rows
+ *    it wrote (chunk + gap): level 0 rescans those rows, every higher level
+ *    folds two buckets of the level below, so the cost per chunk is
+ *    O(chunk + bucket size) per channel regardless of window length. NaN
+ *    rows are ignored (std::fmin/fmax); an all-gap bucket stays NaN.
+ *    Memory: one extra float per row per channel (2·rows·(1/4 + 1/8 + …)).
+ *
+ *    lodLevelForWidth() picks the finest level with no more buckets than
+ *    pixel columns, or -1 (raw rows) while the raw data already fits in
+ *    about two points per column. The choice follows both the plot width
+ *    and the buffer length (samplingRate × timeWindowSeconds).
+ *
  *  PERFORMANCE OPTIMIZATIONS:
  *    1. Incremental dataChanged signals — only the written row range is
  *       emitted, not a full model reset. This avoids re-rendering all
  *       2560+ data points on every 5-sample chunk arrival.
- *    2. Rate-limited UI updates — emitDataChanged() enforces a 16ms
- *       minimum interval (~60 FPS cap) to prevent overwhelming the QML
- *       rendering pipeline during high-frequency data arrival.
- *    3. Monotonic min/max cache — avoids full-buffer scans for Y-axis range.
+ *    2. Frame-clocked UI updates — writes only extend a pending dirty arc
+ *       (markPending). The view calls flushPendingChanges() from its
+ *       window's afterAnimating signal, so dataChanged is emitted exactly
+ *       once per rendered frame: one row range, or two when the arc
+ *       crosses the end of the ring. Nothing is left pending when the
+ *       stream stops, and a wrap no longer repaints the whole buffer.
+ *    3. Windowed min/max — the Y range covers only what is currently in the
+ *       ring and shrinks after transients scroll out. It is folded from the
+ *       coarsest LOD level (≤ 127 buckets per channel) once per UI flush,
+ *       never per sample, and notifies at most once per flush.
  *
  *  DATA FLOW (input):
  *    EegBackend::onDataReceived()
  *      → EegDisplayScaler::transformChunk()   [μV → pixels]
  *        → EegDataModel::updateAllData()      [writes to circular buffer]
- *          → emitDataChanged()                [notifies QML]
- *            → EegGraph.qml re-renders
+ *          → markPending()                    [extends the dirty arc]
+ *  QQuickWindow::afterAnimating (per frame)
+ *    → EegTraceView → flushPendingChanges()   [≤ 2 dataChanged ranges]
+ *      → EegTraceView refills the dirty tiles, reading
+ *        channelSamples() directly (no data() calls)
  *
  *  TABLE LAYOUT:
- *    Column 0:     X-axis — time in seconds (writeIndex / samplingRate)
+ *    Column 0:     X-axis — time in seconds (row / samplingRate, not stored)
  *    Column 1..N:  Y-axis — scaled pixel values per channel
  *    Rows:         One row per sample (0 to m_maxSamples-1)
  *
@@ -71,10 +117,10 @@
 #include <QAbstractTableModel>
 #include <QPointF>
 #include <QVector>
-#include <QTimer>
-#include <QElapsedTimer>
 #include <QtQmlIntegration>
+#include <functional>
 #include <limits>
+#include <vector>
 
 class EegDataModel : public QAbstractTableModel
 {
@@ -98,12 +144,12 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 
     /* Returns the number of data columns: 1 (X-axis) + N (channels).
-     * Maps directly to m_data.size(). */
+     * Returns 0 before the buffer is initialized. */
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
 
     /* Returns the double value at [row, column] for Qt::DisplayRole.
      * Row = sample index in the circular buffer.
-     * Column 0 = time in seconds, Column 1..N = scaled pixel Y values. */
+     * Column 0 = time in seconds (computed), Column 1..N = scaled pixel Y values. */
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
     // --- Data entry ---
@@ -111,10 +157,21 @@ public:
     /* Primary data entry point — called by EegBackend::onDataReceived().
      * Accepts pre-scaled data [channel][sample] from EegDisplayScaler.
      * Writes samples into the circular buffer at m_currentIndex (modulo),
-     * inserts the GAP ahead of the cursor, and notifies QML via
-     * rate-limited dataChanged signals. */
+     * inserts the GAP ahead of the cursor, and records the touched rows
+     * for the next flushPendingChanges(). */
     Q_INVOKABLE void updateAllData(const QVector<QVector<double>>& incomingData);
 
+    /* Fills dest[ch][0 .. count) with display values for input samples
+     * [firstSample, firstSample + count). dest[ch] points into the ring. */
+    using SampleWriter = std::function<void(float* const* dest, int firstSample, int count)>;
+
+    /* Zero-copy data entry — used by EegBackend with the scaler's SIMD
+     * kernel. Reserves newSamples rows at the cursor for numChannels
+     * channels and calls `writer` to fill them in place: once, or once per
+     * run when the rows wrap. Then writes the gap, updates the LOD pyramid
+     * and records the rows for the next flush, exactly like updateAllData(). */
+    void writeSamples(int numChannels, int newSamples, const SampleWriter& writer);
+
     // --- Buffer configuration ---
 
     /* Returns the number of EEG channels currently in the buffer. */
@@ -124,11 +181,11 @@ public:
      * if the count differs from the current configuration. */
     void setChannelCount(int newChannelCount);
 
-    /* Returns the minimum scaled Y value seen so far (for Y-axis auto-range).
+    /* Returns the minimum scaled Y value in the window (for Y-axis auto-range).
      * Returns 0.0 before any data has been received. */
     double minValue() const;
 
-    /* Returns the maximum scaled Y value seen so far.
+    /* Returns the maximum scaled Y value in the window.
      * Returns 1000.0 before any data has been received. */
     double maxValue() const;
 
@@ -156,11 +213,42 @@ public:
      * Equals samplingRate × timeWindowSeconds (e.g. 256 × 10 = 2560). */
     int maxSamples() const;
 
+    /* Read-only view of channel ch's ring: maxSamples() floats indexed by
+     * row, NaN in the gap and in rows not yet written. For renderers that
+     * draw straight from the buffer (EegTraceView) instead of going through
+     * data(); valid until the next buffer reinitialization (modelReset). */
+    const float* channelSamples(int ch) const { return channelData(ch); }
+
+    /* Emits dataChanged for every row written since the previous flush
+     * (one range, or two across the wrap) and refreshes the Y range.
+     * Called once per frame by the view that renders this model; a no-op
+     * when nothing changed. */
+    void flushPendingChanges();
+
+    // --- Min/max LOD pyramid (see LOD PYRAMID in the header docs) ---
+
+    /* Number of pyramid levels for the current buffer (0 before init). */
+    int lodLevelCount() const { return static_cast<int>(m_lod.size()); }
+
+    /* Rows summarized by one bucket of `level`, and buckets per channel. */
+    int lodBucketRows(int level) const { return m_lod[level].bucketRows; }
+    int lodBucketCount(int level) const { return m_lod[level].bucketCount; }
+
+    /* Per-channel envelope of `level`: lodBucketCount(level) floats each,
+     * NaN for buckets that contain only gap rows. Same lifetime rules as
+     * channelSamples(). */
+    const float* lodMin(int level, int ch) const { return m_lod[level].min.data() + size_t(ch) * m_lod[level].bucketCount; }
+    const float* lodMax(int level, int ch) const { return m_lod[level].max.data() + size_t(ch) * m_lod[level].bucketCount; }
+
+    /* Finest level whose bucket count fits in `pixelColumns`, or -1 when
+     * raw rows fit in about two points per column (draw channelSamples()). */
+    int lodLevelForWidth(double pixelColumns) const;
+
 signals:
     void channelCountChanged();
 
-    /* Emitted when the Y-axis range (minValue/maxValue) changes.
-     * QML can use this to auto-scale the chart axes. */
+    /* Emitted when the Y-axis range (minValue/maxValue) changes — at most
+     * once per dataChanged flush. QML can use this to auto-scale the axes. */
     void minMaxChanged();
 
     /* Emitted after each data write with the new cursor position.
@@ -170,36 +258,65 @@ signals:
     void samplingRateChanged();
     void timeWindowSecondsChanged();
 
+    /* Emitted on the first write after a flush — a hint for views to
+     * schedule a frame, whose frame callback then calls
+     * flushPendingChanges(). Not emitted again until that flush. */
+    void changesPending();
+
     /* Emitted when m_maxSamples changes (due to samplingRate or
      * timeWindowSeconds change). Triggers QML chart axis reconfiguration. */
     void maxSamplesChanged();
 
 private:
-    /* Allocates (or reallocates) the m_data buffer for the given number
+    /* Allocates (or reallocates) the m_samples buffer for the given number
      * of channels. Wraps the operation in beginResetModel/endResetModel
      * to notify QML views of the structural change. Only runs when the
      * channel count or buffer size actually changes (guard check inside). */
     void initializeBuffer(int numChannels);
 
-    /* Rate-limited dataChanged notification. Accumulates the union of all
-     * changed-row ranges within a 16ms window, then emits a single
-     * QAbstractItemModel::dataChanged covering the entire affected region.
-     * This limits QML re-renders to ~60 FPS regardless of data arrival rate. */
-    void emitDataChanged(int startRow, int endRow);
+    /* Extends the pending dirty arc by write-counter rows [begin, end)
+     * and emits changesPending() if it was empty. */
+    void markPending(qint64 begin, qint64 end);
+
+    /* Recomputes the min/max Y-value cache over the whole window from the
+     * coarsest LOD level, skipping GAP_VALUE rows. Called at most once per
+     * dataChanged flush; emits minMaxChanged() only when the range moved,
+     * in either direction. */
+    void refreshMinMax();
+
+    /* Allocates the LOD levels for the current m_maxSamples and channel
+     * count, all buckets NaN. Called from initializeBuffer(). */
+    void initializeLod();
 
-    /* Incrementally updates the min/max Y-value cache. Called for every
-     * sample written. Skips GAP_VALUE sentinels. Emits minMaxChanged()
-     * only when the range actually expands (monotonic — never shrinks). */
-    void updateMinMaxCache(double value);
+    /* Recomputes every pyramid bucket that covers rows [firstRow, lastRow]
+     * (no wrap; callers split wrapped ranges). */
+    void updateLod(int firstRow, int lastRow);
 
     /* Recomputes m_maxSamples from m_samplingRate × m_timeWindowSeconds.
      * If the result changes, triggers full buffer reinitialization.
      * Enforces a minimum of 100 samples to prevent degenerate buffers. */
     void recalculateMaxSamples();
 
-    /* m_data[0] = X-axis (time); m_data[1..N] = channel Y values.
-     * Each inner vector has exactly m_maxSamples elements. */
-    QVector<QVector<double>> m_data;
+    /* Start of channel ch's ring (m_maxSamples contiguous floats). */
+    float* channelData(int ch) { return m_samples.data() + size_t(ch) * size_t(m_maxSamples); }
+    const float* channelData(int ch) const { return m_samples.data() + size_t(ch) * size_t(m_maxSamples); }
+
+    /* Channel-major ring: m_numChannels × m_maxSamples display values.
+     * See STORAGE LAYOUT in the header docs. */
+    std::vector<float> m_samples;
+
+    /* One pyramid level: channel-major [ch * bucketCount + k] envelopes. */
+    struct LodLevel
+    {
+        int bucketRows = 0;
+        int bucketCount = 0;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+    std::vector<float*> m_writeDest;    // Per-channel run pointers for writeSamples()
+    std::vector<LodLevel> m_lod;        // Finest (LOD_BASE_ROWS) first
+    static constexpr int LOD_BASE_ROWS = 4;
+    static constexpr int LOD_MIN_BUCKETS = 64;
     double m_channelSpacing = 100.0;
     int m_currentIndex = 0;         // Monotonically increasing write counter
     int m_totalSamples = 0;
@@ -210,27 +327,24 @@ private:
     int m_maxSamples = 2560;        // = samplingRate × timeWindowSeconds
 
     /* GAP_SIZE samples ahead of the write cursor are set to GAP_VALUE.
-     * QML's LineSeries treats these extreme values as line breaks,
-     * producing the classic "sweeping cursor" EEG display effect. */
+     * EegTraceView draws no segment to or from these rows, producing the
+     * classic "sweeping cursor" EEG display effect. */
     static constexpr int GAP_SIZE = 50;
-    // NaN causes QtGraphs LineSeries to produce a true line-break (no segment
-    // is drawn to/from a NaN point).  The previous value of 1e9 was a finite
-    // number so QtGraphs still drew a near-vertical spike from the last real
-    // sample up to y=1e9 before clipping it — that was the visible spike bug.
-    static constexpr double GAP_VALUE = std::numeric_limits<double>::quiet_NaN();
+    // NaN rather than a large finite sentinel: a finite value (formerly 1e9)
+    // made the old QtGraphs LineSeries draw a near-vertical spike from the
+    // last real sample up to the sentinel before clipping it.
+    static constexpr float GAP_VALUE = std::numeric_limits<float>::quiet_NaN();
     static constexpr int DEFAULT_MAX_SAMPLES = 2560;
 
     double m_cachedMin = std::numeric_limits<double>::infinity();
     double m_cachedMax = -std::numeric_limits<double>::infinity();
     bool m_minMaxDirty = true;
 
-    /* Rate limiter: accumulates changed-row ranges between UI flushes.
-     * Ensures at most one dataChanged signal per 16ms (~60 FPS). */
-    QElapsedTimer m_updateTimer;
-    static constexpr int MIN_UPDATE_INTERVAL_MS = 16;
+    /* Dirty arc since the last flush: write-counter rows
+     * [m_pendingBegin, m_pendingEnd), taken modulo m_maxSamples. */
     bool m_pendingUpdate = false;
-    int m_pendingStartRow = 0;
-    int m_pendingEndRow = 0;
+    qint64 m_pendingBegin = 0;
+    qint64 m_pendingEnd = 0;
 
     bool m_bufferInitialized = false;
     int m_numChannels = 0;
@@ -0,0 +1,65 @@
+/*
+ * ==========================================================================
+ *  recordingqueuestats.h — Recording Back-Pressure Counters
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Live counters describing how far RecordingWorker lags behind the
+ *    data it is handed. Owned by RecordingManager, written by both sides
+ *    of the main/acquisition → worker boundary, read once per second by
+ *    RecordingManager's stats timer to publish telemetry and drive the
+ *    write-backlog high-water alert. A disk that stalls (network share,
+ *    slow USB drive) shows up here as growing bytesPending and write
+ *    latency long before any data is lost.
+ *
+ *  DESIGN PATTERN:
+ *    Shared counter block — plain atomics, no signals. The worker gets a
+ *    pointer before moveToThread() (like the EEG ring) and the manager
+ *    outlives it. Writers never wait on readers; values read together are
+ *    individually exact but not a consistent snapshot, which is fine for
+ *    telemetry.
+ *
+ *  COUNTERS:
+ *    eegBytesQueued / eegBytesDrained
+ *      In-memory size of EEG chunks pushed into / popped from the ring.
+ *      Their difference is the EEG data not yet handed to the file.
+ *    commandsPending
+ *      Frame, marker and session-state commands posted to the worker's
+ *      event queue but not yet executed. Bounded by RecordingManager.
+ *    maxWriteLatencyUs
+ *      Longest single drain write (+ checkpoint sync) this session.
+ *
+ * ==========================================================================
+ */
+
+#ifndef RECORDINGQUEUESTATS_H
+#define RECORDINGQUEUESTATS_H
+
+#include <QtGlobal>
+#include <atomic>
+
+struct RecordingQueueStats
+{
+    std::atomic<qint64> eegBytesQueued{0};    // Tap (acquisition thread)
+    std::atomic<qint64> eegBytesDrained{0};   // Worker
+    std::atomic<int>    commandsPending{0};   // Manager ++ on post, worker -- on run
+    std::atomic<qint64> maxWriteLatencyUs{0}; // Worker
+
+    void reset()
+    {
+        eegBytesQueued = 0;
+        eegBytesDrained = 0;
+        commandsPending = 0;
+        maxWriteLatencyUs = 0;
+    }
+
+    qint64 eegBytesPending() const
+    {
+        // The tap counts a chunk before pushing it, so anything drained was
+        // already queued; reading drained first keeps this non-negative.
+        const qint64 drained = eegBytesDrained.load(std::memory_order_acquire);
+        return eegBytesQueued.load(std::memory_order_acquire) - drained;
+    }
+};
+
+#endif // RECORDINGQUEUESTATS_H
@@ -19,7 +19,9 @@
  *    All output files share the sessionName prefix and live in saveFolderPath.
  *    Naming scheme (auto-generated: "REC_YYYYMMDD_HHMMSS"):
  *
- *      <sessionName>_eeg.csv          — EEG samples, LSL timestamps, μV
+ *      <sessionName>_eeg.csv          — EEG samples, LSL timestamps, μV (CSV format)
+ *      <sessionName>_eeg.bin          — same data, raw binary (RawFloat32 format)
+ *      <sessionName>_eeg.veeg         — same data, lossless compressed (Compressed format)
  *      <sessionName>_markers.csv      — Event markers with LSL timestamps
  *      <sessionName>_frames.csv       — Video frame index (frame# → LSL ts)
  *      <sessionName>_metadata.json    — Session metadata (rate, channels, etc.)
@@ -27,6 +29,67 @@
  *      <sessionName>_video_seg002.mkv — Video segment 2 (after pause/resume)
  *      <sessionName>_video_seg003.mkv — etc.
  *
+ *  EEG FILE FORMATS (eegFormat):
+ *    Csv        — text, one row per sample: LSL_Timestamp,ch1,ch2,...
+ *                 Human-readable; ~10 bytes per value plus formatting cost.
+ *    RawFloat32 — little-endian binary: a fixed 32-byte header followed by
+ *                 fixed-size records, one per sample:
+ *
+ *        Header (32 bytes)
+ *          0  char[8]  magic         "VEEGF32\0"
+ *          8  uint32   version       1
+ *         12  uint32   headerBytes   32 (offset of the first record)
+ *         16  uint32   channelCount  N
+ *         20  uint32   recordBytes   8 + 4·N
+ *         24  float64  samplingRate  nominal Hz
+ *
+ *        Record (8 + 4·N bytes)
+ *          0  float64     LSL timestamp (seconds)
+ *          8  float32[N]  channel values (μV), order as in channelNames
+ *
+ *      Sample i of channel c is at headerBytes + i·recordBytes + 8 + 4·c,
+ *      so the file can be memory-mapped or read with numpy.fromfile using
+ *      a structured dtype. Values are bit-exact float32 as delivered by LSL.
+ *      Pause boundaries are recorded in the markers CSV only (no in-band
+ *      rows). The layout is repeated in the metadata JSON.
+ *
+ *    Compressed — lossless, typically 3–5× smaller than RawFloat32 for
+ *                 amplifier data (see eegblockcodec.h). Little-endian:
+ *
+ *        Header (32 bytes)
+ *          0  char[8]  magic         "VEEGBLK\0"
+ *          8  uint32   version       1
+ *         12  uint32   headerBytes   32 (offset of the first block)
+ *         16  uint32   channelCount  N
+ *         20  uint32   maxBlockRows  1024
+ *         24  float64  samplingRate  nominal Hz
+ *
+ *        Blocks — back to back, each self-contained (32-byte block header
+ *          with magic, size, row count and first/last timestamp, then
+ *          the coded rows; see eegblockcodec.h). Every drain ends on a
+ *          block boundary, so a power cut tears at most the last block.
+ *
+ *        Index + trailer — written when the session closes:
+ *          per block (24 bytes): uint64 fileOffset, uint64 firstSample,
+ *                                float64 firstTimestamp
+ *          trailer (24 bytes, end of file): char[8] "VEEGIDX\0",
+ *                                uint64 indexOffset, uint64 blockCount
+ *          A file without a trailer (crash) is read by walking the blocks
+ *          from headerBytes until the first torn one.
+ *
+ *  DURABILITY POLICY (durability):
+ *    Controls when written data is forced from the OS page cache to the
+ *    disk (fdatasync / FlushFileBuffers). Between such checkpoints data
+ *    survives an application crash but not a power cut or OS crash.
+ *    EveryBatch — checkpoint after every EEG drain and every marker.
+ *                 Smallest loss window (~one drain interval), most syncs.
+ *    Interval   — group commit: at most one checkpoint per
+ *                 durabilityIntervalMs. Default (1 s).
+ *    Size       — group commit: checkpoint once durabilityBytes of EEG data
+ *                 are unsynced. Window scales inversely with data rate.
+ *    Pause boundaries and session close always checkpoint. The implied
+ *    loss window is written to the metadata JSON.
+ *
  *  VIDEO SEGMENTATION:
  *    Each pause/resume cycle starts a new video segment file (seg002, seg003).
  *    The frames CSV records which segment each frame belongs to, so post-hoc
@@ -42,6 +105,34 @@
 #include <QStringList>
 #include <QVector>
 #include <QDir>
+#include <QMetaType>
+
+enum class EegFileFormat
+{
+    Csv,        // <session>_eeg.csv — text rows
+    RawFloat32, // <session>_eeg.bin — header + float64/float32 records
+    Compressed  // <session>_eeg.veeg — header + lossless blocks + index
+};
+
+Q_DECLARE_METATYPE(EegFileFormat)
+
+/* Name used in the metadata and session-state JSON. */
+inline QString eegFileFormatName(EegFileFormat format)
+{
+    switch (format) {
+    case EegFileFormat::RawFloat32: return QStringLiteral("RAW_FLOAT32");
+    case EegFileFormat::Compressed: return QStringLiteral("COMPRESSED");
+    case EegFileFormat::Csv:        break;
+    }
+    return QStringLiteral("CSV");
+}
+
+enum class DurabilityPolicy
+{
+    EveryBatch, // Sync after every drain / marker write
+    Interval,   // Sync at most every durabilityIntervalMs
+    Size        // Sync once durabilityBytes of EEG data are pending
+};
 
 struct SessionConfig
 {
@@ -52,14 +143,22 @@ struct SessionConfig
     QStringList channelNames;   // Resolved human-readable labels (e.g. "Fp1", "C3")
     QString     cameraId;       // Platform camera device ID (empty = no video recording)
     double      samplingRate = 0.0;
+    EegFileFormat eegFormat = EegFileFormat::Csv;
+    DurabilityPolicy durability = DurabilityPolicy::Interval;
+    int         durabilityIntervalMs = 1000;            // Interval policy
+    qint64      durabilityBytes = 4 * 1024 * 1024;      // Size policy
 
     // -----------------------------------------------------------------------
     // File path helpers — all paths computed from saveFolderPath + sessionName
     // -----------------------------------------------------------------------
 
-    /* EEG data file: timestamp + channel values, one row per sample */
+    /* EEG data file: timestamp + channel values, one row/record per sample.
+     * The extension follows eegFormat. */
     QString eegFilePath() const {
-        return QDir(saveFolderPath).filePath(sessionName + "_eeg.csv");
+        const char* suffix = (eegFormat == EegFileFormat::RawFloat32) ? "_eeg.bin"
+                           : (eegFormat == EegFileFormat::Compressed) ? "_eeg.veeg"
+                                                                      : "_eeg.csv";
+        return QDir(saveFolderPath).filePath(sessionName + suffix);
     }
 
     /* Primary video file (segment 1, or only segment if no pause/resume) */
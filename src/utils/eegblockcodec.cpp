@@ -0,0 +1,664 @@
+/*
+ * ==========================================================================
+ *  eegblockcodec.cpp — Lossless Block Compression for Recorded EEG
+ * ==========================================================================
+ *  See eegblockcodec.h for the coding steps and the block layout.
+ * ==========================================================================
+ */
+
+#include "eegblockcodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+/* Rice quotients from here on are escaped to the raw value. */
+constexpr int ESCAPE_QUOTIENT = 32;
+
+/* Scale candidates tried: the smallest step between values divided by
+ * 1 … MAX_SCALE_DIVISOR (a block may contain no single-count step). */
+constexpr int MAX_SCALE_DIVISOR = 8;
+
+/* Scale search: the candidate window spans this many standard errors of
+ * the step estimate, and at most this many k of the reference value. */
+constexpr double SCALE_SIGMAS = 6.0;
+constexpr int MAX_SCALE_CANDIDATES = 64;
+
+/* |k| limit for scaled integers: fits int32 with room for prediction. */
+constexpr double MAX_SCALED_MAGNITUDE = 1073741824.0;  // 2^30
+
+constexpr int MAX_RICE_K32 = 31;   // 5-bit field
+constexpr int MAX_RICE_K64 = 62;   // 6-bit field
+
+enum ChannelMode : std::uint32_t
+{
+    Verbatim = 0,
+    FloatBits = 1,
+    Scaled = 2
+};
+
+inline std::uint32_t floatBits(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsToFloat(std::uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline std::uint64_t doubleBits(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double bitsToDouble(std::uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Value-ordered integer for an IEEE bit pattern: negative values get their
+ * magnitude bits flipped. Its own inverse. */
+inline std::uint32_t orderedBits(std::uint32_t bits)
+{
+    return bits ^ (std::uint32_t(std::int32_t(bits) >> 31) & 0x7fffffffu);
+}
+
+inline std::uint64_t orderedBits(std::uint64_t bits)
+{
+    return bits ^ (std::uint64_t(std::int64_t(bits) >> 63) & 0x7fffffffffffffffull);
+}
+
+inline std::uint32_t zigzag(std::uint32_t residual)
+{
+    return (residual << 1) ^ std::uint32_t(std::int32_t(residual) >> 31);
+}
+
+inline std::uint64_t zigzag(std::uint64_t residual)
+{
+    return (residual << 1) ^ std::uint64_t(std::int64_t(residual) >> 63);
+}
+
+template <typename T>
+inline T unzigzag(T value)
+{
+    return (value >> 1) ^ (T(0) - (value & 1));
+}
+
+/* Fixed predictor of order 1 or 2; wraps modulo 2^bits. */
+template <typename T>
+inline T predict(const T* x, int n, int order)
+{
+    return order == 1 ? x[n - 1] : T(2 * x[n - 1] - x[n - 2]);
+}
+
+/* Rice parameter for residuals summing to sum: largest k with
+ * count · 2^k <= sum / 2, i.e. about log2 of the mean. */
+inline int riceParameter(std::uint64_t sum, int count, int maxK)
+{
+    int k = 0;
+    while (k < maxK && (sum >> (k + 1)) >= std::uint64_t(count))
+        ++k;
+    return k;
+}
+
+inline void putLE32(char* out, std::uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out[i] = char(value >> (8 * i));
+}
+
+inline void putLE64(char* out, std::uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+        out[i] = char(value >> (8 * i));
+}
+
+inline std::uint32_t getLE32(const char* in)
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= std::uint32_t(std::uint8_t(in[i])) << (8 * i);
+    return value;
+}
+
+inline std::uint64_t getLE64(const char* in)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+        value |= std::uint64_t(std::uint8_t(in[i])) << (8 * i);
+    return value;
+}
+
+/* MSB-first bit stream into a buffer sized for the worst case. */
+class BitWriter
+{
+public:
+    explicit BitWriter(char* out) : m_out(out) {}
+
+    void put(std::uint32_t value, int bits)     // 0 <= bits <= 32
+    {
+        m_acc = (m_acc << bits) | (value & ((std::uint64_t(1) << bits) - 1));
+        m_count += bits;
+        while (m_count >= 8)
+        {
+            m_count -= 8;
+            *m_out++ = char(m_acc >> m_count);
+        }
+    }
+
+    void put64(std::uint64_t value, int bits)   // 0 <= bits <= 64
+    {
+        if (bits > 32)
+        {
+            put(std::uint32_t(value >> 32), bits - 32);
+            bits = 32;
+        }
+        put(std::uint32_t(value), bits);
+    }
+
+    void putRice(std::uint32_t value, int k)
+    {
+        const std::uint32_t quotient = value >> k;
+        if (quotient < std::uint32_t(ESCAPE_QUOTIENT))
+        {
+            // quotient ones and the terminating zero in one call
+            put(std::uint32_t(((std::uint64_t(1) << quotient) - 1) << 1), int(quotient) + 1);
+            put(value, k);
+            return;
+        }
+        put(0xffffffffu, ESCAPE_QUOTIENT);
+        put(value, 32);
+    }
+
+    void putRice64(std::uint64_t value, int k)
+    {
+        const std::uint64_t quotient = value >> k;
+        if (quotient < std::uint64_t(ESCAPE_QUOTIENT))
+        {
+            put(std::uint32_t(((std::uint64_t(1) << quotient) - 1) << 1), int(quotient) + 1);
+            put64(value, k);
+            return;
+        }
+        put(0xffffffffu, ESCAPE_QUOTIENT);
+        put64(value, 64);
+    }
+
+    /* Pads the last byte with zeros; returns the end of the stream. */
+    char* finish()
+    {
+        if (m_count > 0)
+            *m_out++ = char(m_acc << (8 - m_count));
+        m_count = 0;
+        return m_out;
+    }
+
+private:
+    char* m_out;
+    std::uint64_t m_acc = 0;
+    int m_count = 0;                // Pending bits in the low end of m_acc
+};
+
+class BitReader
+{
+public:
+    BitReader(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+    std::uint32_t get(int bits)                 // 0 <= bits <= 32
+    {
+        while (m_count < bits)
+        {
+            m_acc = (m_acc << 8) | (m_pos < m_size ? std::uint8_t(m_data[m_pos]) : 0u);
+            m_overrun = m_overrun || m_pos >= m_size;
+            ++m_pos;
+            m_count += 8;
+        }
+        m_count -= bits;
+        return std::uint32_t((m_acc >> m_count) & ((std::uint64_t(1) << bits) - 1));
+    }
+
+    std::uint64_t get64(int bits)               // 0 <= bits <= 64
+    {
+        if (bits <= 32)
+            return get(bits);
+        const std::uint64_t high = get(bits - 32);
+        return (high << 32) | get(32);
+    }
+
+    std::uint32_t getRice(int k)
+    {
+        int quotient = 0;
+        while (quotient < ESCAPE_QUOTIENT && get(1))
+            ++quotient;
+        if (quotient == ESCAPE_QUOTIENT)
+            return get(32);
+        return (std::uint32_t(quotient) << k) | get(k);
+    }
+
+    std::uint64_t getRice64(int k)
+    {
+        int quotient = 0;
+        while (quotient < ESCAPE_QUOTIENT && get(1))
+            ++quotient;
+        if (quotient == ESCAPE_QUOTIENT)
+            return get64(64);
+        return (std::uint64_t(quotient) << k) | get64(k);
+    }
+
+    bool overrun() const { return m_overrun; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    std::uint64_t m_acc = 0;
+    int m_count = 0;
+    bool m_overrun = false;
+};
+
+/* Predictor order, Rice parameter and estimated size of a coded column. */
+struct ColumnCoding
+{
+    int order = 1;
+    int k = 0;
+    std::uint64_t bits = 0;
+};
+
+ColumnCoding chooseColumnCoding(const std::uint32_t* x, int count)
+{
+    std::uint64_t sum[2] = { 0, 0 };
+    for (int i = 1; i < count; ++i)
+        sum[0] += zigzag(std::uint32_t(x[i] - predict(x, i, 1)));
+    for (int i = 2; i < count; ++i)
+        sum[1] += zigzag(std::uint32_t(x[i] - predict(x, i, 2)));
+
+    ColumnCoding best;
+    for (int order = 1; order <= 2; ++order)
+    {
+        const int warm = std::min(order, count);
+        const int residuals = count - warm;
+        ColumnCoding coding;
+        coding.order = order;
+        coding.k = residuals > 0 ? riceParameter(sum[order - 1], residuals, MAX_RICE_K32) : 0;
+        coding.bits = 6 + 32ull * warm + std::uint64_t(residuals) * (coding.k + 1)
+                      + (sum[order - 1] >> coding.k);
+        if (order == 1 || coding.bits < best.bits)
+            best = coding;
+    }
+    return best;
+}
+
+void writeColumn(BitWriter& writer, const std::uint32_t* x, int count, const ColumnCoding& coding)
+{
+    writer.put(std::uint32_t(coding.order - 1), 1);
+    writer.put(std::uint32_t(coding.k), 5);
+    const int warm = std::min(coding.order, count);
+    for (int i = 0; i < warm; ++i)
+        writer.put(x[i], 32);
+    for (int i = warm; i < count; ++i)
+        writer.putRice(zigzag(std::uint32_t(x[i] - predict(x, i, coding.order))), coding.k);
+}
+
+bool readColumn(BitReader& reader, std::uint32_t* x, int count)
+{
+    const int order = int(reader.get(1)) + 1;
+    const int k = int(reader.get(5));
+    const int warm = std::min(order, count);
+    for (int i = 0; i < warm; ++i)
+        x[i] = reader.get(32);
+    for (int i = warm; i < count; ++i)
+        x[i] = predict(x, i, order) + unzigzag(reader.getRice(k));
+    return !reader.overrun();
+}
+
+/* The one expression both sides use to rebuild a scaled value. */
+inline float scaledValue(std::int32_t k, double scale)
+{
+    return float(double(k) * scale);
+}
+
+/* Integers k with scaledValue(k, scale) == value bit-exactly, or false. */
+bool scaledIntegers(const float* values, int count, double scale, std::uint32_t* out)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const double ratio = double(values[i]) / scale;
+        if (!(std::fabs(ratio) <= MAX_SCALED_MAGNITUDE))
+            return false;
+        const std::int32_t k = std::int32_t(std::nearbyint(ratio));
+        if (floatBits(scaledValue(k, scale)) != floatBits(values[i]))
+            return false;
+        out[i] = std::uint32_t(k);
+    }
+    return true;
+}
+
+/* Narrows [low, high] to the scales for which k · scale rounds to each
+ * value, with k taken from the estimate. False if it becomes empty. */
+bool narrowScaleInterval(const float* values, int count, double estimate,
+                         double& low, double& high)
+{
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < count; ++i)
+    {
+        const float value = values[i];
+        const double k = std::nearbyint(double(value) / estimate);
+        if (k == 0.0)
+        {
+            if (floatBits(value) != 0)      // Only +0 comes back from k = 0
+                return false;
+            continue;
+        }
+        // Rounding interval of the float (midpoints to its neighbours)
+        const double below = 0.5 * (double(value) + double(std::nextafter(value, -infinity)));
+        const double above = 0.5 * (double(value) + double(std::nextafter(value, infinity)));
+        const double a = below / k;
+        const double b = above / k;
+        low = std::max(low, std::min(a, b));
+        high = std::min(high, std::max(a, b));
+        if (!(low <= high))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void EegBlockCodec::reset(int channelCount)
+{
+    m_channelCount = std::max(channelCount, 0);
+    m_scaleLow.assign(size_t(m_channelCount), 0.0);
+    m_scaleHigh.assign(size_t(m_channelCount), 0.0);
+}
+
+bool EegBlockCodec::findScale(int channel, const float* column, int count, double& scale)
+{
+    // Fast path: the scale verified on the previous block
+    if (m_scaleHigh[channel] > 0.0)
+    {
+        const double cached = 0.5 * (m_scaleLow[channel] + m_scaleHigh[channel]);
+        if (scaledIntegers(column, count, cached, m_ints.data()))
+        {
+            scale = cached;
+            return true;
+        }
+    }
+    m_scaleLow[channel] = 0.0;
+    m_scaleHigh[channel] = 0.0;
+
+    // Reference value: the smallest magnitude, so the fewest k to try.
+    // Zeros only fit as +0 (k = 0) and say nothing about the scale.
+    int reference = -1;
+    double step = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < count; ++i)
+    {
+        const double value = column[i];
+        if (!std::isfinite(value))
+            return false;
+        if (value == 0.0)
+        {
+            if (floatBits(column[i]) != 0)
+                return false;
+        }
+        else if (reference < 0 || std::fabs(value) < std::fabs(double(column[reference])))
+        {
+            reference = i;
+        }
+        if (i > 0)
+        {
+            const double delta = std::fabs(value - double(column[i - 1]));
+            if (delta > 0.0)
+                step = std::min(step, delta);
+        }
+    }
+    if (reference < 0)
+        return false;                       // All +0: the float path costs ~nothing
+    const double anchor = std::fabs(double(column[reference]));
+    if (!std::isfinite(step))
+        step = anchor;                      // Constant column
+
+    for (int divisor = 1; divisor <= MAX_SCALE_DIVISOR; ++divisor)
+    {
+        // 1. Estimate the scale from the steps between values: they are
+        //    small multiples m of it, so even a rough guess rounds m
+        //    right. Least squares over growing step sizes sharpens it.
+        double estimate = step / divisor;
+        double relativeError = 0.5;
+        for (double limit : { 8.0, 64.0, MAX_SCALED_MAGNITUDE })
+        {
+            double numerator = 0.0, denominator = 0.0;
+            for (int i = 1; i < count; ++i)
+            {
+                const double delta = double(column[i]) - double(column[i - 1]);
+                const double m = std::nearbyint(delta / estimate);
+                if (std::fabs(m) <= limit)
+                {
+                    numerator += m * delta;
+                    denominator += m * m;
+                }
+            }
+            if (denominator <= 0.0)
+                break;
+            const double refined = numerator / denominator;
+            double residual = 0.0;
+            for (int i = 1; i < count; ++i)
+            {
+                const double delta = double(column[i]) - double(column[i - 1]);
+                const double m = std::nearbyint(delta / estimate);
+                if (std::fabs(m) <= limit)
+                    residual += (delta - m * refined) * (delta - m * refined);
+            }
+            estimate = refined;
+            relativeError = SCALE_SIGMAS * std::sqrt(residual / denominator) / estimate
+                            + std::numeric_limits<float>::epsilon();
+        }
+        if (!(estimate > 0.0) || anchor / estimate > MAX_SCALED_MAGNITUDE)
+            continue;
+
+        // 2. The steps do not pin down the absolute k of values far from
+        //    zero (a DC offset). Try each k of the reference value that
+        //    the estimate allows, nearest first: each gives a narrow scale
+        //    interval that every other value must then agree with.
+        const double centre = anchor / estimate;
+        const double spread = std::min(centre * relativeError, double(MAX_SCALE_CANDIDATES / 2));
+        const double first = std::max(1.0, std::ceil(centre - spread));
+        const double last = std::floor(centre + spread);
+        const double nearest = std::max(first, std::min(last, std::nearbyint(centre)));
+        for (int attempt = 0; attempt <= 2 * (last - first); ++attempt)
+        {
+            const double offset = (attempt + 1) / 2;
+            const double k = (attempt % 2) ? nearest + offset : nearest - offset;
+            if (k < first || k > last)
+                continue;
+
+            double low = 0.0;
+            double high = std::numeric_limits<double>::infinity();
+            const float value = column[reference];
+            const double signedK = value < 0.0f ? -k : k;
+            if (!narrowScaleInterval(&value, 1, std::fabs(double(value)) / k, low, high)
+                || !narrowScaleInterval(column, count, 0.5 * (low + high), low, high))
+                continue;
+
+            const double candidate = 0.5 * (low + high);
+            if (std::nearbyint(double(value) / candidate) == signedK
+                && scaledIntegers(column, count, candidate, m_ints.data()))
+            {
+                m_scaleLow[channel] = low;
+                m_scaleHigh[channel] = high;
+                scale = candidate;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void EegBlockCodec::encode(const float* rows, const double* timestamps, int rowCount,
+                           std::vector<char>& out)
+{
+    for (int first = 0; first < rowCount; first += MAX_BLOCK_ROWS)
+    {
+        const int count = std::min(MAX_BLOCK_ROWS, rowCount - first);
+        encodeBlock(rows + size_t(first) * size_t(m_channelCount), timestamps + first, count, out);
+    }
+}
+
+void EegBlockCodec::encodeBlock(const float* rows, const double* timestamps, int rowCount,
+                                std::vector<char>& out)
+{
+    const int channels = m_channelCount;
+    const size_t n = size_t(rowCount);
+
+    // Worst case per value: escaped residual (64 bits) plus headers.
+    const size_t worstBits = 6 + 128 + 96 * n + size_t(channels) * (2 + 64 + 6 + 64 + 64 * n);
+    const size_t base = out.size();
+    out.resize(base + BLOCK_HEADER_BYTES + worstBits / 8 + 16);
+    char* payload = out.data() + base + BLOCK_HEADER_BYTES;
+    BitWriter writer(payload);
+
+    // Timestamps: order-2 prediction on the ordered 64-bit patterns
+    {
+        std::vector<std::uint64_t> ts(n);
+        for (size_t i = 0; i < n; ++i)
+            ts[i] = orderedBits(doubleBits(timestamps[i]));
+        double mean = 0.0;
+        for (size_t i = 2; i < n; ++i)
+            mean += double(zigzag(std::uint64_t(ts[i] - predict(ts.data(), int(i), 2))));
+        mean = n > 2 ? mean / double(n - 2) : 0.0;
+        const int k = mean >= 2.0 ? std::min(int(std::log2(mean)), MAX_RICE_K64) : 0;
+
+        writer.put(std::uint32_t(k), 6);
+        for (size_t i = 0; i < std::min<size_t>(2, n); ++i)
+            writer.put64(ts[i], 64);
+        for (size_t i = 2; i < n; ++i)
+            writer.putRice64(zigzag(std::uint64_t(ts[i] - predict(ts.data(), int(i), 2))), k);
+    }
+
+    m_column.resize(n);
+    m_ints.resize(n);
+    std::vector<std::uint32_t> bits(n);
+    for (int c = 0; c < channels; ++c)
+    {
+        for (size_t i = 0; i < n; ++i)
+            m_column[i] = rows[i * size_t(channels) + size_t(c)];
+
+        double scale = 0.0;
+        ColumnCoding scaledCoding;
+        const bool scaled = findScale(c, m_column.data(), rowCount, scale);
+        if (scaled)
+            scaledCoding = chooseColumnCoding(m_ints.data(), rowCount);
+
+        for (size_t i = 0; i < n; ++i)
+            bits[i] = orderedBits(floatBits(m_column[i]));
+        const ColumnCoding floatCoding = chooseColumnCoding(bits.data(), rowCount);
+
+        const std::uint64_t verbatimBits = 32ull * n;
+        if (scaled && scaledCoding.bits + 64 < std::min(floatCoding.bits, verbatimBits))
+        {
+            writer.put(Scaled, 2);
+            writer.put64(doubleBits(scale), 64);
+            writeColumn(writer, m_ints.data(), rowCount, scaledCoding);
+        }
+        else if (floatCoding.bits < verbatimBits)
+        {
+            writer.put(FloatBits, 2);
+            writeColumn(writer, bits.data(), rowCount, floatCoding);
+        }
+        else
+        {
+            writer.put(Verbatim, 2);
+            for (size_t i = 0; i < n; ++i)
+                writer.put(floatBits(m_column[i]), 32);
+        }
+    }
+
+    const size_t payloadBytes = size_t(writer.finish() - payload);
+    char* header = out.data() + base;
+    putLE32(header, BLOCK_MAGIC);
+    putLE32(header + 4, std::uint32_t(payloadBytes));
+    putLE32(header + 8, std::uint32_t(rowCount));
+    putLE32(header + 12, std::uint32_t(channels));
+    putLE64(header + 16, doubleBits(timestamps[0]));
+    putLE64(header + 24, doubleBits(timestamps[n - 1]));
+    out.resize(base + BLOCK_HEADER_BYTES + payloadBytes);
+}
+
+bool EegBlockCodec::decodeBlock(const char* data, size_t size, int channelCount,
+                                std::vector<double>& timestamps, std::vector<float>& values,
+                                size_t* blockBytes)
+{
+    if (size < size_t(BLOCK_HEADER_BYTES) || getLE32(data) != BLOCK_MAGIC)
+        return false;
+    const size_t payloadBytes = getLE32(data + 4);
+    const int rowCount = int(getLE32(data + 8));
+    if (int(getLE32(data + 12)) != channelCount || rowCount <= 0 || rowCount > MAX_BLOCK_ROWS
+        || payloadBytes > size - BLOCK_HEADER_BYTES)
+        return false;
+
+    const size_t n = size_t(rowCount);
+    const size_t tsBase = timestamps.size();
+    const size_t valueBase = values.size();
+    BitReader reader(data + BLOCK_HEADER_BYTES, payloadBytes);
+
+    std::vector<std::uint64_t> ts(n);
+    const int tsK = int(reader.get(6));
+    for (size_t i = 0; i < n; ++i)
+    {
+        ts[i] = i < 2 ? reader.get64(64)
+                      : predict(ts.data(), int(i), 2) + unzigzag(reader.getRice64(tsK));
+    }
+    for (size_t i = 0; i < n; ++i)
+        timestamps.push_back(bitsToDouble(orderedBits(ts[i])));
+
+    values.resize(valueBase + n * size_t(channelCount));
+    float* out = values.data() + valueBase;
+    std::vector<std::uint32_t> x(n);
+    bool ok = !reader.overrun();
+    for (int c = 0; c < channelCount && ok; ++c)
+    {
+        const std::uint32_t mode = reader.get(2);
+        if (mode == Scaled)
+        {
+            const double scale = bitsToDouble(reader.get64(64));
+            ok = readColumn(reader, x.data(), rowCount);
+            for (size_t i = 0; i < n; ++i)
+                out[i * size_t(channelCount) + size_t(c)] = scaledValue(std::int32_t(x[i]), scale);
+        }
+        else if (mode == FloatBits)
+        {
+            ok = readColumn(reader, x.data(), rowCount);
+            for (size_t i = 0; i < n; ++i)
+                out[i * size_t(channelCount) + size_t(c)] = bitsToFloat(orderedBits(x[i]));
+        }
+        else if (mode == Verbatim)
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i * size_t(channelCount) + size_t(c)] = bitsToFloat(reader.get(32));
+            ok = !reader.overrun();
+        }
+        else
+        {
+            ok = false;
+        }
+    }
+
+    if (!ok)
+    {
+        timestamps.resize(tsBase);
+        values.resize(valueBase);
+        return false;
+    }
+    *blockBytes = BLOCK_HEADER_BYTES + payloadBytes;
+    return true;
+}
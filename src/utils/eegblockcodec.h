@@ -0,0 +1,122 @@
+/*
+ * ==========================================================================
+ *  eegblockcodec.h — Lossless Block Compression for Recorded EEG
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Encodes runs of recorded samples (timestamp + float32 channel values)
+ *    into self-contained, independently decodable blocks for the
+ *    Compressed EEG file format (see sessionconfig.h). Decoding returns
+ *    the input bit-exactly. RecordingWorker encodes one or more blocks per
+ *    drain on its own thread.
+ *
+ *  CODING, PER CHANNEL AND BLOCK:
+ *    1. Integer domain — amplifiers digitise integer ADC counts and scale
+ *       them to μV, so values are usually v = float(k · q) for one step q
+ *       per channel. The encoder recovers q (see SCALE RECOVERY) and, if
+ *       every value of the block reproduces bit-exactly from its k, codes
+ *       the integers k. Otherwise it codes the float bit patterns, mapped
+ *       to integers in value order (sign-magnitude → two's complement) so
+ *       that close values stay close.
+ *    2. Prediction — fixed polynomial predictor of order 1 (x[n−1]) or 2
+ *       (2x[n−1] − x[n−2]), whichever leaves the smaller residuals.
+ *       Arithmetic wraps modulo 2³², which keeps it exactly invertible.
+ *    3. Entropy coding — residuals are zigzag-mapped and Rice-coded with
+ *       one parameter per channel and block. Quotients of 32 or more are
+ *       escaped to the raw 32-bit value, so artefacts cost at most 64 bits.
+ *    A channel is stored verbatim when that is cheaper (white noise).
+ *
+ *    Timestamps are coded the same way on the 64-bit pattern of the
+ *    double (order 2); dejittered timestamps leave residuals of a few bits.
+ *
+ *  SCALE RECOVERY:
+ *    A first guess of q is the smallest step between consecutive values
+ *    (or an integer fraction of it), refined by least squares over the
+ *    block. Each value then confines q to the interval that rounds k · q
+ *    back to that float; the encoder takes the middle of the intersection
+ *    over all values and verifies every value bit-exactly. The interval
+ *    is carried to the next block, so a steady stream re-verifies the
+ *    cached q in one pass and only re-estimates after a change.
+ *
+ *  BLOCK LAYOUT (little-endian):
+ *      0  uint32   magic         BLOCK_MAGIC ("VEGB")
+ *      4  uint32   payloadBytes  bytes after this 32-byte header
+ *      8  uint32   rowCount
+ *     12  uint32   channelCount
+ *     16  float64  first timestamp of the block
+ *     24  float64  last timestamp of the block
+ *     32  payload  MSB-first bit stream, padded to a whole byte:
+ *           timestamps: 6-bit Rice k, rows 0–1 raw (64 bits), residuals
+ *           per channel: 2-bit mode (0 verbatim, 1 float bits, 2 scaled)
+ *             mode 2: 64-bit q (float64 bits)
+ *             mode 1/2: 1-bit order − 1, 5-bit Rice k, first `order`
+ *                       values raw (32 bits), then residuals
+ *             mode 0: rowCount raw float32 bit patterns
+ *           Rice code: quotient in unary (ones, then a zero), remainder
+ *           in k bits; 32 ones mean "escaped", followed by the raw value.
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++ so bench/eegblockcodec_bench.cpp can build it standalone.
+ *
+ *  THREAD SAFETY:
+ *    None — an encoder instance is owned by one RecordingWorker.
+ *    decodeBlock() is stateless.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGBLOCKCODEC_H
+#define EEGBLOCKCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class EegBlockCodec
+{
+public:
+    static constexpr std::uint32_t BLOCK_MAGIC = 0x42474556;   // "VEGB"
+    static constexpr int BLOCK_HEADER_BYTES = 32;
+
+    /* Largest block encode() produces; longer runs are split. */
+    static constexpr int MAX_BLOCK_ROWS = 1024;
+
+    /* Starts a new stream of channelCount-wide rows; forgets cached scales. */
+    void reset(int channelCount);
+
+    int channelCount() const { return m_channelCount; }
+
+    /* Appends rowCount interleaved rows ([row * channelCount + ch]) and
+     * their timestamps to out as ceil(rowCount / MAX_BLOCK_ROWS) blocks. */
+    void encode(const float* rows, const double* timestamps, int rowCount,
+                std::vector<char>& out);
+
+    /* Decodes the block at data (size bytes available). On success appends
+     * its rows to timestamps / values (interleaved), sets *blockBytes to
+     * the block's total size and returns true. Returns false for a torn
+     * or corrupt block (e.g. the tail of a file cut by a power loss). */
+    static bool decodeBlock(const char* data, size_t size, int channelCount,
+                            std::vector<double>& timestamps, std::vector<float>& values,
+                            size_t* blockBytes);
+
+private:
+    void encodeBlock(const float* rows, const double* timestamps, int rowCount,
+                     std::vector<char>& out);
+
+    /* Sets m_ints to the scaled integers of column if some q reproduces
+     * every value; updates the channel's cached interval. */
+    bool findScale(int channel, const float* column, int count, double& scale);
+
+    int m_channelCount = 0;
+
+    /* Per channel: admissible interval of the last verified scale
+     * (0, 0 = none yet). */
+    std::vector<double> m_scaleLow;
+    std::vector<double> m_scaleHigh;
+
+    // Scratch, reused across blocks
+    std::vector<float> m_column;            // One channel of the block, contiguous
+    std::vector<std::uint32_t> m_ints;      // Its integers (scaled or mapped bits)
+};
+
+#endif // EEGBLOCKCODEC_H
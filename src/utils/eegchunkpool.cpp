@@ -0,0 +1,42 @@
+/*
+ * ==========================================================================
+ *  eegchunkpool.cpp — Recycled EegChunk Buffers Implementation
+ * ==========================================================================
+ *  See eegchunkpool.h for the reclaim scheme and bounds.
+ * ==========================================================================
+ */
+
+#include "eegchunkpool.h"
+
+#include <atomic>
+
+std::shared_ptr<EegChunk> EegChunkPool::acquire()
+{
+    const size_t count = m_slots.size();
+    for (size_t n = 0; n < count; ++n) {
+        const size_t i = (m_cursor + n) % count;
+        std::shared_ptr<EegChunk>& slot = m_slots[i];
+        if (slot.use_count() != 1)
+            continue;
+
+        // The last consumer's reads of this chunk happen before its
+        // reference-count decrement (a release operation); the fence pairs
+        // with it so refilling the buffers cannot overtake those reads.
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot->samples.capacity() > MAX_RETAINED_FLOATS)
+            slot = std::make_shared<EegChunk>();
+
+        m_cursor = (i + 1) % count;
+        return slot;
+    }
+
+    if (count < MAX_SLOTS) {
+        m_slots.push_back(std::make_shared<EegChunk>());
+        m_cursor = 0; // The new slot is in flight; the oldest is likely next free
+        return m_slots.back();
+    }
+
+    // Every slot is still referenced (consumer stalled): do not block.
+    return std::make_shared<EegChunk>();
+}
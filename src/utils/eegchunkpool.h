@@ -0,0 +1,80 @@
+/*
+ * ==========================================================================
+ *  eegchunkpool.h — Recycled EegChunk Buffers for the Acquisition Thread
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Keeps the steady-state EEG path allocation-free. Every chunk pulled
+ *    from LSL used to be a fresh make_shared<EegChunk>() with two vector
+ *    allocations, freed again on whichever consumer thread dropped the
+ *    last reference (usually RecordingWorker, ~250 ms later). The pool
+ *    hands out chunks whose vectors already have capacity and takes them
+ *    back once every consumer is done with them.
+ *
+ *  RECLAIM BY UNIQUE OWNERSHIP:
+ *    The pool keeps one shared_ptr per slot. A slot is free again when
+ *    its use_count() has dropped back to 1 — only the pool still holds
+ *    it, so no consumer can read it and none can obtain a new reference
+ *    (handles are only ever copied from a published one). Consumers need
+ *    no release call and no knowledge of the pool; dropping the
+ *    EegChunkPtr as before is the release.
+ *
+ *        acquire()  ─▸ slot (use_count 1 → 2+) ─▸ dispatcher fan-out
+ *                                                  ├─ EegSyncManager   (copies, drops)
+ *                                                  ├─ SPSC ring → RecordingWorker (drops after write)
+ *                                                  └─ EegBackend       (drops after display)
+ *        ◂──────────────── use_count back to 1: slot reusable ◂───────┘
+ *
+ *    Slots are scanned round-robin from the last hand-out. Consumers
+ *    finish in roughly publication order, so the slot at the cursor is
+ *    almost always the free one and acquire() is O(1) in practice.
+ *
+ *  BOUNDS:
+ *    The pool grows to the number of chunks simultaneously in flight
+ *    (a few hundred with single-sample chunks and a 250 ms recording
+ *    drain) up to MAX_SLOTS; past that, chunks are allocated unpooled
+ *    so a stalled consumer degrades to the old behaviour instead of
+ *    blocking acquisition. A slot whose buffers ballooned during a stall
+ *    (MAX_CHUNK_SAMPLES pulls) is replaced by a fresh one on reuse
+ *    rather than pinning that memory for the rest of the session.
+ *
+ *  THREAD SAFETY:
+ *    acquire() — acquisition thread only (single producer).
+ *    Dropping handles — any thread, as with any shared_ptr.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGCHUNKPOOL_H
+#define EEGCHUNKPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "eegchunk.h"
+
+class EegChunkPool
+{
+public:
+    EegChunkPool() = default;
+    EegChunkPool(const EegChunkPool&) = delete;
+    EegChunkPool& operator=(const EegChunkPool&) = delete;
+
+    /* Returns a chunk no consumer references any more. Its vectors keep
+     * their previous capacity (contents are stale); the caller resizes
+     * and fills them before publishing. */
+    std::shared_ptr<EegChunk> acquire();
+
+    size_t slotCount() const { return m_slots.size(); }
+
+private:
+    std::vector<std::shared_ptr<EegChunk>> m_slots;
+    size_t m_cursor = 0;
+
+    static constexpr size_t MAX_SLOTS = 2048;
+
+    /* Buffers above this many floats are not kept across reuse. */
+    static constexpr size_t MAX_RETAINED_FLOATS = 256 * 1024; // 1 MiB
+};
+
+#endif // EEGCHUNKPOOL_H
@@ -0,0 +1,132 @@
+/*
+ * ==========================================================================
+ *  eegclockmodel.h — Linear Drift Model for LSL time_correction()
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    LSL's time_correction() returns the offset between the EEG stream's
+ *    clock and the local clock at one moment, at the cost of a network
+ *    round trip. Between two measurements (10 s apart) the offset keeps
+ *    moving — USB amplifier crystals drift by tens of ppm — so the last
+ *    measured value is stale by up to one interval of drift, and jumps at
+ *    every refresh.
+ *
+ *    EegClockDriftFit keeps the recent measurements and fits
+ *
+ *      correction(t) = offset + slope · (t − referenceTime)
+ *
+ *    by least squares. EegClockModel is the fitted line, an immutable
+ *    value that sync queries evaluate at their own timestamp. This both
+ *    smooths the measurement noise and extrapolates the drift between
+ *    measurements.
+ *
+ *  NUMERICS:
+ *    Times are LSL seconds (~1e5 after a day of uptime); the fit is
+ *    centred on the mean time and mean correction, so the sums stay small
+ *    and double precision is plenty.
+ *
+ *  EXTRAPOLATION LIMIT:
+ *    correctionAt() holds the model flat before the first measurement and
+ *    more than MAX_EXTRAPOLATION_SEC after the last one, so a lost inlet
+ *    does not let a small slope error grow without bound.
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++, like the other src/utils kernels.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGCLOCKMODEL_H
+#define EEGCLOCKMODEL_H
+
+#include <algorithm>
+#include <array>
+
+struct EegClockModel
+{
+    static constexpr double MAX_EXTRAPOLATION_SEC = 60.0;
+
+    double referenceTime = 0.0;     // Mean local time of the fitted measurements
+    double offset = 0.0;            // Correction at referenceTime (seconds)
+    double slope = 0.0;             // Drift, seconds per second
+    double firstTime = 0.0;         // Oldest / newest measurement in the fit
+    double lastTime = 0.0;
+    int measurements = 0;
+
+    /* Correction (seconds) to subtract from a local timestamp. */
+    double correctionAt(double localTime) const
+    {
+        const double t = std::clamp(localTime, firstTime, lastTime + MAX_EXTRAPOLATION_SEC);
+        return offset + slope * (t - referenceTime);
+    }
+};
+
+class EegClockDriftFit
+{
+public:
+    /* Measurements kept: 6 minutes at the 10 s refresh — long enough to
+     * average out round-trip noise, short enough to follow thermal drift. */
+    static constexpr int HISTORY = 36;
+
+    void reset()
+    {
+        m_count = 0;
+        m_next = 0;
+    }
+
+    void addMeasurement(double localTime, double correction)
+    {
+        m_time[m_next] = localTime;
+        m_correction[m_next] = correction;
+        m_next = (m_next + 1) % HISTORY;
+        m_count = std::min(m_count + 1, HISTORY);
+    }
+
+    int size() const { return m_count; }
+
+    /* Least-squares line through the kept measurements. One measurement
+     * gives a flat model; none gives the zero model. */
+    EegClockModel model() const
+    {
+        EegClockModel model;
+        model.measurements = m_count;
+        if (m_count == 0)
+            return model;
+
+        double meanTime = 0.0;
+        double meanCorrection = 0.0;
+        model.firstTime = m_time[0];
+        model.lastTime = m_time[0];
+        for (int i = 0; i < m_count; ++i)
+        {
+            meanTime += m_time[i];
+            meanCorrection += m_correction[i];
+            model.firstTime = std::min(model.firstTime, m_time[i]);
+            model.lastTime = std::max(model.lastTime, m_time[i]);
+        }
+        meanTime /= m_count;
+        meanCorrection /= m_count;
+
+        double covariance = 0.0;
+        double variance = 0.0;
+        for (int i = 0; i < m_count; ++i)
+        {
+            const double dt = m_time[i] - meanTime;
+            covariance += dt * (m_correction[i] - meanCorrection);
+            variance += dt * dt;
+        }
+
+        model.referenceTime = meanTime;
+        model.offset = meanCorrection;
+        model.slope = variance > 0.0 ? covariance / variance : 0.0;
+        return model;
+    }
+
+private:
+    std::array<double, HISTORY> m_time{};
+    std::array<double, HISTORY> m_correction{};
+    int m_count = 0;
+    int m_next = 0;
+};
+
+#endif // EEGCLOCKMODEL_H
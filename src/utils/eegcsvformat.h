@@ -0,0 +1,72 @@
+/*
+ * ==========================================================================
+ *  eegcsvformat.h — Allocation-Free Fixed-Point Formatting for EEG CSV
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    RecordingWorker formats every CSV sample row with appendFixed()
+ *    straight into its per-drain write buffer instead of building a
+ *    QString per value. The output is byte-for-byte what
+ *    QString::number(value, 'f', precision) produced before, so CSV files
+ *    do not change:
+ *      - digits: both are correctly rounded fixed notation (std::to_chars
+ *        here, Qt's double-conversion there), except on exact ties: Qt
+ *        rounds half away from zero (4253.03125 → "4253.0313"), to_chars
+ *        half to even, so a tie is nudged one ulp outwards first;
+ *      - zero: Qt drops the sign of an exact −0.0 ("0.0000") but keeps it
+ *        on values that round to zero ("-0.0000"); so does this;
+ *      - NaN is "nan" whatever its sign bit, ±infinity "inf" / "-inf".
+ *    Callers widen float channel values to double first, as
+ *    QString::number(float) did.
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++, so bench/eegcsvformat_bench.cpp can compare it with the
+ *    QString path it replaced.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGCSVFORMAT_H
+#define EEGCSVFORMAT_H
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/* Room reserved per CSV field before formatting. Fixed notation of a
+ * |value| < 1e30 with 6 decimals fits in 40 chars; larger values make
+ * appendFixed() grow the buffer and retry. */
+constexpr size_t CSV_FIELD_RESERVE = 48;
+
+/* Appends value in fixed notation with the given number of decimals —
+ * the same bytes QString::number(value, 'f', precision) produces —
+ * without allocating per value. */
+inline void appendFixed(std::vector<char>& buf, double value, int precision)
+{
+    if (std::isnan(value)) {
+        buf.insert(buf.end(), { 'n', 'a', 'n' });
+        return;
+    }
+    if (value == 0.0)
+        value = 0.0;   // −0.0 → 0.0
+
+    // value · 10^p ends in exactly .5 iff value · 2^(p+1) is an odd
+    // integer (the 5^p factor must cancel). Scaling by 2^n is exact.
+    const double halves = std::ldexp(value, precision + 1);
+    if (halves == std::trunc(halves) && std::fmod(halves, 2.0) != 0.0)
+        value = std::nextafter(value, value > 0.0 ? HUGE_VAL : -HUGE_VAL);
+
+    size_t used = buf.size();
+    for (size_t reserve = CSV_FIELD_RESERVE; ; reserve *= 8) {
+        buf.resize(used + reserve);
+        const auto [end, ec] = std::to_chars(buf.data() + used, buf.data() + buf.size(),
+                                             value, std::chars_format::fixed, precision);
+        if (ec == std::errc()) {
+            buf.resize(size_t(end - buf.data()));
+            return;
+        }
+    }
+}
+
+#endif // EEGCSVFORMAT_H
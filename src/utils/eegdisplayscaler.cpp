@@ -8,8 +8,10 @@
  */
 
 #include "eegdisplayscaler.h"
+#include "eegscalekernel.h"
 #include <QtMath>
 #include <QDebug>
+#include <QVarLengthArray>
 
 const QList<double> EegDisplayScaler::SENSITIVITY_OPTIONS = {
     1.0, 2.0, 3.0, 5.0, 7.0, 10.0, 15.0, 20.0, 30.0, 50.0, 100.0
@@ -100,18 +102,18 @@ double EegDisplayScaler::calculateChannelOffset(int channelIndex, int totalChann
 }
 
 QVector<QVector<double>> EegDisplayScaler::transformChunk(
-    const std::vector<std::vector<float>>& chunk,
+    const EegChunk& chunk,
     const QVector<int>& channelIndices,
     double channelSpacing) const
 {
-    if (chunk.empty() || chunk[0].empty())
+    if (chunk.isEmpty())
     {
         return {};
     }
 
-    const int numSamples = static_cast<int>(chunk.size());
+    const int numSamples = chunk.sampleCount;
     const int numChannels = channelIndices.size();
-    const int totalChunkChannels = static_cast<int>(chunk[0].size());
+    const int totalChunkChannels = chunk.channelCount;
     const double gain = displayGain();
 
     /* Output layout: [channel][sample] — transposed from input [sample][channel].
@@ -141,7 +143,7 @@ QVector<QVector<double>> EegDisplayScaler::transformChunk(
 
         for (int s = 0; s < numSamples; ++s)
         {
-            const double rawValue = static_cast<double>(chunk[s][sourceChannel]);
+            const double rawValue = static_cast<double>(chunk.value(s, sourceChannel));
             const double scaledValue = offset - (rawValue * gain);
             result[ch].append(scaledValue);
         }
@@ -149,3 +151,31 @@ QVector<QVector<double>> EegDisplayScaler::transformChunk(
 
     return result;
 }
+
+void EegDisplayScaler::transformChunkInto(
+    const EegChunk& chunk,
+    const QVector<int>& channelIndices,
+    double channelSpacing,
+    int firstSample, int count,
+    float* const* dest) const
+{
+    const int numChannels = channelIndices.size();
+    if (chunk.isEmpty() || numChannels == 0 || count <= 0)
+    {
+        return;
+    }
+
+    /* Per-channel baselines for this call; a stack array for any realistic
+     * montage, so the hot path does not allocate. Out-of-range indices are
+     * passed through — the kernel draws those channels as a flat baseline. */
+    QVarLengthArray<float, 256> offsets(numChannels);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        offsets[ch] = static_cast<float>(calculateChannelOffset(ch, numChannels, channelSpacing));
+    }
+
+    EegScaleKernel::scaleGather(chunk.row(firstSample), chunk.channelCount, count,
+                                channelIndices.constData(), offsets.constData(),
+                                static_cast<float>(displayGain()),
+                                numChannels, dest);
+}
@@ -33,12 +33,12 @@
  *    Subtracting from baseline achieves the correct visual orientation.
  *
  *  DATA FLOW:
- *    AmplifierManager::dataReceived  →  EegBackend::onDataReceived()
+ *    EegChunkDispatcher (queued)     →  EegBackend::onDataReceived()
  *                                            │
  *                                            ▼
  *                                    EegDisplayScaler::transformChunk()
  *                                            │
- *                                    Input:  [sample][channel] float μV
+ *                                    Input:  EegChunk, interleaved float μV
  *                                    Output: [channel][sample] double pixels
  *                                            │
  *                                            ▼
@@ -47,8 +47,16 @@
  *                                            ▼
  *                                    EegGraph.qml (renders waveforms)
  *
+ *  VECTORIZED PATH:
+ *    transformChunkInto() hands the interleaved chunk, the channel index
+ *    table and a per-channel offset table to EegScaleKernel::scaleGather()
+ *    (SSE2/AVX2 with runtime dispatch, scalar fallback), which gathers,
+ *    scales and stores float32 directly into EegDataModel's ring — no
+ *    intermediate QVector<QVector<double>>. transformChunk() remains for
+ *    callers that want the double [channel][sample] result.
+ *
  *  NOTE ON DATA TRANSPOSITION:
- *    Input from LSL is [sample][channel] (row-major, time-first).
+ *    Input from LSL is an interleaved EegChunk (row-major, time-first).
  *    Output for display is [channel][sample] (column-major, channel-first).
  *    This transposition happens in transformChunk() and is required because
  *    EegDataModel stores data per-channel in its circular buffer columns.
@@ -63,6 +71,7 @@
 #include <QList>
 #include <QVector>
 #include <QtQml/qqmlregistration.h>
+#include "eegchunk.h"
 
 class EegDisplayScaler : public QObject
 {
@@ -102,10 +111,21 @@ public:
      * Performs channel extraction (via channelIndices), μV→px scaling,
      * Y-axis inversion, and data transposition in a single pass. */
     QVector<QVector<double>> transformChunk(
-        const std::vector<std::vector<float>>& chunk,
+        const EegChunk& chunk,
         const QVector<int>& channelIndices,
         double channelSpacing) const;
 
+    /* Same transform for chunk rows [firstSample, firstSample + count),
+     * written as float32 straight to dest[ch] (EegDataModel::writeSamples
+     * hands out ring pointers). Runs the SIMD kernel in eegscalekernel.h;
+     * this is the display hot path. */
+    void transformChunkInto(
+        const EegChunk& chunk,
+        const QVector<int>& channelIndices,
+        double channelSpacing,
+        int firstSample, int count,
+        float* const* dest) const;
+
     /* Calculates the Y-pixel baseline for a given channel.
      * Channel 0 is placed at the top; channels stack downward. */
     static double calculateChannelOffset(int channelIndex, int totalChannels, double channelSpacing);
@@ -0,0 +1,211 @@
+/*
+ * ==========================================================================
+ *  eegfilterbank.cpp — Streaming Per-Channel IIR Filters Implementation
+ * ==========================================================================
+ *  See eegfilterbank.h for the filter chain and the state layout.
+ * ==========================================================================
+ */
+
+#include "eegfilterbank.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+/* Highest usable cutoff as a fraction of the sampling rate; at Nyquist
+ * the bilinear designs degenerate. */
+constexpr double MAX_CUTOFF_RATIO = 0.45;
+
+/* Q of the two sections of a 4th-order Butterworth low-pass. */
+constexpr double BUTTERWORTH4_Q1 = 0.54119610;
+constexpr double BUTTERWORTH4_Q2 = 1.30656296;
+constexpr double BUTTERWORTH2_Q = 0.70710678;
+
+} // namespace
+
+EegFilterBank::EegFilterBank()
+{
+    design();
+}
+
+void EegFilterBank::setSettings(const Settings& settings)
+{
+    m_settings = settings;
+    design();
+}
+
+void EegFilterBank::setSamplingRate(double samplingRate)
+{
+    if (samplingRate <= 0.0 || samplingRate == m_samplingRate)
+        return;
+
+    /* Different rate, different signal: old state means nothing now. */
+    m_samplingRate = samplingRate;
+    design();
+    reset();
+}
+
+bool EegFilterBank::isActive() const
+{
+    return std::any_of(m_enabled.begin(), m_enabled.end(), [](bool on) { return on; });
+}
+
+void EegFilterBank::reset()
+{
+    std::fill(m_z1.begin(), m_z1.end(), 0.0);
+    std::fill(m_z2.begin(), m_z2.end(), 0.0);
+    m_needsPrime = true;
+}
+
+// ============================================================================
+// Coefficient Design (RBJ Audio-EQ-Cookbook)
+// ============================================================================
+
+void EegFilterBank::design()
+{
+    const std::array<bool, SlotCount> wasEnabled = m_enabled;
+    const double fs = m_samplingRate;
+    const auto usable = [fs](double hz) {
+        return fs > 0.0 && hz > 0.0 && hz < MAX_CUTOFF_RATIO * fs;
+    };
+
+    const auto lowOrHighPass = [fs](double hz, double q, bool high) {
+        const double w0 = 2.0 * PI * hz / fs;
+        const double cosw = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double a0 = 1.0 + alpha;
+        Biquad c;
+        if (high)
+        {
+            c.b0 = (1.0 + cosw) / 2.0 / a0;
+            c.b1 = -(1.0 + cosw) / a0;
+        }
+        else
+        {
+            c.b0 = (1.0 - cosw) / 2.0 / a0;
+            c.b1 = (1.0 - cosw) / a0;
+        }
+        c.b2 = c.b0;
+        c.a1 = -2.0 * cosw / a0;
+        c.a2 = (1.0 - alpha) / a0;
+        return c;
+    };
+
+    m_enabled[HighPass] = usable(m_settings.highPassHz);
+    if (m_enabled[HighPass])
+        m_coeffs[HighPass] = lowOrHighPass(m_settings.highPassHz, BUTTERWORTH2_Q, true);
+
+    m_enabled[LowPass1] = m_enabled[LowPass2] = usable(m_settings.lowPassHz);
+    if (m_enabled[LowPass1])
+    {
+        m_coeffs[LowPass1] = lowOrHighPass(m_settings.lowPassHz, BUTTERWORTH4_Q1, false);
+        m_coeffs[LowPass2] = lowOrHighPass(m_settings.lowPassHz, BUTTERWORTH4_Q2, false);
+    }
+
+    m_enabled[Notch] = usable(m_settings.notchHz);
+    if (m_enabled[Notch])
+    {
+        const double w0 = 2.0 * PI * m_settings.notchHz / fs;
+        const double cosw = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * NOTCH_Q);
+        const double a0 = 1.0 + alpha;
+        Biquad& c = m_coeffs[Notch];
+        c.b0 = 1.0 / a0;
+        c.b1 = -2.0 * cosw / a0;
+        c.b2 = 1.0 / a0;
+        c.a1 = -2.0 * cosw / a0;
+        c.a2 = (1.0 - alpha) / a0;
+    }
+
+    /* Switching a section on or off changes what every later section
+     * sees, so the whole chain restarts from the steady state. */
+    if (m_enabled != wasEnabled)
+        m_needsPrime = true;
+}
+
+// ============================================================================
+// Streaming
+// ============================================================================
+
+void EegFilterBank::prime(const double* row)
+{
+    /* Steady state of a TDF-II section for constant input x with DC gain
+     * G = (b0+b1+b2)/(1+a1+a2):  y = G·x,  z2 = b2·x − a2·y,
+     * z1 = b1·x − a1·y + z2. The next section sees y as its input. */
+    std::vector<double> x(row, row + m_channels);
+    for (int slot = 0; slot < SlotCount; ++slot)
+    {
+        if (!m_enabled[slot])
+            continue;
+
+        const Biquad& c = m_coeffs[slot];
+        const double gain = (c.b0 + c.b1 + c.b2) / (1.0 + c.a1 + c.a2);
+        double* z1 = m_z1.data() + static_cast<size_t>(slot) * m_channels;
+        double* z2 = m_z2.data() + static_cast<size_t>(slot) * m_channels;
+        for (int ch = 0; ch < m_channels; ++ch)
+        {
+            const double y = gain * x[ch];
+            z2[ch] = c.b2 * x[ch] - c.a2 * y;
+            z1[ch] = c.b1 * x[ch] - c.a1 * y + z2[ch];
+            x[ch] = y;
+        }
+    }
+    m_needsPrime = false;
+}
+
+void EegFilterBank::process(const float* in, float* out, int rows, int channels)
+{
+    if (rows <= 0 || channels <= 0)
+        return;
+
+    if (channels != m_channels)
+    {
+        m_channels = channels;
+        m_z1.assign(static_cast<size_t>(SlotCount) * channels, 0.0);
+        m_z2.assign(static_cast<size_t>(SlotCount) * channels, 0.0);
+        m_row.assign(channels, 0.0);
+        m_needsPrime = true;
+    }
+
+    double* v = m_row.data();
+    for (int r = 0; r < rows; ++r)
+    {
+        const float* x = in + static_cast<size_t>(r) * channels;
+        float* y = out + static_cast<size_t>(r) * channels;
+
+        for (int ch = 0; ch < channels; ++ch)
+            v[ch] = static_cast<double>(x[ch]) + ANTI_DENORMAL;
+
+        if (r == 0 && m_needsPrime)
+            prime(v);
+
+        /* One section across the whole row: shared coefficients, unit
+         * stride over channels — the loop the compiler vectorizes. The
+         * three arrays never overlap; __restrict spares the runtime alias
+         * check in front of the vector loop. */
+        for (int slot = 0; slot < SlotCount; ++slot)
+        {
+            if (!m_enabled[slot])
+                continue;
+
+            const Biquad c = m_coeffs[slot];
+            double* __restrict z1 = m_z1.data() + static_cast<size_t>(slot) * channels;
+            double* __restrict z2 = m_z2.data() + static_cast<size_t>(slot) * channels;
+            double* __restrict acc = v;
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                const double xin = acc[ch];
+                const double yout = c.b0 * xin + z1[ch];
+                z1[ch] = c.b1 * xin - c.a1 * yout + z2[ch];
+                z2[ch] = c.b2 * xin - c.a2 * yout;
+                acc[ch] = yout;
+            }
+        }
+
+        for (int ch = 0; ch < channels; ++ch)
+            y[ch] = static_cast<float>(v[ch]);
+    }
+}
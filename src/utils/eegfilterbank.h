@@ -0,0 +1,127 @@
+/*
+ * ==========================================================================
+ *  eegfilterbank.h — Streaming Per-Channel IIR Filters for the Display
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    The clinical review filters — high-pass (e.g. 0.5 Hz), low-pass
+ *    (35/70 Hz) and mains notch (50/60 Hz) — applied to every hardware
+ *    channel of each chunk before EegDisplayScaler. Display only: the
+ *    recording and the sync buffer keep the raw μV values.
+ *
+ *  FILTER CHAIN (one biquad cascade, same coefficients for all channels):
+ *
+ *    slot 0  HighPass   2nd-order Butterworth (Q = 0.7071)
+ *    slot 1  LowPass    4th-order Butterworth = two biquads
+ *    slot 2  LowPass    (Q = 0.5412 and 1.3066)
+ *    slot 3  Notch      RBJ notch, Q = NOTCH_Q (≈ 1.7 Hz wide at 50 Hz)
+ *
+ *    Coefficients are the RBJ Audio-EQ-Cookbook designs. Sections run in
+ *    transposed direct form II in double precision: a 0.5 Hz high-pass at
+ *    2 kHz puts its poles within 2·10⁻³ of the unit circle, where float
+ *    state visibly drifts.
+ *
+ *  STRUCTURE-OF-ARRAYS STATE:
+ *    State is stored per slot as one contiguous array over channels:
+ *
+ *      m_z1[slot * channels + ch],  m_z2[slot * channels + ch]
+ *
+ *    The input chunk is interleaved ([sample][channel]), so each row is
+ *    already a contiguous vector of channels. process() runs one section
+ *    over a whole row at a time — the inner loop is over channels with
+ *    shared coefficients and unit-stride state, which the compiler turns
+ *    into packed SIMD (2–4 channels per instruction). The recursion along
+ *    time stays scalar per channel, as it must.
+ *
+ *  RUNTIME CHANGES:
+ *    setSettings() recomputes coefficients in place; state is kept, so a
+ *    cutoff change does not blank or reset the display (a short transient
+ *    is expected). When a filter is switched on or off, and on the first
+ *    chunk or after a channel-count or sampling-rate change, the chain is
+ *    primed to the steady state of the next input row instead — so the
+ *    large DC offset of a typical amplifier does not ring through the
+ *    high-pass for seconds.
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++ so bench/eegfilterbank_bench.cpp can build it standalone.
+ *
+ *  THREAD SAFETY:
+ *    None — owned and used by EegBackend on the main thread.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGFILTERBANK_H
+#define EEGFILTERBANK_H
+
+#include <array>
+#include <vector>
+
+class EegFilterBank
+{
+public:
+    /* Cutoff frequencies in Hz; 0 disables the filter. */
+    struct Settings
+    {
+        double highPassHz = 0.5;
+        double lowPassHz  = 70.0;
+        double notchHz    = 50.0;
+    };
+
+    EegFilterBank();
+
+    const Settings& settings() const { return m_settings; }
+    void setSettings(const Settings& settings);
+
+    double samplingRate() const { return m_samplingRate; }
+    void setSamplingRate(double samplingRate);
+
+    /* True if at least one section is enabled for the current rate. */
+    bool isActive() const;
+
+    /* Forgets all filter state; the next row primes every section. */
+    void reset();
+
+    /* Filters `rows` interleaved rows of `channels` floats from `in` to
+     * `out` (may be the same buffer). A channel-count change resets state. */
+    void process(const float* in, float* out, int rows, int channels);
+
+    static constexpr double NOTCH_Q = 30.0;
+
+private:
+    enum Slot { HighPass, LowPass1, LowPass2, Notch, SlotCount };
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0;
+        double a1 = 0.0, a2 = 0.0;      // a0 normalized to 1
+    };
+
+    /* Recomputes every slot from m_settings and m_samplingRate. If the
+     * set of enabled slots changed, flags the chain for priming. */
+    void design();
+
+    /* Sets the state of every enabled slot to the steady state for a
+     * constant input equal to `row`, cascading the DC gain through the
+     * chain. */
+    void prime(const double* row);
+
+    Settings m_settings;
+    double m_samplingRate = 0.0;
+    int m_channels = 0;
+
+    std::array<Biquad, SlotCount> m_coeffs{};
+    std::array<bool, SlotCount> m_enabled{};
+    bool m_needsPrime = true;
+
+    std::vector<double> m_z1;           // [slot * m_channels + ch]
+    std::vector<double> m_z2;
+    std::vector<double> m_row;          // Current row, widened to double
+
+    /* Added to every input so that decaying state never reaches
+     * subnormal doubles (which are ~100× slower) on a silent channel.
+     * 10⁻²⁰ μV is far below any display resolution. */
+    static constexpr double ANTI_DENORMAL = 1e-20;
+};
+
+#endif // EEGFILTERBANK_H
@@ -0,0 +1,210 @@
+/*
+ * ==========================================================================
+ *  eeginterpkernel.cpp — Vectorized Multi-Channel Interpolation Implementation
+ * ==========================================================================
+ *  See eeginterpkernel.h for the formula, the weights and the dispatch.
+ * ==========================================================================
+ */
+
+#include "eeginterpkernel.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define EEG_INTERP_X86 1
+#  include <immintrin.h>
+#endif
+
+#if defined(EEG_INTERP_X86) && (defined(__GNUC__) || defined(__clang__))
+#  define EEG_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define EEG_TARGET_AVX2   // MSVC accepts AVX2 intrinsics without /arch
+#endif
+
+namespace EegInterpKernel {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr int LANCZOS_A = 3;
+
+double sinc(double x)
+{
+    if (std::abs(x) < 1e-12)
+        return 1.0;
+    return std::sin(PI * x) / (PI * x);
+}
+
+void weightedRowsScalar(const float* const* rows, const float* weights, int taps,
+                        int channels, float* out)
+{
+    for (int c = 0; c < channels; ++c)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; ++k)
+            sum = sum + weights[k] * rows[k][c];
+        out[c] = sum;
+    }
+}
+
+#ifdef EEG_INTERP_X86
+
+void weightedRowsSse2(const float* const* rows, const float* weights, int taps,
+                      int channels, float* out)
+{
+    int c = 0;
+    for (; c + 4 <= channels; c += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; ++k)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + c)));
+        _mm_storeu_ps(out + c, sum);
+    }
+    for (; c < channels; ++c)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; ++k)
+            sum = sum + weights[k] * rows[k][c];
+        out[c] = sum;
+    }
+}
+
+EEG_TARGET_AVX2
+void weightedRowsAvx2(const float* const* rows, const float* weights, int taps,
+                      int channels, float* out)
+{
+    int c = 0;
+    for (; c + 8 <= channels; c += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        for (int k = 0; k < taps; ++k)
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + c)));
+        _mm256_storeu_ps(out + c, sum);
+    }
+    /* Tail inline rather than via weightedRowsSse2: GCC tail-calls it
+     * without a vzeroupper, and the legacy-SSE code after it then pays
+     * the AVX transition penalty on every instruction. */
+    if (c + 4 <= channels)
+    {
+        __m128 sum = _mm_setzero_ps();
+        for (int k = 0; k < taps; ++k)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + c)));
+        _mm_storeu_ps(out + c, sum);
+        c += 4;
+    }
+    for (; c < channels; ++c)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < taps; ++k)
+            sum = sum + weights[k] * rows[k][c];
+        out[c] = sum;
+    }
+}
+
+#endif // EEG_INTERP_X86
+
+} // namespace
+
+int tapCount(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Cubic: return 4;
+    case Mode::Sinc: return 2 * LANCZOS_A;
+    case Mode::Linear: break;
+    }
+    return 2;
+}
+
+int firstTapOffset(Mode mode)
+{
+    return -tapCount(mode) / 2;
+}
+
+void weights(Mode mode, double t, float* weights)
+{
+    switch (mode)
+    {
+    case Mode::Linear:
+        weights[0] = static_cast<float>(1.0 - t);
+        weights[1] = static_cast<float>(t);
+        return;
+
+    case Mode::Cubic:
+    {
+        /* Catmull-Rom on rows r−2, r−1, r, r+1 with t measured from r−1. */
+        const double t2 = t * t;
+        const double t3 = t2 * t;
+        weights[0] = static_cast<float>(0.5 * (-t3 + 2.0 * t2 - t));
+        weights[1] = static_cast<float>(0.5 * (3.0 * t3 - 5.0 * t2 + 2.0));
+        weights[2] = static_cast<float>(0.5 * (-3.0 * t3 + 4.0 * t2 + t));
+        weights[3] = static_cast<float>(0.5 * (t3 - t2));
+        return;
+    }
+
+    case Mode::Sinc:
+    {
+        /* Tap k sits at row r−3+k, i.e. at distance t + 2 − k from the
+         * query. Normalizing keeps flat signals flat despite truncation. */
+        double raw[2 * LANCZOS_A];
+        double total = 0.0;
+        for (int k = 0; k < 2 * LANCZOS_A; ++k)
+        {
+            const double x = t + (LANCZOS_A - 1) - k;
+            raw[k] = std::abs(x) < LANCZOS_A ? sinc(x) * sinc(x / LANCZOS_A) : 0.0;
+            total += raw[k];
+        }
+        for (int k = 0; k < 2 * LANCZOS_A; ++k)
+            weights[k] = static_cast<float>(raw[k] / total);
+        return;
+    }
+    }
+}
+
+void weightedRows(const float* const* rows, const float* weights, int taps,
+                  int channels, float* out)
+{
+    weightedRows(EegScaleKernel::bestVariant(), rows, weights, taps, channels, out);
+}
+
+void weightedRows(Variant variant,
+                  const float* const* rows, const float* weights, int taps,
+                  int channels, float* out)
+{
+    if (channels <= 0 || taps <= 0)
+        return;
+
+#ifdef EEG_INTERP_X86
+    if (variant == Variant::Avx2 && EegScaleKernel::bestVariant() == Variant::Avx2)
+    {
+        weightedRowsAvx2(rows, weights, taps, channels, out);
+        return;
+    }
+    if (variant != Variant::Scalar)
+    {
+        weightedRowsSse2(rows, weights, taps, channels, out);
+        return;
+    }
+#else
+    (void)variant;
+#endif
+    weightedRowsScalar(rows, weights, taps, channels, out);
+}
+
+void weightedTaps(const float* planes, int planeStride,
+                  const int* slots, const float* weights, int taps,
+                  int channels, float* out)
+{
+    /* Memory-bound: one cache line per channel (see header), so a vector
+     * version has nothing to win. */
+    for (int c = 0; c < channels; ++c)
+    {
+        const float* plane = planes + static_cast<long long>(c) * planeStride;
+        float sum = 0.0f;
+        for (int k = 0; k < taps; ++k)
+            sum = sum + weights[k] * plane[slots[k]];
+        out[c] = sum;
+    }
+}
+
+} // namespace EegInterpKernel
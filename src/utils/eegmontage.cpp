@@ -0,0 +1,272 @@
+/*
+ * ==========================================================================
+ *  eegmontage.cpp — Sparse Re-Referencing Matrix Implementation
+ * ==========================================================================
+ *  See eegmontage.h for the representation and the built-in montages.
+ * ==========================================================================
+ */
+
+#include "eegmontage.h"
+
+#include <QHash>
+
+namespace {
+
+/* Canonical 10-20 name: upper case, no "EEG " prefix, no "-REF" suffix,
+ * 10-10 temporal names folded onto the classic ones. */
+QString normalizedLabel(const QString& label)
+{
+    QString name = label.trimmed().toUpper();
+    if (name.startsWith(QLatin1String("EEG")))
+        name = name.mid(3).trimmed();
+    const int dash = name.indexOf(QLatin1Char('-'));
+    if (dash > 0)
+        name.truncate(dash);
+    name.remove(QLatin1Char(' '));
+
+    if (name == QLatin1String("T7")) return QStringLiteral("T3");
+    if (name == QLatin1String("T8")) return QStringLiteral("T4");
+    if (name == QLatin1String("P7")) return QStringLiteral("T5");
+    if (name == QLatin1String("P8")) return QStringLiteral("T6");
+    return name;
+}
+
+/* Normalized label → hardware index, for the selected channels only. */
+QHash<QString, int> selectedByName(const QVector<int>& channels, const QStringList& labels)
+{
+    QHash<QString, int> byName;
+    for (int channel : channels)
+    {
+        if (channel >= 0 && channel < labels.size())
+            byName.insert(normalizedLabel(labels[channel]), channel);
+    }
+    return byName;
+}
+
+/* Longitudinal bipolar ("double banana"), in conventional display order. */
+constexpr const char* DOUBLE_BANANA[][2] = {
+    { "FP1", "F7" }, { "F7", "T3" }, { "T3", "T5" }, { "T5", "O1" },
+    { "FP2", "F8" }, { "F8", "T4" }, { "T4", "T6" }, { "T6", "O2" },
+    { "FP1", "F3" }, { "F3", "C3" }, { "C3", "P3" }, { "P3", "O1" },
+    { "FP2", "F4" }, { "F4", "C4" }, { "C4", "P4" }, { "P4", "O2" },
+    { "FZ", "CZ" },  { "CZ", "PZ" },
+};
+
+/* 10-20 electrodes on a unit grid (x: left → right, y: back → front),
+ * used to find Laplacian neighbours. */
+struct GridPosition
+{
+    const char* name;
+    int x;
+    int y;
+};
+
+constexpr GridPosition GRID_10_20[] = {
+    { "FP1", -1,  2 }, { "FP2",  1,  2 },
+    { "F7",  -2,  1 }, { "F3",  -1,  1 }, { "FZ",  0,  1 }, { "F4",  1,  1 }, { "F8",  2,  1 },
+    { "T3",  -2,  0 }, { "C3",  -1,  0 }, { "CZ",  0,  0 }, { "C4",  1,  0 }, { "T4",  2,  0 },
+    { "T5",  -2, -1 }, { "P3",  -1, -1 }, { "PZ",  0, -1 }, { "P4",  1, -1 }, { "T6",  2, -1 },
+    { "O1",  -1, -2 }, { "O2",   1, -2 },
+};
+
+const GridPosition* gridPosition(const QString& normalized)
+{
+    for (const GridPosition& position : GRID_10_20)
+    {
+        if (normalized == QLatin1String(position.name))
+            return &position;
+    }
+    return nullptr;
+}
+
+/* Edge electrodes have fewer than three direct neighbours; they also
+ * take the diagonal ones so the local mean is not a single channel. */
+constexpr int MIN_DIRECT_NEIGHBOURS = 3;
+
+} // namespace
+
+// ============================================================================
+// Built-in Montages
+// ============================================================================
+
+QString EegMontage::channelLabel(const QStringList& labels, int index)
+{
+    if (index >= 0 && index < labels.size())
+        return labels[index];
+    return QString("Ch %1").arg(index);
+}
+
+EegMontage EegMontage::referential(const QVector<int>& channels, const QStringList& labels)
+{
+    EegMontage montage;
+    for (int channel : channels)
+        montage.addDerivation(channelLabel(labels, channel), { { channel, 1.0f } });
+    return montage;
+}
+
+EegMontage EegMontage::commonAverage(const QVector<int>& channels, const QStringList& labels)
+{
+    EegMontage montage;
+    montage.setReferenceChannels(channels);
+    for (int channel : channels)
+        montage.addDerivation(channelLabel(labels, channel) + "-Avg", { { channel, 1.0f } }, 1.0f);
+    return montage;
+}
+
+EegMontage EegMontage::doubleBanana(const QVector<int>& channels, const QStringList& labels)
+{
+    const QHash<QString, int> byName = selectedByName(channels, labels);
+
+    EegMontage montage;
+    for (const auto& pair : DOUBLE_BANANA)
+    {
+        const auto first = byName.constFind(QLatin1String(pair[0]));
+        const auto second = byName.constFind(QLatin1String(pair[1]));
+        if (first == byName.constEnd() || second == byName.constEnd())
+            continue;
+
+        montage.addDerivation(labels[*first] + "-" + labels[*second],
+                              { { *first, 1.0f }, { *second, -1.0f } });
+    }
+    return montage;
+}
+
+EegMontage EegMontage::laplacian(const QVector<int>& channels, const QStringList& labels)
+{
+    const QHash<QString, int> byName = selectedByName(channels, labels);
+
+    EegMontage montage;
+    for (int channel : channels)
+    {
+        const QString label = channelLabel(labels, channel);
+        const GridPosition* centre = (channel >= 0 && channel < labels.size())
+            ? gridPosition(normalizedLabel(labels[channel])) : nullptr;
+
+        /* Channels off the 10-20 grid (EOG, ECG, extra electrodes) stay
+         * referential rather than disappearing from the display. */
+        std::vector<int> neighbours;
+        if (centre)
+        {
+            for (int maxDistanceSq : { 1, 2 })
+            {
+                neighbours.clear();
+                for (const GridPosition& other : GRID_10_20)
+                {
+                    const int dx = other.x - centre->x;
+                    const int dy = other.y - centre->y;
+                    const int distanceSq = dx * dx + dy * dy;
+                    const auto found = byName.constFind(QLatin1String(other.name));
+                    if (distanceSq > 0 && distanceSq <= maxDistanceSq && found != byName.constEnd())
+                        neighbours.push_back(*found);
+                }
+                if (static_cast<int>(neighbours.size()) >= MIN_DIRECT_NEIGHBOURS)
+                    break;
+            }
+        }
+
+        if (neighbours.empty())
+        {
+            montage.addDerivation(label, { { channel, 1.0f } });
+            continue;
+        }
+
+        std::vector<Term> terms{ { channel, 1.0f } };
+        const float share = -1.0f / static_cast<float>(neighbours.size());
+        for (int neighbour : neighbours)
+            terms.push_back({ neighbour, share });
+        montage.addDerivation(label + "-Lap", terms);
+    }
+    return montage;
+}
+
+// ============================================================================
+// Construction & Queries
+// ============================================================================
+
+void EegMontage::addDerivation(const QString& label, const std::vector<Term>& terms,
+                               float referenceWeight)
+{
+    for (const Term& term : terms)
+    {
+        m_column.push_back(term.channel);
+        m_weight.push_back(term.weight);
+    }
+    m_rowStart.push_back(static_cast<int>(m_column.size()));
+    m_referenceWeight.push_back(referenceWeight);
+    m_labels.append(label);
+}
+
+void EegMontage::setReferenceChannels(const QVector<int>& channels)
+{
+    m_referenceChannels.assign(channels.cbegin(), channels.cend());
+}
+
+bool EegMontage::isPassThrough() const
+{
+    for (int d = 0; d < derivationCount(); ++d)
+    {
+        if (m_rowStart[d + 1] - m_rowStart[d] != 1
+            || m_weight[m_rowStart[d]] != 1.0f
+            || (m_referenceWeight[d] != 0.0f && !m_referenceChannels.empty()))
+            return false;
+    }
+    return true;
+}
+
+QVector<int> EegMontage::passThroughChannels() const
+{
+    QVector<int> channels;
+    channels.reserve(derivationCount());
+    for (int d = 0; d < derivationCount(); ++d)
+        channels.append(m_column[m_rowStart[d]]);
+    return channels;
+}
+
+// ============================================================================
+// Application
+// ============================================================================
+
+void EegMontage::applyRow(const float* row, int rowWidth, float* out) const
+{
+    /* Shared reference term, computed once for all derivations. */
+    float reference = 0.0f;
+    if (!m_referenceChannels.empty())
+    {
+        float sum = 0.0f;
+        int count = 0;
+        for (int channel : m_referenceChannels)
+        {
+            if (static_cast<unsigned>(channel) < static_cast<unsigned>(rowWidth))
+            {
+                sum += row[channel];
+                ++count;
+            }
+        }
+        reference = count > 0 ? sum / static_cast<float>(count) : 0.0f;
+    }
+
+    const int* column = m_column.data();
+    const float* weight = m_weight.data();
+    const int derivations = derivationCount();
+    for (int d = 0; d < derivations; ++d)
+    {
+        float value = 0.0f;
+        for (int k = m_rowStart[d]; k < m_rowStart[d + 1]; ++k)
+        {
+            if (static_cast<unsigned>(column[k]) < static_cast<unsigned>(rowWidth))
+                value += weight[k] * row[column[k]];
+        }
+        out[d] = value - m_referenceWeight[d] * reference;
+    }
+}
+
+void EegMontage::apply(const EegChunk& in, EegChunk& out) const
+{
+    const int derivations = derivationCount();
+    out.channelCount = derivations;
+    out.sampleCount = in.sampleCount;
+    out.samples.resize(static_cast<size_t>(derivations) * in.sampleCount);
+
+    for (int s = 0; s < in.sampleCount; ++s)
+        applyRow(in.row(s), in.channelCount, out.samples.data() + static_cast<size_t>(s) * derivations);
+}
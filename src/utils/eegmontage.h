@@ -0,0 +1,126 @@
+/*
+ * ==========================================================================
+ *  eegmontage.h — Sparse Re-Referencing Matrix for EEG Chunks
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    A montage turns the hardware (referential) channels of each sample
+ *    row into the derivations the user reviews: bipolar chains, common
+ *    average reference, Laplacian, or any custom linear combination.
+ *    It is applied on the display path (EegBackend) and at ingest of the
+ *    sync buffer (EegSyncManager); the recording always keeps the raw
+ *    hardware channels.
+ *
+ *  REPRESENTATION:
+ *    derivation[d] = Σ weight[k] · row[column[k]]      k ∈ CSR row d
+ *                    − referenceWeight[d] · mean(row[referenceChannels])
+ *
+ *    The sparse part is CSR (m_rowStart / m_column / m_weight) with one
+ *    to a handful of terms per derivation: 1 for referential, 2 for
+ *    bipolar, 1 + neighbours for Laplacian. The common reference is kept
+ *    as a separate rank-1 term: the row mean is computed once per sample
+ *    and shared by every derivation, so an average montage over N
+ *    channels costs ~2N operations per row instead of the N² of a dense
+ *    matrix row per derivation.
+ *
+ *  BUILT-IN MONTAGES (from the user's channel selection + amplifier labels):
+ *    referential()    selected channels as-is (the pass-through case)
+ *    commonAverage()  each selected channel minus the selection mean
+ *    doubleBanana()   the 18 longitudinal bipolar pairs of the 10-20
+ *                     system (Fp1-F7 … Cz-Pz) among the selected channels
+ *    laplacian()      each selected channel minus the mean of its
+ *                     nearest 10-20 neighbours that are also selected
+ *
+ *    Labels are matched case-insensitively, ignoring an "EEG " prefix and
+ *    a "-REF"-style suffix; old and new temporal names are aliases
+ *    (T3/T7, T4/T8, T5/P7, T6/P8).
+ *
+ *  PASS-THROUGH:
+ *    When every derivation is a single hardware channel with weight 1 and
+ *    no reference, isPassThrough() is true and callers skip apply()
+ *    entirely, gathering passThroughChannels() straight from the chunk.
+ *
+ *  THREAD SAFETY:
+ *    Immutable once built. Shared as std::shared_ptr<const EegMontage>;
+ *    switching montage swaps the pointer, never mutates a live instance.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGMONTAGE_H
+#define EEGMONTAGE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "eegchunk.h"
+
+class EegMontage
+{
+public:
+    struct Term
+    {
+        int channel = -1;       // Hardware channel index
+        float weight = 0.0f;
+    };
+
+    // --- Built-in montages ---
+
+    /* `channels` are hardware indices in display order; `labels` is the
+     * amplifier's full channel label list (may be empty → "Ch N"). */
+    static EegMontage referential(const QVector<int>& channels, const QStringList& labels);
+    static EegMontage commonAverage(const QVector<int>& channels, const QStringList& labels);
+    static EegMontage doubleBanana(const QVector<int>& channels, const QStringList& labels);
+    static EegMontage laplacian(const QVector<int>& channels, const QStringList& labels);
+
+    // --- Construction (built-ins and custom montages) ---
+
+    /* Appends one derivation. `referenceWeight` scales the common
+     * reference term (see setReferenceChannels). */
+    void addDerivation(const QString& label, const std::vector<Term>& terms,
+                       float referenceWeight = 0.0f);
+
+    /* Hardware channels averaged into the common reference. */
+    void setReferenceChannels(const QVector<int>& channels);
+
+    // --- Queries ---
+
+    int derivationCount() const { return static_cast<int>(m_labels.size()); }
+    bool isEmpty() const { return m_labels.isEmpty(); }
+    const QStringList& labels() const { return m_labels; }
+
+    /* True if apply() would only copy single channels (see header). */
+    bool isPassThrough() const;
+
+    /* Source channel of each derivation; only meaningful if isPassThrough(). */
+    QVector<int> passThroughChannels() const;
+
+    // --- Application ---
+
+    /* Computes all derivations of one interleaved row of `rowWidth`
+     * hardware channels into out[0 .. derivationCount()). Terms naming a
+     * channel outside the row contribute 0. */
+    void applyRow(const float* row, int rowWidth, float* out) const;
+
+    /* Applies the montage to every row of `in`; `out` becomes an
+     * interleaved chunk of derivationCount() channels. Timestamps are not
+     * copied — the display path does not use them. */
+    void apply(const EegChunk& in, EegChunk& out) const;
+
+    /* Label for hardware channel `index`, or "Ch N" if unknown. */
+    static QString channelLabel(const QStringList& labels, int index);
+
+private:
+    std::vector<int> m_rowStart{0};         // CSR row pointers, derivationCount() + 1
+    std::vector<int> m_column;              // Hardware channel per term
+    std::vector<float> m_weight;            // Weight per term
+    std::vector<float> m_referenceWeight;   // Per derivation
+    std::vector<int> m_referenceChannels;   // Averaged into the common reference
+    QStringList m_labels;
+};
+
+using EegMontagePtr = std::shared_ptr<const EegMontage>;
+
+#endif // EEGMONTAGE_H
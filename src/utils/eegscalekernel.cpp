@@ -0,0 +1,218 @@
+/*
+ * ==========================================================================
+ *  eegscalekernel.cpp — Vectorized μV → Display Transform Implementation
+ * ==========================================================================
+ *  See eegscalekernel.h for the formula and the dispatch scheme.
+ * ==========================================================================
+ */
+
+#include "eegscalekernel.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define EEG_SCALE_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#  endif
+#endif
+
+#if defined(EEG_SCALE_X86) && (defined(__GNUC__) || defined(__clang__))
+#  define EEG_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define EEG_TARGET_AVX2   // MSVC accepts AVX2 intrinsics without /arch
+#endif
+
+namespace EegScaleKernel {
+
+namespace {
+
+constexpr int MIN_VECTOR_ROWS = 4;
+
+/* Channels with no valid source column draw their flat baseline. */
+bool fillIfInvalid(int source, int stride, float offset, int count, float* out)
+{
+    if (source >= 0 && source < stride)
+        return false;
+    std::fill_n(out, count, offset);
+    return true;
+}
+
+void scaleScalar(const float* samples, int stride, int count,
+                 const int* source, const float* offset, float gain,
+                 int channels, float* const* out)
+{
+    for (int c = 0; c < channels; ++c)
+    {
+        if (fillIfInvalid(source[c], stride, offset[c], count, out[c]))
+            continue;
+        const float* in = samples + source[c];
+        float* dst = out[c];
+        const float base = offset[c];
+        for (int s = 0; s < count; ++s)
+        {
+            dst[s] = base - in[static_cast<long long>(s) * stride] * gain;
+        }
+    }
+}
+
+#ifdef EEG_SCALE_X86
+
+void scaleSse2(const float* samples, int stride, int count,
+               const int* source, const float* offset, float gain,
+               int channels, float* const* out)
+{
+    const __m128 vGain = _mm_set1_ps(gain);
+    const long long rowStep = stride;
+
+    for (int c = 0; c < channels; ++c)
+    {
+        if (fillIfInvalid(source[c], stride, offset[c], count, out[c]))
+            continue;
+        const float* in = samples + source[c];
+        float* dst = out[c];
+        const __m128 vBase = _mm_set1_ps(offset[c]);
+
+        int s = 0;
+        for (; s + 4 <= count; s += 4)
+        {
+            const float* row = in + s * rowStep;
+            const __m128 raw = _mm_setr_ps(row[0], row[rowStep],
+                                           row[2 * rowStep], row[3 * rowStep]);
+            _mm_storeu_ps(dst + s, _mm_sub_ps(vBase, _mm_mul_ps(raw, vGain)));
+        }
+        for (; s < count; ++s)
+        {
+            dst[s] = offset[c] - in[s * rowStep] * gain;
+        }
+    }
+}
+
+EEG_TARGET_AVX2
+void scaleAvx2(const float* samples, int stride, int count,
+               const int* source, const float* offset, float gain,
+               int channels, float* const* out)
+{
+    /* Lane index table: the 8 rows of one step, relative to the first.
+     * Gathers address with 32-bit indices, so rows are walked by advancing
+     * the base pointer and the table stays small. */
+    const __m256i lanes = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                             _mm256_set1_epi32(stride));
+    const __m256 vGain = _mm256_set1_ps(gain);
+    const long long rowStep = stride;
+
+    for (int c = 0; c < channels; ++c)
+    {
+        if (fillIfInvalid(source[c], stride, offset[c], count, out[c]))
+            continue;
+        const float* in = samples + source[c];
+        float* dst = out[c];
+        const __m256 vBase = _mm256_set1_ps(offset[c]);
+
+        int s = 0;
+        for (; s + 8 <= count; s += 8)
+        {
+            const __m256 raw = _mm256_i32gather_ps(in + s * rowStep, lanes, 4);
+            _mm256_storeu_ps(dst + s, _mm256_sub_ps(vBase, _mm256_mul_ps(raw, vGain)));
+        }
+        /* Low-latency chunks are often only a few rows: take a 4-wide
+         * step before the scalar tail so they are not all tail. */
+        if (s + 4 <= count)
+        {
+            const __m128 raw = _mm_i32gather_ps(in + s * rowStep, _mm256_castsi256_si128(lanes), 4);
+            _mm_storeu_ps(dst + s, _mm_sub_ps(_mm256_castps256_ps128(vBase),
+                                              _mm_mul_ps(raw, _mm256_castps256_ps128(vGain))));
+            s += 4;
+        }
+        for (; s < count; ++s)
+        {
+            dst[s] = offset[c] - in[s * rowStep] * gain;
+        }
+    }
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6)      // OS saves XMM and YMM state
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // EEG_SCALE_X86
+
+} // namespace
+
+Variant bestVariant()
+{
+#ifdef EEG_SCALE_X86
+    static const Variant best = cpuHasAvx2() ? Variant::Avx2 : Variant::Sse2;
+    return best;
+#else
+    return Variant::Scalar;
+#endif
+}
+
+const char* variantName(Variant variant)
+{
+    switch (variant)
+    {
+    case Variant::Avx2: return "avx2";
+    case Variant::Sse2: return "sse2";
+    case Variant::Scalar: break;
+    }
+    return "scalar";
+}
+
+void scaleGather(const float* samples, int stride, int count,
+                 const int* source, const float* offset, float gain,
+                 int channels, float* const* out)
+{
+    /* The vector paths work along the samples of one channel, so chunks
+     * of a few rows (latency-optimized acquisition often delivers one)
+     * only pay their setup cost; the scalar loop is faster there. */
+    const Variant variant = count < MIN_VECTOR_ROWS ? Variant::Scalar : bestVariant();
+    scaleGather(variant, samples, stride, count, source, offset, gain, channels, out);
+}
+
+void scaleGather(Variant variant,
+                 const float* samples, int stride, int count,
+                 const int* source, const float* offset, float gain,
+                 int channels, float* const* out)
+{
+    if (count <= 0 || channels <= 0)
+        return;
+
+#ifdef EEG_SCALE_X86
+    if (variant == Variant::Avx2 && bestVariant() == Variant::Avx2)
+    {
+        scaleAvx2(samples, stride, count, source, offset, gain, channels, out);
+        return;
+    }
+    if (variant != Variant::Scalar)
+    {
+        scaleSse2(samples, stride, count, source, offset, gain, channels, out);
+        return;
+    }
+#else
+    (void)variant;
+#endif
+    scaleScalar(samples, stride, count, source, offset, gain, channels, out);
+}
+
+} // namespace EegScaleKernel
@@ -0,0 +1,77 @@
+/*
+ * ==========================================================================
+ *  eegscalekernel.h — Vectorized μV → Display Transform for EEG Chunks
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    The arithmetic core of EegDisplayScaler. For every selected channel c
+ *    and sample s of an interleaved chunk it computes
+ *
+ *      out[c][s] = offset[c] - samples[s * stride + source[c]] * gain
+ *
+ *    and stores float32 results straight into per-channel destination
+ *    runs (the EegDataModel ring). This replaces a loop that converted one
+ *    value at a time to double and appended it to a QVector<double> per
+ *    channel, which EegDataModel then converted back to float.
+ *
+ *  VARIANTS (runtime dispatch):
+ *    Avx2    8 samples per step. The channel gather uses
+ *            _mm256_i32gather_ps with a precomputed lane index table
+ *            {0, stride, …, 7·stride} + source[c].
+ *    Sse2    4 samples per step; the gather is four scalar loads, the
+ *            multiply-subtract and store are vector ops. Baseline on
+ *            every x86-64 CPU.
+ *    Scalar  Portable loop, used on non-x86 builds, for chunks shorter
+ *            than four rows (one-sample low-latency pushes), and for
+ *            verification.
+ *
+ *    bestVariant() picks the widest variant the CPU and OS support once
+ *    (CPUID + XGETBV on MSVC, __builtin_cpu_supports on GCC/Clang); the
+ *    AVX2 code is compiled with a per-function target attribute, so the
+ *    rest of the binary keeps the default instruction set. All variants
+ *    compute the same single-precision multiply then subtract (no FMA),
+ *    so their results are bit-identical.
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++ so bench/eegscalekernel_bench.cpp can build it standalone
+ *    (see VIDEOEEG_BUILD_BENCHMARKS in CMakeLists.txt).
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGSCALEKERNEL_H
+#define EEGSCALEKERNEL_H
+
+namespace EegScaleKernel {
+
+enum class Variant
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+/* Widest variant supported by this CPU, detected on first call. */
+Variant bestVariant();
+
+/* "scalar", "sse2" or "avx2" — for logs and the benchmark. */
+const char* variantName(Variant variant);
+
+/* Scales `count` interleaved rows starting at `samples` (row stride
+ * `stride` floats) into out[c][0 .. count) for c in [0, channels).
+ * source[c] < 0 or >= stride yields a flat line at offset[c].
+ * Uses bestVariant(), or Scalar for chunks under 4 rows. */
+void scaleGather(const float* samples, int stride, int count,
+                 const int* source, const float* offset, float gain,
+                 int channels, float* const* out);
+
+/* Same, forcing one variant (benchmark / verification). Falls back to
+ * Scalar when the requested variant is not compiled in. */
+void scaleGather(Variant variant,
+                 const float* samples, int stride, int count,
+                 const int* source, const float* offset, float gain,
+                 int channels, float* const* out);
+
+} // namespace EegScaleKernel
+
+#endif // EEGSCALEKERNEL_H
@@ -0,0 +1,444 @@
+/*
+ * ==========================================================================
+ *  eegsyncring.h — Single-Writer / Multi-Reader Ring for the Sync Buffer
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Storage behind EegSyncManager: the newest `capacity` timestamped rows
+ *    of `width` floats. One thread (the LSL worker, via the chunk
+ *    dispatcher) appends; any number of threads (video frame callbacks,
+ *    stats polling) read concurrently without ever blocking the writer.
+ *
+ *  LAYOUT (structure of arrays, allocated once):
+ *    m_timestamps  [slot]                        capacity doubles
+ *    m_samples     [channel * capacity + slot]   capacity × width floats
+ *    m_recent      [recentSlot * width + channel]  recentCapacity × width
+ *
+ *    Timestamps are one contiguous array, so lowerBound() is a plain
+ *    std::lower_bound over at most two spans (before / after the wrap
+ *    point). Samples are channel-major: each channel's history is one
+ *    contiguous run, which is what range reads and multi-sample
+ *    interpolation walk. Appending only overwrites slots — there is no
+ *    allocation after construction apart from the writer's staging row
+ *    growing to the largest chunk once.
+ *
+ *    m_recent mirrors the newest recentCapacity() rows row-major (slot
+ *    row % recentCapacity), copied straight from the writer's row-major
+ *    staging block. Interpolating a whole row reads K contiguous rows
+ *    there instead of one cache line per channel from the planes (see
+ *    eeginterpkernel.h); video frame lookups land in this window.
+ *
+ *  ALGORITHM (seqlock over a free-running row counter):
+ *    Rows are numbered 0, 1, 2, … forever; row r lives in slot r % capacity
+ *    and is destroyed by the write of row r + capacity. Two counters:
+ *
+ *      m_claimed    rows the writer has started writing (end, exclusive)
+ *      m_published  rows that are complete and visible (end, exclusive)
+ *
+ *    Writer:  claimed = end            (relaxed)
+ *             fence(release)
+ *             write rows [published, end)
+ *             published = end          (release)
+ *
+ *    Reader:  window() → rows [claimed − capacity, published)
+ *             read any rows in the window
+ *             validate(firstRowRead): fence(acquire), then check that
+ *             claimed − capacity ≤ firstRowRead — i.e. no row the reader
+ *             touched was claimed for overwrite meanwhile. If that fails,
+ *             the reader discards what it read and tries again.
+ *
+ *    Readers only retry when a write overtakes the oldest row they looked
+ *    at — with a 30 s ring and queries near the newest data, a write has
+ *    to land during the few microseconds of the query itself. The writer
+ *    never waits for anyone.
+ *
+ *    As in every seqlock the reader's payload loads race with the writer;
+ *    a torn value can only come from a row that validate() then rejects.
+ *    The recent window is overwritten sooner, so reads from it are checked
+ *    with validateRecent() instead, against recentCapacity().
+ *
+ *  TIMESTAMP → ROW (regular-sampling model):
+ *    Rows arrive at a near-constant rate, so the writer keeps a linear
+ *    model per gap-free segment: row = anchorRow + (ts − anchorTs) / step,
+ *    with step fitted over the segment. A row whose timestamp is off the
+ *    model by more than half a step (dropout, stream restart, heavy
+ *    jitter) starts a new segment; the newest MODEL_SEGMENTS segments are
+ *    kept. lowerBound() picks the segment starting at or before ts,
+ *    predicts the row and checks it with at most MAX_PREDICTION_STEPS
+ *    neighbour comparisons; only if that fails does it binary-search.
+ *    A prediction is always verified against the timestamps themselves,
+ *    so a stale or torn model costs speed, never correctness. Live
+ *    timestamps are dejittered at acquisition (eegtimestampdejitter.h),
+ *    so in practice only real gaps start a segment.
+ *
+ *  RESIZING:
+ *    Capacity and width are fixed per instance. EegSyncManager replaces
+ *    the whole ring (std::atomic_store of a shared_ptr) from the writer
+ *    thread when either changes; readers holding the old one finish on it.
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++, like spscring.h.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGSYNCRING_H
+#define EEGSYNCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class EegSyncRing
+{
+public:
+    /* Neighbour steps lowerBound() may take from the predicted row before
+     * it gives up and binary-searches. */
+    static constexpr int MAX_PREDICTION_STEPS = 2;
+
+    /* Gap-free segments remembered for prediction; queries older than the
+     * oldest of them binary-search. */
+    static constexpr int MODEL_SEGMENTS = 8;
+
+    /* Rows mirrored row-major for interpolation: 0.5 s at 2 kHz, 256 KB
+     * at 128 channels. Capped at the ring capacity. */
+    static constexpr int RECENT_ROWS = 1024;
+
+    /* Readable rows [first, end) at the moment window() was called. */
+    struct Window
+    {
+        std::uint64_t first = 0;
+        std::uint64_t end = 0;
+
+        bool isEmpty() const { return first >= end; }
+        std::uint64_t size() const { return end - first; }
+    };
+
+    EegSyncRing(int capacity, int width)
+        : m_capacity(static_cast<std::uint64_t>(std::max(1, capacity)))
+        , m_width(std::max(0, width))
+        , m_timestamps(m_capacity, 0.0)
+        , m_samples(m_capacity * static_cast<size_t>(m_width), 0.0f)
+        , m_recentCapacity(std::min<std::uint64_t>(m_capacity, RECENT_ROWS))
+        , m_recent(m_recentCapacity * static_cast<size_t>(m_width), 0.0f)
+        , m_staging(static_cast<size_t>(m_width))
+    {
+    }
+
+    EegSyncRing(const EegSyncRing&) = delete;
+    EegSyncRing& operator=(const EegSyncRing&) = delete;
+
+    int capacity() const { return static_cast<int>(m_capacity); }
+    int recentCapacity() const { return static_cast<int>(m_recentCapacity); }
+    int width() const { return m_width; }
+
+    // --- Writer (one thread only) ---
+
+    /* Appends `rows` rows. fill(i, out) writes row i's values into
+     * out[0 .. width()) and returns its timestamp. A chunk longer than the
+     * capacity keeps only its newest capacity() rows. */
+    template <typename Fill>
+    void append(int rows, Fill&& fill)
+    {
+        if (rows <= 0)
+            return;
+
+        /* Rows are produced row-major into the staging block (the montage
+         * and the chunk are row-major), then transposed into the channel
+         * planes below. */
+        const size_t needed = static_cast<size_t>(rows) * m_width;
+        if (m_staging.size() < needed)
+            m_staging.resize(needed);
+
+        const std::uint64_t skip = static_cast<std::uint64_t>(rows) > m_capacity
+            ? static_cast<std::uint64_t>(rows) - m_capacity : 0;
+        const std::uint64_t head = m_published.load(std::memory_order_relaxed);
+        const std::uint64_t end = head + static_cast<std::uint64_t>(rows);
+
+        m_claimed.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i = 0; i < rows; ++i)
+        {
+            const double ts = fill(i, m_staging.data() + static_cast<size_t>(i) * m_width);
+            if (static_cast<std::uint64_t>(i) >= skip)
+                m_timestamps[static_cast<size_t>((head + i) % m_capacity)] = ts;
+            fitRow(head + i, ts);
+        }
+
+        /* One contiguous run per channel and span (two spans at the wrap). */
+        std::uint64_t row = head + skip;
+        while (row < end)
+        {
+            const size_t slot = static_cast<size_t>(row % m_capacity);
+            const size_t span = static_cast<size_t>(std::min<std::uint64_t>(end - row, m_capacity - slot));
+            const float* from = m_staging.data() + static_cast<size_t>(row - head) * m_width;
+            for (int ch = 0; ch < m_width; ++ch)
+            {
+                float* plane = m_samples.data() + static_cast<size_t>(ch) * m_capacity + slot;
+                for (size_t i = 0; i < span; ++i)
+                    plane[i] = from[i * m_width + ch];
+            }
+            row += span;
+        }
+
+        /* Row-major mirror of the newest rows: whole staging rows. */
+        const size_t rowBytes = static_cast<size_t>(m_width) * sizeof(float);
+        row = std::max(head + skip, end > m_recentCapacity ? end - m_recentCapacity : 0);
+        for (; rowBytes > 0 && row < end; ++row)
+        {
+            std::memcpy(m_recent.data() + static_cast<size_t>(row % m_recentCapacity) * m_width,
+                        m_staging.data() + static_cast<size_t>(row - head) * m_width, rowBytes);
+        }
+
+        publishSegment();
+        m_published.store(end, std::memory_order_release);
+    }
+
+    /* Copies the newest rows of `source` (same width) into this empty
+     * ring, so a resize keeps as much history as fits. */
+    void appendNewestFrom(const EegSyncRing& source)
+    {
+        const Window window = source.window();
+        const std::uint64_t count = std::min(window.size(), m_capacity);
+        const std::uint64_t first = window.end - count;
+        append(static_cast<int>(count), [&](int i, float* out) {
+            std::fill_n(out, m_width, 0.0f);
+            source.copyRow(first + i, out, std::min(m_width, source.m_width));
+            return source.timestamp(first + i);
+        });
+    }
+
+    // --- Readers (any thread) ---
+
+    Window window() const
+    {
+        Window window;
+        window.end = m_published.load(std::memory_order_acquire);
+        const std::uint64_t claimed = m_claimed.load(std::memory_order_acquire);
+        window.first = claimed > m_capacity ? claimed - m_capacity : 0;
+        return window;
+    }
+
+    double timestamp(std::uint64_t row) const
+    {
+        return m_timestamps[static_cast<size_t>(row % m_capacity)];
+    }
+
+    float value(std::uint64_t row, int channel) const
+    {
+        return m_samples[static_cast<size_t>(channel) * m_capacity + static_cast<size_t>(row % m_capacity)];
+    }
+
+    /* Channel `channel`'s history, indexed by slot (row % capacity()). */
+    const float* channel(int channel) const
+    {
+        return m_samples.data() + static_cast<size_t>(channel) * m_capacity;
+    }
+
+    size_t slot(std::uint64_t row) const { return static_cast<size_t>(row % m_capacity); }
+
+    /* Gathers the first `channels` values of `row` into out. */
+    void copyRow(std::uint64_t row, float* out, int channels) const
+    {
+        const float* at = m_samples.data() + slot(row);
+        for (int ch = 0; ch < channels; ++ch)
+            out[ch] = at[static_cast<size_t>(ch) * m_capacity];
+    }
+
+    void copyRow(std::uint64_t row, float* out) const { copyRow(row, out, m_width); }
+
+    /* True if `row` may still be in the recent window — i.e. fewer than
+     * recentCapacity() rows were published after it when `window` was
+     * taken. Reads through recentRow() must then pass validateRecent(). */
+    bool inRecent(const Window& window, std::uint64_t row) const
+    {
+        return row + m_recentCapacity > window.end;
+    }
+
+    /* `row`'s width() values, contiguous. Only meaningful for rows that
+     * inRecent() accepts. */
+    const float* recentRow(std::uint64_t row) const
+    {
+        return m_recent.data() + static_cast<size_t>(row % m_recentCapacity) * m_width;
+    }
+
+    /* Copies `count` consecutive rows of one channel, starting at
+     * `firstRow`, into out[0 .. count) — at most two contiguous copies. */
+    void copyChannel(int channel, std::uint64_t firstRow, size_t count, float* out) const
+    {
+        const float* plane = this->channel(channel);
+        const size_t first = slot(firstRow);
+        const size_t head = std::min(count, static_cast<size_t>(m_capacity) - first);
+        std::copy_n(plane + first, head, out);
+        std::copy_n(plane, count - head, out + head);
+    }
+
+    /* First row in [window.first, window.end) with timestamp >= ts
+     * (window.end if none). O(1) when the regular-sampling model holds
+     * around ts (see header); `predicted`, if given, reports whether it
+     * did. Otherwise falls back to binarySearch(). */
+    std::uint64_t lowerBound(const Window& window, double ts, bool* predicted = nullptr) const
+    {
+        if (predicted)
+            *predicted = false;
+        if (window.isEmpty())
+            return window.end;
+
+        const Segment* segment = segmentFor(ts);
+        const double step = segment ? segment->step.load(std::memory_order_relaxed) : 0.0;
+        if (step > 0.0)
+        {
+            /* Clamp in floating point first: ts may be far outside the
+             * window (or garbage from a torn model). */
+            const double offset = std::ceil((ts - segment->ts.load(std::memory_order_relaxed)) / step);
+            const double guess = static_cast<double>(segment->row.load(std::memory_order_relaxed)) + offset;
+            std::uint64_t row = window.first;
+            if (guess >= static_cast<double>(window.end))
+                row = window.end;
+            else if (guess > static_cast<double>(window.first))
+                row = static_cast<std::uint64_t>(guess);
+
+            for (int steps = 0; steps <= MAX_PREDICTION_STEPS; ++steps)
+            {
+                if (row > window.first && timestamp(row - 1) >= ts)
+                    --row;
+                else if (row < window.end && timestamp(row) < ts)
+                    ++row;
+                else
+                {
+                    if (predicted)
+                        *predicted = true;
+                    return row;
+                }
+            }
+        }
+        return binarySearch(window, ts);
+    }
+
+    /* lowerBound() without the model. The window covers at most two
+     * contiguous spans of m_timestamps; the split point decides which one
+     * to search. */
+    std::uint64_t binarySearch(const Window& window, double ts) const
+    {
+        if (window.isEmpty())
+            return window.end;
+
+        const double* base = m_timestamps.data();
+        const size_t firstSlot = slot(window.first);
+        const std::uint64_t firstSpan = std::min<std::uint64_t>(window.size(), m_capacity - firstSlot);
+        const std::uint64_t wrapRow = window.first + firstSpan;   // First row of the second span
+
+        if (wrapRow < window.end && base[0] < ts)
+        {
+            const size_t secondSpan = static_cast<size_t>(window.end - wrapRow);
+            return wrapRow + static_cast<std::uint64_t>(std::lower_bound(base, base + secondSpan, ts) - base);
+        }
+        const double* from = base + firstSlot;
+        return window.first + static_cast<std::uint64_t>(
+            std::lower_bound(from, from + firstSpan, ts) - from);
+    }
+
+    /* True if nothing at or after `firstRowRead` has been claimed for
+     * overwrite since it was read — the reader's copies are consistent. */
+    bool validate(std::uint64_t firstRowRead) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_claimed.load(std::memory_order_relaxed) <= firstRowRead + m_capacity;
+    }
+
+    /* validate() for reads through recentRow(): nothing at or after
+     * `firstRowRead` was claimed for overwrite in the recent window. */
+    bool validateRecent(std::uint64_t firstRowRead) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_claimed.load(std::memory_order_relaxed) <= firstRowRead + m_recentCapacity;
+    }
+
+private:
+    struct Segment
+    {
+        std::atomic<std::uint64_t> row{0};  // Anchor row
+        std::atomic<double> ts{0.0};        // Anchor timestamp
+        std::atomic<double> step{0.0};      // Fitted interval (0 = not enough rows yet)
+    };
+
+    /* Newest published segment whose anchor is at or before ts, else the
+     * oldest one kept (prediction may still land if ts is just before it). */
+    const Segment* segmentFor(double ts) const
+    {
+        const std::uint64_t count = m_segmentCount.load(std::memory_order_acquire);
+        const std::uint64_t kept = std::min<std::uint64_t>(count, MODEL_SEGMENTS);
+        const Segment* segment = nullptr;
+        for (std::uint64_t k = 1; k <= kept; ++k)
+        {
+            segment = &m_segments[(count - k) % MODEL_SEGMENTS];
+            if (segment->ts.load(std::memory_order_relaxed) <= ts)
+                break;
+        }
+        return segment;
+    }
+
+    /* Writer only: copies the open segment into its slot of m_segments. */
+    void publishSegment()
+    {
+        if (!m_hasSegment)
+            return;
+        Segment& segment = m_segments[(m_segmentCount.load(std::memory_order_relaxed) - 1) % MODEL_SEGMENTS];
+        segment.row.store(m_segmentRow, std::memory_order_relaxed);
+        segment.ts.store(m_segmentTs, std::memory_order_relaxed);
+        segment.step.store(m_segmentStep, std::memory_order_relaxed);
+    }
+
+    /* Writer only: extends the current gap-free segment with (row, ts), or
+     * starts a new one if ts is off the segment's model by half a step. */
+    void fitRow(std::uint64_t row, double ts)
+    {
+        if (m_hasSegment)
+        {
+            const double rows = static_cast<double>(row - m_segmentRow);
+            const double step = m_segmentStep > 0.0 ? m_segmentStep : (ts - m_segmentTs) / rows;
+            const double expected = m_segmentTs + rows * step;
+            if (step > 0.0 && std::abs(ts - expected) <= 0.5 * step)
+            {
+                /* Endpoint fit: the segment's mean interval so far. */
+                m_segmentStep = (ts - m_segmentTs) / rows;
+                return;
+            }
+        }
+        publishSegment();   // Close the previous segment with its final fit
+        m_segmentRow = row;
+        m_segmentTs = ts;
+        m_segmentStep = 0.0;
+        m_hasSegment = true;
+        m_segmentCount.fetch_add(1, std::memory_order_release);
+    }
+
+    const std::uint64_t m_capacity;
+    const int m_width;
+    std::vector<double> m_timestamps;   // [slot]
+    std::vector<float> m_samples;       // [channel * capacity + slot]
+    const std::uint64_t m_recentCapacity;
+    std::vector<float> m_recent;        // [(row % recentCapacity) * width + channel]
+    std::vector<float> m_staging;       // Writer only: row-major rows of the chunk being appended
+
+    /* Regular-sampling model: the writer's open segment, and the copies
+     * readers see (published with each append; readers verify every
+     * prediction, so the fields need not be read consistently). */
+    std::uint64_t m_segmentRow = 0;
+    double m_segmentTs = 0.0;
+    double m_segmentStep = 0.0;
+    bool m_hasSegment = false;
+    Segment m_segments[MODEL_SEGMENTS];
+    std::atomic<std::uint64_t> m_segmentCount{0};   // Segments ever started
+
+    /* Separate cache lines: readers poll both, only the writer stores. */
+    alignas(64) std::atomic<std::uint64_t> m_claimed{0};
+    alignas(64) std::atomic<std::uint64_t> m_published{0};
+};
+
+#endif // EEGSYNCRING_H
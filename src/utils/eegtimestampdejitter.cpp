@@ -0,0 +1,193 @@
+/*
+ * ==========================================================================
+ *  eegtimestampdejitter.cpp — Online Dejittering of LSL Sample Timestamps
+ * ==========================================================================
+ *  See eegtimestampdejitter.h for the model and the RLS update.
+ * ==========================================================================
+ */
+
+#include "eegtimestampdejitter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/* Initial covariance. The intercept starts at the first timestamp and is
+ * free to move; the period starts at the nominal one with a few percent
+ * of uncertainty, so early jitter cannot throw the slope far off. */
+constexpr double INITIAL_P_OFFSET = 1.0;
+constexpr double INITIAL_P_PERIOD_RELATIVE = 1e-2;
+
+/* Smoothing of the residual RMS statistic (per sample). Until it has
+ * seen enough samples it is a running mean, started from a prior of a
+ * typical LSL push jitter worth PRIOR_SAMPLES samples, so the gap
+ * tolerance starts loose rather than flagging the first chunks. */
+constexpr double RESIDUAL_SMOOTHING = 1e-3;
+constexpr double INITIAL_JITTER_SEC = 5e-3;
+constexpr double PRIOR_SAMPLES = 32.0;
+
+/* Level-shift detector: mean residual over about SHIFT_WINDOW_SEC,
+ * compared with SHIFT_SIGMAS times its own RMS (tracked SHIFT_RMS_SLOWDOWN
+ * times slower than the residual RMS, so a shift cannot hide itself). */
+constexpr double SHIFT_WINDOW_SEC = 0.5;
+constexpr double SHIFT_SIGMAS = 6.0;
+constexpr double SHIFT_RMS_SLOWDOWN = 10.0;
+
+} // namespace
+
+void EegTimestampDejitter::reset(double nominalRate)
+{
+    m_nominalRate = nominalRate > 0.0 ? nominalRate : 0.0;
+    m_lambda = isEnabled() ? std::pow(0.5, 1.0 / (HALF_LIFE_SEC * m_nominalRate)) : 1.0;
+    m_shiftSmoothing = isEnabled() ? std::min(1.0, 1.0 / (SHIFT_WINDOW_SEC * m_nominalRate)) : 1.0;
+    m_started = false;
+    m_pendingLost = 0.0;
+    m_residualMeanSq = INITIAL_JITTER_SEC * INITIAL_JITTER_SEC;
+    m_residualSamples = 0.0;
+    m_shiftMeanSq = INITIAL_JITTER_SEC * INITIAL_JITTER_SEC;
+    m_gapResets = 0;
+    m_bridgedGaps = 0;
+}
+
+double EegTimestampDejitter::residualRms() const
+{
+    return std::sqrt(m_residualMeanSq);
+}
+
+void EegTimestampDejitter::process(double* timestamps, size_t count)
+{
+    if (!isEnabled())
+        return;
+    for (size_t i = 0; i < count; ++i)
+        timestamps[i] = update(timestamps[i], i == 0);
+}
+
+double EegTimestampDejitter::tolerance(double periods) const
+{
+    return std::max(periods * m_w1, JITTER_TOLERANCE_SIGMAS * residualRms());
+}
+
+void EegTimestampDejitter::restart(double timestamp)
+{
+    const double period = 1.0 / m_nominalRate;
+    m_index = 0.0;
+    m_w0 = timestamp;
+    m_w1 = period;
+    m_p00 = INITIAL_P_OFFSET;
+    m_p01 = 0.0;
+    m_p11 = (period * INITIAL_P_PERIOD_RELATIVE) * (period * INITIAL_P_PERIOD_RELATIVE);
+    m_pendingLost = 0.0;
+    m_shift = 0.0;
+    m_started = true;
+}
+
+void EegTimestampDejitter::bridge(double lostSamples)
+{
+    // Skip the lost samples (if any), then move the anchor to the current sample
+    // and forget the intercept: w0 is the shifted prediction, the period
+    // and its covariance carry over.
+    m_index += lostSamples;
+    m_w0 += m_w1 * m_index;
+    m_index = 0.0;
+    m_p00 = INITIAL_P_OFFSET;
+    m_p01 = 0.0;
+    m_shift = 0.0;
+    if (lostSamples > 0.0)
+        ++m_bridgedGaps;
+}
+
+double EegTimestampDejitter::update(double timestamp, bool chunkStart)
+{
+    if (!m_started)
+    {
+        restart(timestamp);
+        return timestamp;
+    }
+
+    m_index += 1.0;
+
+    // An open gap is decided by the first sample of the next chunk: the
+    // samples of one chunk share its push latency and cannot confirm it.
+    if (m_pendingLost > 0.0)
+    {
+        if (!chunkStart)
+            return m_w0 + m_w1 * m_index;
+
+        const double error = timestamp - (m_w0 + m_w1 * m_index);
+        const double shiftedError = error - m_w1 * m_pendingLost;
+        if (std::fabs(shiftedError) < std::fabs(error)
+            && std::fabs(shiftedError) <= tolerance(GAP_TOLERANCE_PERIODS))
+            bridge(m_pendingLost);
+        m_pendingLost = 0.0;
+    }
+
+    double k = m_index;
+    double error = timestamp - (m_w0 + m_w1 * k);
+    if (!(std::fabs(error) <= tolerance(GAP_TOLERANCE_PERIODS)))
+    {
+        const double lost = std::round(error / m_w1);
+        const double phase = error - lost * m_w1;
+        if (lost >= 1.0 && lost * m_w1 <= MAX_BRIDGED_GAP_SEC
+            && std::fabs(phase) <= tolerance(PHASE_TOLERANCE_PERIODS))
+        {
+            // Until confirmed, the chunk stays on the unshifted line: a
+            // late chunk is far more common than a dropout, and a dropout
+            // costs this one chunk the gap length, never the fit.
+            m_pendingLost = lost;
+            return m_w0 + m_w1 * k;
+        }
+        ++m_gapResets;
+        restart(timestamp);
+        return timestamp;
+    }
+
+    // A loss within the jitter tolerance shows up as a persistent shift of
+    // the mean residual: bridge it like a confirmed gap. A shift that is
+    // no whole number of samples (latency change, new phase) only
+    // re-opens the intercept.
+    m_shift += m_shiftSmoothing * (error - m_shift);
+    const double shiftTolerance = std::max(PHASE_TOLERANCE_PERIODS * m_w1,
+                                           SHIFT_SIGMAS * std::sqrt(m_shiftMeanSq));
+    if (std::fabs(m_shift) > shiftTolerance)
+    {
+        bridge(std::max(0.0, std::round(m_shift / m_w1)));
+        k = m_index;
+        error = timestamp - m_w0;
+    }
+
+    // P·x with x = [1, k]
+    const double px0 = m_p00 + m_p01 * k;
+    const double px1 = m_p01 + m_p11 * k;
+    const double denominator = m_lambda + px0 + px1 * k;
+    const double g0 = px0 / denominator;
+    const double g1 = px1 / denominator;
+
+    m_w0 += g0 * error;
+    m_w1 += g1 * error;
+
+    // P = (P − g·(P·x)ᵀ) / λ, kept symmetric
+    const double invLambda = 1.0 / m_lambda;
+    m_p00 = (m_p00 - g0 * px0) * invLambda;
+    m_p01 = (m_p01 - g0 * px1) * invLambda;
+    m_p11 = (m_p11 - g1 * px1) * invLambda;
+
+    m_residualSamples += 1.0;
+    const double smoothing = std::max(RESIDUAL_SMOOTHING, 1.0 / (m_residualSamples + PRIOR_SAMPLES));
+    m_residualMeanSq += smoothing * (error * error - m_residualMeanSq);
+    m_shiftMeanSq += smoothing / SHIFT_RMS_SLOWDOWN * (m_shift * m_shift - m_shiftMeanSq);
+
+    const double fitted = m_w0 + m_w1 * k;
+
+    // Move the anchor to the current sample: t = (w0 + w1·k) + w1·(k' − k).
+    // With A = [[1, k], [0, 1]]: w ← A·w, P ← A·P·Aᵀ.
+    if (k >= REBASE_SAMPLES)
+    {
+        m_w0 = fitted;
+        m_p00 += 2.0 * k * m_p01 + k * k * m_p11;
+        m_p01 += k * m_p11;
+        m_index = 0.0;
+    }
+
+    return fitted;
+}
@@ -0,0 +1,139 @@
+/*
+ * ==========================================================================
+ *  eegtimestampdejitter.h — Online Dejittering of LSL Sample Timestamps
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    The per-sample timestamps LSL delivers are stamped (or back-dated
+ *    from) the moment the outlet pushed each chunk, so they carry the
+ *    amplifier driver's buffering, the network and the reader's own
+ *    scheduling as jitter of up to tens of milliseconds. The amplifier
+ *    itself samples on a crystal clock: sample k was really taken at
+ *
+ *      t(k) = t0 + k · period           (period ≈ 1 / nominal_srate)
+ *
+ *    EegTimestampDejitter fits t0 and period online by recursive least
+ *    squares over the sample index and replaces every timestamp with the
+ *    fitted line. LSLStreamReader applies it once per chunk before
+ *    publishing, so the sync buffer, the recording and the display all
+ *    see the same regular timestamps and no consumer repeats the work.
+ *
+ *  ALGORITHM:
+ *    Two-parameter RLS with exponential forgetting, regressor [1, k]:
+ *      gain  = P·x / (λ + xᵀ·P·x)
+ *      w    += gain · (t − xᵀ·w)
+ *      P     = (P − gain·xᵀ·P) / λ
+ *    λ = 0.5^(1 / (HALF_LIFE_SEC · nominal_srate)), so a sample's weight
+ *    halves every HALF_LIFE_SEC of stream — long enough to average out
+ *    jitter, short enough to follow slow (thermal) period changes. The
+ *    fit is seeded with the nominal period, so the first timestamps are
+ *    already regular.
+ *
+ *    k is kept relative to an anchor that is moved forward every
+ *    REBASE_SAMPLES samples (w and P transformed accordingly), so the
+ *    regressor stays small over 24-hour recordings.
+ *
+ *  GAPS:
+ *    The model counts samples, so a dropout (samples lost on USB or the
+ *    network) shows up as a residual of a whole number of periods that
+ *    persists. A residual beyond GAP_TOLERANCE_PERIODS · period, or
+ *    JITTER_TOLERANCE_SIGMAS · the measured jitter RMS if that is larger
+ *    (a push latency can span many periods at high rates), opens a gap
+ *    candidate of round(residual / period) lost samples:
+ *      - its samples stay on the unshifted line (a late chunk is far
+ *        more common than a dropout) and are kept out of the fit;
+ *      - if the next chunk fits the shifted line better and within the
+ *        tolerance, the gap is confirmed: the sample index skips the lost
+ *        samples and the intercept is re-opened, since the estimate of
+ *        the count is only as good as one chunk's latency; the period is
+ *        kept;
+ *      - otherwise it was a latency spike and the fit carries on.
+ *    A residual that is not close to a whole number of periods (a new
+ *    sample phase, beyond the jitter), goes backwards, or spans more than
+ *    MAX_BRIDGED_GAP_SEC restarts the fit at that sample.
+ *
+ *    Losses inside the jitter tolerance are caught as a shift of the mean
+ *    residual over half a second and bridged the same way; a shift of
+ *    less than a sample only re-opens the intercept.
+ *
+ *  TIME BASE:
+ *    The output stays in the sender's LSL clock, like the raw timestamps;
+ *    EegSyncManager's clock model still maps it to local_clock().
+ *
+ *  NO QT DEPENDENCY:
+ *    Plain C++, so the fit can be exercised outside the application.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGTIMESTAMPDEJITTER_H
+#define EEGTIMESTAMPDEJITTER_H
+
+#include <cstddef>
+
+class EegTimestampDejitter
+{
+public:
+    static constexpr double HALF_LIFE_SEC = 90.0;
+    static constexpr double GAP_TOLERANCE_PERIODS = 0.5;
+    static constexpr double JITTER_TOLERANCE_SIGMAS = 8.0;
+    static constexpr double PHASE_TOLERANCE_PERIODS = 0.25;
+    static constexpr double MAX_BRIDGED_GAP_SEC = 60.0;
+    static constexpr double REBASE_SAMPLES = 1 << 20;
+
+    /* Starts a new fit for a stream of the given nominal rate. A rate
+     * <= 0 (irregular stream) disables dejittering: process() then
+     * leaves timestamps untouched. */
+    void reset(double nominalRate);
+
+    bool isEnabled() const { return m_nominalRate > 0.0; }
+
+    /* Replaces count timestamps, in stream order, by the fitted times.
+     * Call once per pulled chunk: gaps are confirmed chunk by chunk. */
+    void process(double* timestamps, size_t count);
+
+    /* Fitted sampling period (seconds) — the amplifier's actual rate as
+     * seen through the sender's clock. 0 before the first sample. */
+    double period() const { return m_started ? m_w1 : 0.0; }
+
+    /* Exponentially weighted RMS of raw − fitted time, in seconds: the
+     * jitter removed from the stream. */
+    double residualRms() const;
+
+    /* Number of fit restarts caused by gaps since reset(). */
+    int gapResets() const { return m_gapResets; }
+
+    /* Number of dropouts bridged by skipping the lost samples. */
+    int bridgedGaps() const { return m_bridgedGaps; }
+
+private:
+    double update(double timestamp, bool chunkStart);
+    void restart(double timestamp);
+    void bridge(double lostSamples);
+    double tolerance(double periods) const;
+
+    double m_nominalRate = 0.0;
+    double m_lambda = 1.0;
+    bool m_started = false;
+
+    double m_index = 0.0;           // Sample index relative to the anchor
+    double m_w0 = 0.0;              // Fitted time at the anchor
+    double m_w1 = 0.0;              // Fitted period
+    double m_p00 = 0.0, m_p01 = 0.0, m_p11 = 0.0;  // Symmetric covariance
+
+    /* Lost samples of an unconfirmed gap (0 = none); see GAPS. */
+    double m_pendingLost = 0.0;
+
+    /* Mean residual over SHIFT_WINDOW_SEC and its long-run mean square;
+     * see GAPS. */
+    double m_shiftSmoothing = 1.0;
+    double m_shift = 0.0;
+    double m_shiftMeanSq = 0.0;
+
+    double m_residualMeanSq = 0.0;
+    double m_residualSamples = 0.0;
+    int m_gapResets = 0;
+    int m_bridgedGaps = 0;
+};
+
+#endif // EEGTIMESTAMPDEJITTER_H
@@ -0,0 +1,119 @@
+/*
+ * ==========================================================================
+ *  spscring.h — Lock-Free Single-Producer / Single-Consumer Ring Buffer
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Bounded FIFO for handing items from exactly one producer thread to
+ *    exactly one consumer thread without locks or event-loop hops. Used
+ *    by the recording tap: the LSL acquisition thread pushes EegChunkPtr
+ *    handles, the RecordingWorker thread pops them on its own schedule.
+ *
+ *  ALGORITHM:
+ *    Classic Lamport ring with free-running indices. m_head is written
+ *    only by the producer, m_tail only by the consumer; each side reads
+ *    the other's index with acquire semantics and publishes its own with
+ *    release, so a slot's contents are visible before its index is.
+ *
+ *        tail                 head
+ *         ▼                    ▼
+ *    [ . | A | B | C | D | . | . | . ]     size = head - tail
+ *
+ *    Capacity is rounded up to a power of two so the slot index is a
+ *    mask instead of a modulo. Indices are size_t and never wrap in
+ *    practice (2^64 pushes).
+ *
+ *  FULL / EMPTY:
+ *    tryPush() returns false when the ring is full — the producer never
+ *    blocks and never overwrites unread items; the caller decides what
+ *    to do with the rejected item. tryPop() returns false when empty.
+ *
+ *  THREAD SAFETY:
+ *    tryPush() — producer thread only.
+ *    tryPop()  — consumer thread only.
+ *    size()    — any thread; a snapshot that may be stale immediately.
+ *
+ * ==========================================================================
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t minCapacity)
+    {
+        size_t capacity = 1;
+        while (capacity < minCapacity)
+            capacity <<= 1;
+        m_slots.resize(capacity);
+        m_mask = capacity - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /* Producer: appends item, or returns false (item untouched) if full. */
+    bool tryPush(T&& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= m_slots.size())
+            return false;
+
+        m_slots[head & m_mask] = std::move(item);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(const T& item)
+    {
+        T copy(item);
+        return tryPush(std::move(copy));
+    }
+
+    /* Consumer: moves the oldest item into out, or returns false if empty.
+     * The slot is left moved-from, so shared handles are released here
+     * rather than when the slot is eventually overwritten. */
+    bool tryPop(T& out)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+
+        out = std::move(m_slots[tail & m_mask]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Any thread: approximate fill level, for monitoring. m_tail is read
+     * first: m_head can only have moved forward since, so the difference
+     * cannot underflow. Both sides may advance between the two loads, so
+     * it can overshoot; clamp to the capacity. */
+    size_t size() const
+    {
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        return std::min(head - tail, capacity());
+    }
+
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    std::vector<T> m_slots;
+    size_t m_mask = 0;
+
+    /* Separate cache lines: the producer hammers m_head, the consumer
+     * m_tail; sharing a line would bounce it between cores on every op. */
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+#endif // SPSCRING_H
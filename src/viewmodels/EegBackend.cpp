@@ -21,11 +21,15 @@ EegBackend::EegBackend(QObject *parent)
 {
     qInfo() << "[EegBackend] Created:" << this;
 
+    /* EEG chunks come straight from the LSL worker thread via the
+     * dispatcher; queued delivery is the single hop onto the main thread. */
+    m_amplifierManager->dispatcher()->subscribe(this, [this](const EegChunkPtr& chunk) {
+        onDataReceived(chunk);
+    }, Qt::QueuedConnection);
+
     /* All connections use Qt::QueuedConnection because AmplifierManager
      * relays signals from the LSL worker thread. This ensures all slot
      * execution happens safely on the main thread. */
-    connect(m_amplifierManager, &AmplifierManager::dataReceived,
-            this, &EegBackend::onDataReceived, Qt::QueuedConnection);
     connect(m_amplifierManager, &AmplifierManager::samplingRateDetected,
             this, &EegBackend::onSamplingRateDetected, Qt::QueuedConnection);
     connect(m_amplifierManager, &AmplifierManager::streamConnected,
@@ -37,6 +41,9 @@ EegBackend::EegBackend(QObject *parent)
 EegBackend::~EegBackend()
 {
     qDebug() << "[EegBackend] Destructor called";
+
+    /* Guarantees no chunk is posted to this object after destruction. */
+    m_amplifierManager->dispatcher()->unsubscribe(this);
 }
 
 // ============================================================================
@@ -123,6 +130,8 @@ void EegBackend::onSamplingRateDetected(double samplingRate)
         }
 
         EegSyncManager::instance()->setSamplingRate(samplingRate);
+
+        m_filterBank.setSamplingRate(samplingRate);
     }
 }
 
@@ -130,39 +139,53 @@ void EegBackend::onSamplingRateDetected(double samplingRate)
 // Data Processing — THE HOT PATH
 // ============================================================================
 
-void EegBackend::onDataReceived(const std::vector<std::vector<float>>& chunk,
-                                 const std::vector<double>& timestamps)
+void EegBackend::onDataReceived(const EegChunkPtr& chunk)
 {
-    if (chunk.empty() || chunk[0].empty() || m_channels.isEmpty() || !m_dataModel)
+    if (!chunk || chunk->isEmpty() || m_displayIndices.isEmpty() || !m_dataModel)
     {
         return;
     }
 
-    updateChannelIndexCache();
-
-    /* Route 1: DISPLAY — scale μV→pixels and write to circular buffer.
-     * This is the only route that transforms the data; routes 2 and 3
-     * receive the raw μV values with LSL timestamps for fidelity. */
-    QVector<QVector<double>> scaledData = m_scaler->transformChunk(
-        chunk, m_channelIndexCache, m_spacing);
+    updateAcquisitionLatency(chunk->timestamps.back());
 
-    int prevWritePos = m_dataModel->writePosition();
-    m_dataModel->updateAllData(scaledData);
-    updateMarkersAfterWrite(prevWritePos, m_dataModel->writePosition());
+    /* FILTER — the chunk is shared with the sync and recording consumers,
+     * so the filtered copy goes into m_filteredChunk. All hardware
+     * channels are filtered, so changing the channel selection does not
+     * restart any filter state. */
+    const EegChunk* display = chunk.get();
+    if (m_filterBank.isActive())
+    {
+        m_filteredChunk.channelCount = chunk->channelCount;
+        m_filteredChunk.sampleCount = chunk->sampleCount;
+        m_filteredChunk.samples.resize(chunk->samples.size());
+        m_filterBank.process(chunk->samples.data(), m_filteredChunk.samples.data(),
+                             chunk->sampleCount, chunk->channelCount);
+        display = &m_filteredChunk;
+    }
 
-    /* Route 2: SYNC BUFFER — raw data with timestamps for EEG-video alignment.
-     * EegSyncManager stores these in a ring buffer that VideoBackend queries
-     * to find the EEG data corresponding to each video frame's timestamp. */
-    if (!timestamps.empty())
+    /* MONTAGE — referential montages are a plain gather the scaler does
+     * itself; anything else is computed into m_montageChunk first. */
+    if (!m_montage->isPassThrough())
     {
-        EegSyncManager::instance()->addEegSamples(chunk, timestamps, m_channelIndexCache);
+        m_montage->apply(*display, m_montageChunk);
+        display = &m_montageChunk;
     }
 
-    /* Route 3: RECORDING — raw data forwarded to RecordingManager.
-     * RecordingManager checks internally whether recording is active;
-     * if not, this is a no-op. If active, data is batched and flushed
-     * to CSV on the RecordingWorker thread. */
-    RecordingManager::instance()->writeEegData(chunk, timestamps, m_channelIndexCache);
+    /* DISPLAY — scale μV→pixels straight into the circular buffer.
+     * This is the only consumer that transforms the data; sync and
+     * recording receive the raw μV values with LSL timestamps for fidelity. */
+    int prevWritePos = m_dataModel->writePosition();
+    m_dataModel->writeSamples(m_displayIndices.size(), display->sampleCount,
+                              [&](float* const* dest, int firstSample, int count) {
+        m_scaler->transformChunkInto(*display, m_displayIndices, m_spacing,
+                                     firstSample, count, dest);
+    });
+    updateMarkersAfterWrite(prevWritePos, m_dataModel->writePosition());
+
+    /* The sync buffer (EegSyncManager) and the recording tap
+     * (RecordingManager) are not fed from here: both subscribe to the
+     * dispatcher directly and ingest chunks on the LSL worker thread,
+     * so neither depends on this slot being scheduled promptly. */
 }
 
 void EegBackend::updateChannelIndexCache()
@@ -181,6 +204,26 @@ void EegBackend::updateChannelIndexCache()
     }
 }
 
+void EegBackend::updateAcquisitionLatency(double newestTimestamp)
+{
+    /* LSL timestamps are in the sender's clock; adding time_correction()
+     * maps them into local_clock() so the difference is a true latency
+     * even when Svarog Streamer runs on another machine. */
+    const double correctionSec = EegSyncManager::instance()->timeCorrectionMs() / 1000.0;
+    const double latencyMs = (lsl::local_clock() - (newestTimestamp + correctionSec)) * 1000.0;
+
+    if (m_acquisitionLatencyMs == 0.0)
+        m_acquisitionLatencyMs = latencyMs;
+    else
+        m_acquisitionLatencyMs += LATENCY_SMOOTHING * (latencyMs - m_acquisitionLatencyMs);
+
+    if (!m_latencyNotifyTimer.isValid() || m_latencyNotifyTimer.elapsed() >= LATENCY_NOTIFY_INTERVAL_MS)
+    {
+        m_latencyNotifyTimer.start();
+        emit acquisitionLatencyChanged();
+    }
+}
+
 void EegBackend::updateMarkersAfterWrite(int prevWritePos, int newWritePos)
 {
     if (!m_markerManager || m_samplingRate <= 0 || !m_dataModel)
@@ -266,36 +309,112 @@ void EegBackend::setChannels(const QVariantList &newChannels)
 
     m_channels = newChannels;
 
-    /* Clear the cache so updateChannelIndexCache() will rebuild it from
-     * the new QVariantList on the next onDataReceived() call. */
+    /* Rebuild the cache now rather than on the next chunk: EegSyncManager
+     * consumes chunks on the LSL worker thread and needs the montage for
+     * the new selection before data arrives. */
     m_channelIndexCache.clear();
+    updateChannelIndexCache();
     emit channelsChanged();
+    rebuildMontage();
 }
 
 QStringList EegBackend::channelNames() const
 {
-    /* Resolves numeric channel indices to human-readable names (e.g. "Fp1")
-     * by looking up the amplifier's available_channels list. Falls back to
-     * "Ch N" if the amplifier metadata is unavailable. */
-    QStringList names;
+    return m_montage ? m_montage->labels() : QStringList();
+}
 
-    Amplifier* amp = m_amplifierManager->getAmplifierById(m_amplifierId);
+// ============================================================================
+// Montage
+// ============================================================================
+
+void EegBackend::setMontage(Montage montage)
+{
+    if (m_montageType == montage)
+        return;
 
-    for (const auto& channelVar : m_channels)
+    m_montageType = montage;
+    emit montageChanged();
+    rebuildMontage();
+}
+
+void EegBackend::setCustomMontage(const QVariantList& derivations)
+{
+    m_customMontage = derivations;
+    if (m_montageType != Custom)
     {
-        int channelIndex = channelVar.toInt();
+        m_montageType = Custom;
+        emit montageChanged();
+    }
+    rebuildMontage();
+}
 
-        if (amp && channelIndex >= 0 && channelIndex < amp->available_channels.size())
-        {
-            names.append(amp->available_channels[channelIndex]);
-        }
-        else
+void EegBackend::rebuildMontage()
+{
+    /* Hardware labels resolve channel indices to names (e.g. "Fp1") and
+     * locate electrodes for the bipolar and Laplacian montages. Without
+     * amplifier metadata channels are named "Ch N" and only the
+     * referential, average and custom montages can be built. */
+    QStringList labels;
+    if (Amplifier* amp = m_amplifierManager->getAmplifierById(m_amplifierId))
+        labels = amp->available_channels;
+
+    EegMontage montage;
+    switch (m_montageType)
+    {
+    case Referential:
+        break;
+    case CommonAverage:
+        montage = EegMontage::commonAverage(m_channelIndexCache, labels);
+        break;
+    case Bipolar:
+        montage = EegMontage::doubleBanana(m_channelIndexCache, labels);
+        break;
+    case Laplacian:
+        montage = EegMontage::laplacian(m_channelIndexCache, labels);
+        break;
+    case Custom:
+        for (const QVariant& entry : m_customMontage)
         {
-            names.append(QString("Ch %1").arg(channelIndex));
+            const QVariantMap derivation = entry.toMap();
+            std::vector<EegMontage::Term> terms;
+            for (const QVariant& termVar : derivation.value("terms").toList())
+            {
+                const QVariantMap term = termVar.toMap();
+                terms.push_back({ term.value("channel", -1).toInt(),
+                                  term.value("weight", 1.0).toFloat() });
+            }
+            if (!terms.empty())
+                montage.addDerivation(derivation.value("label").toString(), terms);
         }
+        break;
     }
 
-    return names;
+    if (montage.isEmpty() && m_montageType != Referential)
+    {
+        qWarning() << "[EegBackend] Montage" << m_montageType
+                   << "has no derivations for the selected channels; showing referential";
+    }
+    if (montage.isEmpty())
+        montage = EegMontage::referential(m_channelIndexCache, labels);
+
+    m_montage = std::make_shared<const EegMontage>(std::move(montage));
+
+    if (m_montage->isPassThrough())
+    {
+        m_displayIndices = m_montage->passThroughChannels();
+    }
+    else
+    {
+        m_displayIndices.resize(m_montage->derivationCount());
+        for (int d = 0; d < m_displayIndices.size(); ++d)
+            m_displayIndices[d] = d;
+    }
+
+    qDebug() << "[EegBackend] Montage" << m_montageType << "with"
+             << m_montage->derivationCount() << "traces";
+
+    EegSyncManager::instance()->setMontage(m_montage);
+    emit channelNamesChanged();
 }
 
 // ============================================================================
@@ -328,6 +447,10 @@ void EegBackend::setAmplifierId(const QString &newAmplifierId)
 
     m_amplifierId = newAmplifierId;
     emit amplifierIdChanged();
+
+    /* Channel labels (and so bipolar / Laplacian pairs) come from the
+     * amplifier's metadata. */
+    rebuildMontage();
 }
 
 // ============================================================================
@@ -387,3 +510,68 @@ double EegBackend::samplingRate() const
 {
     return m_samplingRate;
 }
+
+// ============================================================================
+// Display Filters
+// ============================================================================
+
+void EegBackend::setHighPassHz(double hz)
+{
+    EegFilterBank::Settings settings = m_filterBank.settings();
+    settings.highPassHz = qMax(0.0, hz);
+    updateFilterSettings(settings);
+}
+
+void EegBackend::setLowPassHz(double hz)
+{
+    EegFilterBank::Settings settings = m_filterBank.settings();
+    settings.lowPassHz = qMax(0.0, hz);
+    updateFilterSettings(settings);
+}
+
+void EegBackend::setNotchHz(double hz)
+{
+    EegFilterBank::Settings settings = m_filterBank.settings();
+    settings.notchHz = qMax(0.0, hz);
+    updateFilterSettings(settings);
+}
+
+void EegBackend::updateFilterSettings(const EegFilterBank::Settings& settings)
+{
+    const EegFilterBank::Settings& current = m_filterBank.settings();
+    if (current.highPassHz == settings.highPassHz
+        && current.lowPassHz == settings.lowPassHz
+        && current.notchHz == settings.notchHz)
+        return;
+
+    /* No buffer reset: the visible trace keeps its history and new rows
+     * are filtered with the new coefficients from the next chunk on. */
+    m_filterBank.setSettings(settings);
+    qDebug() << "[EegBackend] Display filters: HP" << settings.highPassHz
+             << "Hz, LP" << settings.lowPassHz << "Hz, notch" << settings.notchHz << "Hz";
+    emit filterSettingsChanged();
+}
+
+// ============================================================================
+// Acquisition Tuning
+// ============================================================================
+
+bool EegBackend::lowLatencyAcquisition() const
+{
+    return m_amplifierManager->acquisitionMode() == LSLStreamReader::AcquisitionMode::LatencyOptimized;
+}
+
+void EegBackend::setLowLatencyAcquisition(bool lowLatency)
+{
+    if (lowLatencyAcquisition() == lowLatency)
+        return;
+
+    m_amplifierManager->setAcquisitionMode(lowLatency
+        ? LSLStreamReader::AcquisitionMode::LatencyOptimized
+        : LSLStreamReader::AcquisitionMode::CpuOptimized);
+
+    /* Restart the average so the displayed value reflects the new mode. */
+    m_acquisitionLatencyMs = 0.0;
+    emit lowLatencyAcquisitionChanged();
+    emit acquisitionLatencyChanged();
+}
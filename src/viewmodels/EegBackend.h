@@ -6,50 +6,64 @@
  *  PURPOSE:
  *    The primary ViewModel for the EEG display window (EegWindow.qml).
  *    Acts as the central hub that receives raw EEG data from the hardware
- *    layer and routes it to three independent consumers:
- *      1. Display pipeline  — scales and feeds EegDataModel for visualization.
- *      2. Sync buffer       — feeds EegSyncManager for video-EEG alignment.
- *      3. Recording system  — feeds RecordingManager for persistent storage.
+ *    layer and feeds the display pipeline: scales it and writes EegDataModel
+ *    for visualization. The sync buffer (EegSyncManager) and the recording
+ *    tap (RecordingManager) subscribe to the same chunk stream directly on
+ *    the acquisition thread; EegBackend only hands EegSyncManager the
+ *    channel selection.
  *
  *  DESIGN PATTERNS:
  *    MVVM ViewModel (QML_ELEMENT) — bridges the C++ data layer with the QML UI.
  *    Facade — hides the complexity of AmplifierManager, EegDisplayScaler,
  *    MarkerManager, and EegSyncManager behind a single QML-facing interface.
- *    Composition — owns MarkerManager and EegDisplayScaler as sub-components.
+ *    Composition — owns MarkerManager, EegDisplayScaler and the display
+ *    filter chain (EegFilterBank) as sub-components.
  *
  *  COMPLETE DATA ROUTING (onDataReceived — the critical hot path):
  *
- *    AmplifierManager::dataReceived [raw μV, LSL timestamps]
+ *    EegChunkDispatcher::publish [EegChunkPtr: raw μV, LSL timestamps]
+ *              │
+ *              ├──▸ EegSyncManager::addEegSamples() (direct, LSL worker thread)
+ *              ├──▸ RecordingManager tap → SPSC ring (direct, LSL worker thread)
  *              │
  *              ▼  (Qt::QueuedConnection — worker thread → main thread)
  *    EegBackend::onDataReceived()
  *              │
- *              ├──[1] DISPLAY ─────────────────────────────────────────────
- *              │   EegDisplayScaler::transformChunk()
- *              │     • Extracts selected channels via m_channelIndexCache
- *              │     • Transposes [sample][channel] → [channel][sample]
- *              │     • Applies μV → pixel scaling with Y-axis inversion
- *              │   EegDataModel::updateAllData()
- *              │     • Writes to circular buffer
- *              │     • Emits rate-limited dataChanged for QML
- *              │   updateMarkersAfterWrite()
- *              │     • Garbage-collects overwritten markers
- *              │
- *              ├──[2] SYNC BUFFER ─────────────────────────────────────────
- *              │   EegSyncManager::addEegSamples()
- *              │     • Stores raw data with LSL timestamps
- *              │     • Used later for video-EEG frame alignment
- *              │
- *              └──[3] RECORDING ───────────────────────────────────────────
- *                  RecordingManager::writeEegData()
- *                    • Batches data, flushes to CSV on worker thread
- *                    • No-op if recording is not active
+ *              └──[1] DISPLAY ─────────────────────────────────────────────
+ *                  EegFilterBank::process() (if any filter is on)
+ *                    • HP / LP / notch on all hardware channels into
+ *                      m_filteredChunk; the shared chunk stays raw
+ *                  EegMontage::apply() (unless the montage is referential)
+ *                    • Sparse re-referencing into m_montageChunk, one
+ *                      column per derivation
+ *                  EegDataModel::writeSamples()
+ *                    • Hands out the ring rows for this chunk in place
+ *                  EegDisplayScaler::transformChunkInto() (SIMD kernel)
+ *                    • Extracts displayed columns via m_displayIndices
+ *                    • Transposes [sample][channel] → [channel][sample]
+ *                    • Applies μV → pixel scaling with Y-axis inversion
+ *                    • Stores float32 directly into the ring
+ *                    • Marks the written rows dirty; EegTraceView flushes
+ *                      them as dataChanged once per rendered frame
+ *                  updateMarkersAfterWrite()
+ *                    • Garbage-collects overwritten markers
+ *
+ *  MONTAGE:
+ *    rebuildMontage() turns the channel selection plus the amplifier's
+ *    channel labels into an immutable EegMontage whenever either, or the
+ *    montage type, changes. The same pointer goes to EegSyncManager, so
+ *    sync queries return the displayed derivations. Acquisition and the
+ *    recording tap never see it — switching montage only swaps pointers
+ *    on the main thread. For the referential montage m_displayIndices are
+ *    the selected hardware channels and no copy is made; otherwise they
+ *    are 0 … derivationCount-1 into m_montageChunk.
  *
  *  CHANNEL INDEX CACHE:
  *    m_channels (QVariantList from QML) contains the user-selected channel
  *    indices as QVariants. Converting them to int on every data arrival would
  *    be wasteful (~50 calls/sec). m_channelIndexCache pre-converts to QVector<int>
- *    and is rebuilt only when the channel selection changes.
+ *    and is rebuilt only when the channel selection changes. setChannels()
+ *    then rebuilds the montage.
  *
  *  INITIALIZATION SEQUENCE (from QML):
  *    1. QML creates EegBackend and sets amplifierId, channels, spacing, etc.
@@ -60,9 +74,10 @@
  *    6. onDataReceived() begins the continuous data routing loop.
  *
  *  THREADING:
- *    All slots run on the main thread. The Qt::QueuedConnection in the
- *    constructor ensures that signals from AmplifierManager (which relays
- *    from the LSL worker thread) are safely marshalled to the main thread.
+ *    All slots run on the main thread. The dispatcher subscription and the
+ *    AmplifierManager connections in the constructor are queued, so chunks
+ *    and state changes from the LSL worker thread arrive on the main thread
+ *    in one hop.
  *
  * ==========================================================================
  */
@@ -71,6 +86,7 @@
 #define EEGBACKEND_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QVariantMap>
 #include <QVector>
 #include <QtQml/qqmlregistration.h>
@@ -79,6 +95,8 @@
 #include "eegdatamodel.h"
 #include "markermanager.h"
 #include "eegdisplayscaler.h"
+#include "eegfilterbank.h"
+#include "eegmontage.h"
 #include "eegsyncmanager.h"
 
 class EegBackend : public QObject
@@ -88,7 +106,7 @@ class EegBackend : public QObject
 
     // Channel configuration — set from AmplifierSetupWindow via main.qml
     Q_PROPERTY(QVariantList channels READ channels WRITE setChannels NOTIFY channelsChanged FINAL)
-    Q_PROPERTY(QStringList channelNames READ channelNames NOTIFY channelsChanged FINAL)
+    Q_PROPERTY(QStringList channelNames READ channelNames NOTIFY channelNamesChanged FINAL)
 
     // Amplifier identification — set during device selection
     Q_PROPERTY(int amplifierIdx READ amplifierIdx WRITE setAmplifierIdx NOTIFY amplifierIdxChanged FINAL)
@@ -98,9 +116,22 @@ class EegBackend : public QObject
     Q_PROPERTY(double spacing READ spacing WRITE setSpacing NOTIFY spacingChanged FINAL)
     Q_PROPERTY(double timeWindowSeconds READ timeWindowSeconds WRITE setTimeWindowSeconds NOTIFY timeWindowSecondsChanged FINAL)
 
+    // Montage (re-referencing) for the display and the sync buffer
+    Q_PROPERTY(Montage montage READ montage WRITE setMontage NOTIFY montageChanged FINAL)
+
+    // Display filters in Hz (0 = off) — applied to the display path only
+    Q_PROPERTY(double highPassHz READ highPassHz WRITE setHighPassHz NOTIFY filterSettingsChanged FINAL)
+    Q_PROPERTY(double lowPassHz READ lowPassHz WRITE setLowPassHz NOTIFY filterSettingsChanged FINAL)
+    Q_PROPERTY(double notchHz READ notchHz WRITE setNotchHz NOTIFY filterSettingsChanged FINAL)
+
     // Stream info — propagated from LSL stream metadata
     Q_PROPERTY(double samplingRate READ samplingRate NOTIFY samplingRateChanged FINAL)
 
+    // Acquisition tuning — latency- vs CPU-optimized LSL polling, and the
+    // measured end-to-end latency (sample timestamp → display write)
+    Q_PROPERTY(bool lowLatencyAcquisition READ lowLatencyAcquisition WRITE setLowLatencyAcquisition NOTIFY lowLatencyAcquisitionChanged FINAL)
+    Q_PROPERTY(double acquisitionLatencyMs READ acquisitionLatencyMs NOTIFY acquisitionLatencyChanged FINAL)
+
     // Connection state — drives UI indicators (connecting spinner, connected badge)
     Q_PROPERTY(bool isConnecting READ isConnecting NOTIFY isConnectingChanged FINAL)
     Q_PROPERTY(bool isConnected READ isConnected NOTIFY isConnectedChanged FINAL)
@@ -110,6 +141,18 @@ class EegBackend : public QObject
     Q_PROPERTY(EegDisplayScaler* scaler READ scaler CONSTANT FINAL)
 
 public:
+    /* Built-in montages (see EegMontage); Custom is set through
+     * setCustomMontage(). */
+    enum Montage
+    {
+        Referential,
+        CommonAverage,
+        Bipolar,        // Longitudinal "double banana"
+        Laplacian,
+        Custom
+    };
+    Q_ENUM(Montage)
+
     /* Constructor wires all signal/slot connections to AmplifierManager
      * with Qt::QueuedConnection for thread safety, and creates owned
      * sub-components (MarkerManager, EegDisplayScaler). */
@@ -154,10 +197,26 @@ public:
      * it will be rebuilt on the next data arrival. */
     void setChannels(const QVariantList &newChannels);
 
-    /* Resolves numeric channel indices to human-readable EEG labels
-     * (e.g. "Fp1", "C3") by looking up the amplifier's metadata. */
+    /* Labels of the displayed traces, one per derivation of the active
+     * montage: "Fp1" (referential), "Fp1-F7" (bipolar), "C3-Avg",
+     * "C3-Lap". Hardware labels come from the amplifier's metadata. */
     QStringList channelNames() const;
 
+    // --- Montage ---
+
+    /* Active montage. Switching rebuilds the derivation matrix on the
+     * main thread; the display buffer is reinitialized only if the number
+     * of traces changes. Bipolar falls back to Referential if none of the
+     * 18 pairs is present in the selection. */
+    Montage montage() const { return m_montageType; }
+    void setMontage(Montage montage);
+
+    /* Installs a custom montage and switches to it. Each entry is a map
+     * { "label": "Fp1-F7", "terms": [ { "channel": 0, "weight": 1.0 },
+     * { "channel": 10, "weight": -1.0 } ] } with hardware channel
+     * indices; entries without terms are skipped. */
+    Q_INVOKABLE void setCustomMontage(const QVariantList& derivations);
+
     // --- Amplifier identification ---
 
     /* Index of the selected amplifier in the discovery list (for QML ComboBox). */
@@ -184,6 +243,33 @@ public:
     /* Sampling rate in Hz, as reported by the LSL stream. Read-only from QML. */
     double samplingRate() const;
 
+    // --- Display filters ---
+
+    /* Cutoffs of the display filter chain in Hz; 0 switches a filter off.
+     * Changes apply from the next chunk without touching the display
+     * buffer. Cutoffs at or above 0.45 × samplingRate are ignored by
+     * EegFilterBank (the filter stays off). Defaults: 0.5 / 70 / 50 Hz. */
+    double highPassHz() const { return m_filterBank.settings().highPassHz; }
+    void setHighPassHz(double hz);
+    double lowPassHz() const { return m_filterBank.settings().lowPassHz; }
+    void setLowPassHz(double hz);
+    double notchHz() const { return m_filterBank.settings().notchHz; }
+    void setNotchHz(double hz);
+
+    // --- Acquisition tuning ---
+
+    /* true  = LatencyOptimized: the LSL reader blocks until data arrives.
+     * false = CpuOptimized: fixed 20 ms poll (larger, burstier chunks).
+     * Forwarded to AmplifierManager; takes effect on the running stream. */
+    bool lowLatencyAcquisition() const;
+    void setLowLatencyAcquisition(bool lowLatency);
+
+    /* Smoothed end-to-end latency in ms: local_clock() at display write
+     * minus the (time-corrected) LSL timestamp of the newest sample in the
+     * chunk. Covers network, LSL queueing, poll wait and the queued hop
+     * to the main thread. 0 until the first chunk arrives. */
+    double acquisitionLatencyMs() const { return m_acquisitionLatencyMs; }
+
     // --- Connection state (read-only from QML) ---
 
     /* True while waiting for LSL stream resolution (between startStream()
@@ -212,8 +298,8 @@ public slots:
     void onStreamDisconnected();
 
     /* Called once when the LSL stream reports its nominal sampling rate.
-     * Propagates the rate to EegDataModel (buffer sizing) and
-     * EegSyncManager (time calculations). */
+     * Propagates the rate to EegDataModel (buffer sizing),
+     * EegSyncManager (time calculations) and the filter chain. */
     void onSamplingRateDetected(double samplingRate);
 
     /* THE HOT PATH — called ~50 times/sec with ~5 samples each.
@@ -221,11 +307,12 @@ public slots:
      *   [1] Display — scale and write to circular buffer
      *   [2] Sync   — store raw data for video-EEG alignment
      *   [3] Record — batch and flush to CSV (if recording active) */
-    void onDataReceived(const std::vector<std::vector<float>>& chunk,
-                        const std::vector<double>& timestamps);
+    void onDataReceived(const EegChunkPtr& chunk);
 
 signals:
     void channelsChanged();
+    void channelNamesChanged();
+    void montageChanged();
     void amplifierIdxChanged();
     void amplifierIdChanged();
     void spacingChanged();
@@ -233,21 +320,43 @@ signals:
     void timeWindowSecondsChanged();
     void isConnectingChanged();
     void isConnectedChanged();
+    void lowLatencyAcquisitionChanged();
+    void acquisitionLatencyChanged();
+    void filterSettingsChanged();
 
 private:
     /* Lazily rebuilds m_channelIndexCache from the QVariantList m_channels.
      * Only runs when the channel count has changed. */
     void updateChannelIndexCache();
 
+    /* Builds the montage for the current selection, labels and type,
+     * pushes it to EegSyncManager and refreshes m_displayIndices. */
+    void rebuildMontage();
+
     /* Garbage-collects markers that fell within the overwritten buffer range. */
     void updateMarkersAfterWrite(int prevWritePos, int newWritePos);
 
+    /* Applies one filter-settings change (no-op if unchanged). */
+    void updateFilterSettings(const EegFilterBank::Settings& settings);
+
+    /* Folds the latency of the newest sample in a chunk into the
+     * exponentially-smoothed m_acquisitionLatencyMs. */
+    void updateAcquisitionLatency(double newestTimestamp);
+
     AmplifierManager* m_amplifierManager = nullptr;
 
     /* m_channels: QVariantList of channel indices (set from QML).
-     * m_channelIndexCache: pre-converted QVector<int> for hot-path use. */
+     * m_channelIndexCache: pre-converted QVector<int> the montage is built from. */
     QVariantList m_channels;
     QVector<int> m_channelIndexCache;
+
+    /* Active montage (shared with EegSyncManager), the custom definition
+     * it may come from, and the columns the scaler gathers per chunk. */
+    Montage m_montageType = Referential;
+    QVariantList m_customMontage;
+    EegMontagePtr m_montage;
+    QVector<int> m_displayIndices;
+
     int m_amplifierIdx = 0;
     QString m_amplifierId;
 
@@ -258,10 +367,24 @@ private:
     bool m_isConnecting = false;
     bool m_isConnected = false;
 
+    /* Latency tracking — EWMA over chunks; QML notification throttled to
+     * LATENCY_NOTIFY_INTERVAL_MS so per-chunk updates do not flood bindings. */
+    double m_acquisitionLatencyMs = 0.0;
+    QElapsedTimer m_latencyNotifyTimer;
+    static constexpr double LATENCY_SMOOTHING = 0.05;
+    static constexpr int LATENCY_NOTIFY_INTERVAL_MS = 250;
+
     EegDataModel* m_dataModel = nullptr;    // Not owned — lives in QML tree
 
     MarkerManager* m_markerManager = nullptr;       // Owned
     EegDisplayScaler* m_scaler = nullptr;           // Owned
+
+    /* Display filter chain, and the chunks filtering and re-referencing
+     * write into — reused so the hot path does not allocate once their
+     * sizes have settled. */
+    EegFilterBank m_filterBank;
+    EegChunk m_filteredChunk;
+    EegChunk m_montageChunk;
 };
 
 #endif // EEGBACKEND_H
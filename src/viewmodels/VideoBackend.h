@@ -55,10 +55,11 @@
  *
  *  QML-SIDE EEG SYNCHRONIZATION (VideoDisplayWindow.qml):
  *    The frameReceived(lslTimestamp) signal is connected in QML to a handler
- *    that calls EegSyncManager.getEEGForFrame(lslTimestamp). This returns
- *    a QVariantMap with the matched EEG sample, sync offset, and out-of-range
- *    status, which drives the on-screen sync health overlays. This is the
- *    live, per-frame synchronization feedback loop for the operator.
+ *    that queues the timestamp; a 10 Hz timer aligns the queue with
+ *    EegSyncManager.getEEGForFrames(). The typed result lists (matched EEG
+ *    timestamps, sync offsets, out-of-range distances, channel values)
+ *    drive the on-screen sync health overlays. This is the live
+ *    synchronization feedback loop for the operator.
  *
  *  THREADING:
  *    All slots run on the main thread. Qt::QueuedConnection is used for
@@ -0,0 +1,462 @@
+/*
+ * ==========================================================================
+ *  eegtraceview.cpp — Scene-Graph EEG Trace Renderer Implementation
+ * ==========================================================================
+ *  See eegtraceview.h for the node layout and the dirty-tile scheme.
+ * ==========================================================================
+ */
+
+#include "eegtraceview.h"
+
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+/* Root of the item's subtree. Keeps typed pointers to its children so
+ * updatePaintNode() can address tiles by index. Children are owned (and
+ * deleted) by QSGNode as usual. */
+class TraceRootNode : public QSGNode
+{
+public:
+    QSGGeometryNode* grid = nullptr;
+    std::vector<QSGGeometryNode*> tiles;
+    int rows = 0;
+    int channels = 0;
+    int level = -1;         // Envelope level the tiles were built for
+    int columns = 0;
+};
+
+QSGGeometryNode* createLineNode(int vertexCount)
+{
+    auto* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), vertexCount);
+    geometry->setDrawingMode(QSGGeometry::DrawLines);
+    geometry->setLineWidth(1.0f);
+
+    auto* node = new QSGGeometryNode;
+    node->setGeometry(geometry);
+    node->setMaterial(new QSGVertexColorMaterial);
+    node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+    return node;
+}
+
+struct Rgba { uchar r, g, b, a; };
+
+/* QSGVertexColorMaterial expects premultiplied alpha. */
+Rgba premultiplied(const QColor& color)
+{
+    const int a = color.alpha();
+    return { uchar(color.red() * a / 255), uchar(color.green() * a / 255),
+             uchar(color.blue() * a / 255), uchar(a) };
+}
+
+} // namespace
+
+EegTraceView::EegTraceView(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+}
+
+// ============================================================================
+// Properties
+// ============================================================================
+
+EegDataModel* EegTraceView::model() const
+{
+    return m_model;
+}
+
+void EegTraceView::setModel(EegDataModel* model)
+{
+    if (m_model == model)
+        return;
+
+    if (m_model)
+        disconnect(m_model, nullptr, this, nullptr);
+
+    m_model = model;
+
+    if (m_model)
+    {
+        connect(m_model, &QAbstractItemModel::dataChanged,
+                this, &EegTraceView::onModelDataChanged);
+        connect(m_model, &QAbstractItemModel::modelReset,
+                this, &EegTraceView::invalidateAll);
+        connect(m_model, &EegDataModel::maxSamplesChanged,
+                this, &EegTraceView::invalidateAll);
+        connect(m_model, &EegDataModel::timeWindowSecondsChanged,
+                this, &EegTraceView::invalidateAll);
+        connect(m_model, &QObject::destroyed,
+                this, &EegTraceView::invalidateAll);
+        connect(m_model, &EegDataModel::changesPending,
+                this, &EegTraceView::requestFrame);
+        requestFrame(); // Anything written before we attached
+    }
+
+    invalidateAll();
+    emit modelChanged();
+}
+
+double EegTraceView::valueMin() const
+{
+    return m_valueMin;
+}
+
+void EegTraceView::setValueMin(double value)
+{
+    if (qFuzzyCompare(m_valueMin, value))
+        return;
+    m_valueMin = value;
+    m_rebuildAll = true;
+    update();
+    emit valueRangeChanged();
+}
+
+double EegTraceView::valueMax() const
+{
+    return m_valueMax;
+}
+
+void EegTraceView::setValueMax(double value)
+{
+    if (qFuzzyCompare(m_valueMax, value))
+        return;
+    m_valueMax = value;
+    m_rebuildAll = true;
+    update();
+    emit valueRangeChanged();
+}
+
+QVariantList EegTraceView::channelColors() const
+{
+    return m_channelColorList;
+}
+
+void EegTraceView::setChannelColors(const QVariantList& colors)
+{
+    if (m_channelColorList == colors)
+        return;
+
+    /* Parsed once here rather than per vertex on the render thread. */
+    m_channelColorList = colors;
+    m_channelColors.clear();
+    m_channelColors.reserve(colors.size());
+    for (const QVariant& value : colors)
+    {
+        QColor color = value.typeId() == QMetaType::QColor
+            ? value.value<QColor>()
+            : QColor::fromString(value.toString());
+        m_channelColors.append(color.isValid() ? color : QColor(Qt::white));
+    }
+
+    m_rebuildAll = true;
+    update();
+    emit channelColorsChanged();
+}
+
+QColor EegTraceView::gridColor() const
+{
+    return m_gridColor;
+}
+
+void EegTraceView::setGridColor(const QColor& color)
+{
+    if (m_gridColor == color)
+        return;
+    m_gridColor = color;
+    m_rebuildGrid = true;
+    update();
+    emit gridColorsChanged();
+}
+
+QColor EegTraceView::subGridColor() const
+{
+    return m_subGridColor;
+}
+
+void EegTraceView::setSubGridColor(const QColor& color)
+{
+    if (m_subGridColor == color)
+        return;
+    m_subGridColor = color;
+    m_rebuildGrid = true;
+    update();
+    emit gridColorsChanged();
+}
+
+// ============================================================================
+// Change Tracking (GUI thread)
+// ============================================================================
+
+void EegTraceView::onModelDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    /* Normally called from onAfterAnimating(), one or two ranges per frame.
+     * Ranges are kept separate: merging the two halves of a wrapped arc
+     * would dirty the whole buffer. */
+    m_dirtyRows.emplace_back(topLeft.row(), bottomRight.row());
+    update();
+}
+
+void EegTraceView::requestFrame()
+{
+    if (window())
+        window()->update();
+}
+
+void EegTraceView::onAfterAnimating()
+{
+    if (m_model)
+        m_model->flushPendingChanges();
+}
+
+void EegTraceView::itemChange(ItemChange change, const ItemChangeData& value)
+{
+    QQuickItem::itemChange(change, value);
+    if (change != ItemSceneChange)
+        return;
+
+    /* Follow the window this item is shown in; its frame clock paces the
+     * model's dataChanged flushes. */
+    disconnect(m_frameConnection);
+    if (value.window)
+    {
+        m_frameConnection = connect(value.window, &QQuickWindow::afterAnimating,
+                                    this, &EegTraceView::onAfterAnimating);
+        value.window->update();
+    }
+}
+
+void EegTraceView::invalidateAll()
+{
+    m_rebuildAll = true;
+    m_rebuildGrid = true;
+    update();
+}
+
+void EegTraceView::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+        invalidateAll();
+}
+
+// ============================================================================
+// Scene Graph (render thread, GUI thread blocked)
+// ============================================================================
+
+QSGNode* EegTraceView::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data)
+{
+    Q_UNUSED(data);
+
+    auto* root = static_cast<TraceRootNode*>(oldNode);
+    if (!root)
+    {
+        root = new TraceRootNode;
+        root->grid = createLineNode(0);
+        root->appendChildNode(root->grid);
+        m_rebuildAll = true;
+        m_rebuildGrid = true;
+    }
+
+    if (m_rebuildGrid)
+    {
+        fillGrid(root->grid);
+        root->grid->markDirty(QSGNode::DirtyGeometry);
+        m_rebuildGrid = false;
+    }
+
+    const int rows = m_model ? m_model->rowCount() : 0;
+    const int channels = m_model ? m_model->channelCount() : 0;
+    const bool drawable = rows >= 2 && channels > 0 && width() > 0 && height() > 0
+                          && m_valueMax > m_valueMin;
+
+    /* Level of detail follows the plot width in device pixels and the
+     * buffer length (see LEVEL OF DETAIL in the header docs). */
+    const qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    const int level = drawable ? m_model->lodLevelForWidth(width() * dpr) : -1;
+    const int columns = !drawable ? 0
+                      : level < 0 ? rows - 1
+                                  : m_model->lodBucketCount(level);
+    const int tileCount = (columns + TILE_COLUMNS - 1) / TILE_COLUMNS;
+
+    /* Buffer layout or level changed: replace the tiles. Vertex counts are
+     * fixed per tile for the lifetime of a layout, so steady-state frames
+     * only rewrite vertex data in place. */
+    if (root->rows != rows || root->channels != channels
+        || root->level != level || root->columns != columns)
+    {
+        for (QSGGeometryNode* tile : root->tiles)
+        {
+            root->removeChildNode(tile);
+            delete tile;
+        }
+        root->tiles.clear();
+        root->rows = rows;
+        root->channels = channels;
+        root->level = level;
+        root->columns = columns;
+
+        for (int t = 0; t < tileCount; ++t)
+        {
+            const int tileColumns = std::min(TILE_COLUMNS, columns - t * TILE_COLUMNS);
+            QSGGeometryNode* tile = createLineNode(tileColumns * channels * 2);
+            root->appendChildNode(tile);
+            root->tiles.push_back(tile);
+        }
+        m_rebuildAll = true;
+    }
+
+    /* Raw: segment i spans rows i and i+1, so a changed row also dirties
+     * the segment that ends on it. LOD: bar k is stretched towards bucket
+     * k-1, so a changed bucket also dirties the bar after it. */
+    std::vector<char> tileDirty(tileCount, m_rebuildAll ? 1 : 0);
+    if (!m_rebuildAll && tileCount > 0)
+    {
+        for (const auto& [firstRow, lastRow] : m_dirtyRows)
+        {
+            int firstColumn, lastColumn;
+            if (level < 0)
+            {
+                firstColumn = firstRow - 1;
+                lastColumn = lastRow;
+            }
+            else
+            {
+                const int bucketRows = m_model->lodBucketRows(level);
+                firstColumn = firstRow / bucketRows;
+                lastColumn = lastRow / bucketRows + 1;
+            }
+            const int firstTile = std::clamp(firstColumn, 0, columns - 1) / TILE_COLUMNS;
+            const int lastTile = std::clamp(lastColumn, 0, columns - 1) / TILE_COLUMNS;
+            std::fill(tileDirty.begin() + firstTile, tileDirty.begin() + lastTile + 1, 1);
+        }
+    }
+
+    for (int t = 0; t < tileCount; ++t)
+    {
+        if (!tileDirty[t])
+            continue;
+        fillTile(root->tiles[t], t, level, columns, channels);
+        root->tiles[t]->markDirty(QSGNode::DirtyGeometry);
+    }
+
+    m_rebuildAll = false;
+    m_dirtyRows.clear();
+    return root;
+}
+
+void EegTraceView::fillTile(QSGGeometryNode* node, int tile, int level, int columns, int channels) const
+{
+    QSGGeometry::ColoredPoint2D* vertices = node->geometry()->vertexDataAsColoredPoint2D();
+
+    const int firstColumn = tile * TILE_COLUMNS;
+    const int tileColumns = std::min(TILE_COLUMNS, columns - firstColumn);
+
+    const int rows = m_model->rowCount();
+    const float xScale = static_cast<float>(width() / rows);
+    const float yScale = static_cast<float>(height() / (m_valueMax - m_valueMin));
+    const float yTop = static_cast<float>(m_valueMax);
+
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        const Rgba c = m_channelColors.isEmpty()
+            ? Rgba{255, 255, 255, 255}
+            : premultiplied(m_channelColors[ch % m_channelColors.size()]);
+        QSGGeometry::ColoredPoint2D* out = vertices + static_cast<size_t>(ch) * tileColumns * 2;
+
+        if (level < 0)
+        {
+            const float* values = m_model->channelSamples(ch) + firstColumn;
+            for (int i = 0; i < tileColumns; ++i, out += 2)
+            {
+                const float y0 = values[i];
+                const float y1 = values[i + 1];
+                if (std::isnan(y0) || std::isnan(y1))
+                {
+                    /* Gap or unwritten row: transparent zero-length line. */
+                    out[0].set(0.0f, 0.0f, 0, 0, 0, 0);
+                    out[1] = out[0];
+                    continue;
+                }
+                const float x0 = static_cast<float>(firstColumn + i) * xScale;
+                out[0].set(x0, (yTop - y0) * yScale, c.r, c.g, c.b, c.a);
+                out[1].set(x0 + xScale, (yTop - y1) * yScale, c.r, c.g, c.b, c.a);
+            }
+            continue;
+        }
+
+        const int bucketRows = m_model->lodBucketRows(level);
+        const float* mins = m_model->lodMin(level, ch);
+        const float* maxs = m_model->lodMax(level, ch);
+        for (int i = 0; i < tileColumns; ++i, out += 2)
+        {
+            const int k = firstColumn + i;
+            float lo = mins[k];
+            float hi = maxs[k];
+            if (std::isnan(lo))
+            {
+                out[0].set(0.0f, 0.0f, 0, 0, 0, 0);
+                out[1] = out[0];
+                continue;
+            }
+            if (k > 0)
+            {
+                /* Reach the previous bucket's range so consecutive bars
+                 * join; fmin/fmax ignore a NaN (gap) neighbour. */
+                lo = std::fmin(lo, maxs[k - 1]);
+                hi = std::fmax(hi, mins[k - 1]);
+            }
+
+            /* Values grow upward, pixels downward. A flat bucket still
+             * gets a one-pixel bar so a quiet channel stays visible. */
+            float yLo = (yTop - hi) * yScale;
+            float yHi = (yTop - lo) * yScale;
+            if (yHi - yLo < 1.0f)
+            {
+                const float mid = 0.5f * (yLo + yHi);
+                yLo = mid - 0.5f;
+                yHi = mid + 0.5f;
+            }
+            const float x = (static_cast<float>(k) + 0.5f) * bucketRows * xScale;
+            out[0].set(x, yLo, c.r, c.g, c.b, c.a);
+            out[1].set(x, yHi, c.r, c.g, c.b, c.a);
+        }
+    }
+}
+
+void EegTraceView::fillGrid(QSGGeometryNode* node) const
+{
+    QSGGeometry* geometry = node->geometry();
+    const double window = m_model ? m_model->timeWindowSeconds() : 0.0;
+    const int lines = (window > 0 && width() > 0)
+        ? static_cast<int>(std::floor(window * GRID_SUBDIVISIONS)) + 1
+        : 0;
+
+    geometry->allocate(lines * 2);
+    if (lines == 0)
+        return;
+
+    /* Sub-lines first so the whole-second lines are drawn on top. */
+    const Rgba major = premultiplied(m_gridColor);
+    const Rgba minor = premultiplied(m_subGridColor);
+    const float h = static_cast<float>(height());
+    QSGGeometry::ColoredPoint2D* out = geometry->vertexDataAsColoredPoint2D();
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const Rgba& c = pass == 0 ? minor : major;
+        for (int k = 0; k < lines; ++k)
+        {
+            if ((k % GRID_SUBDIVISIONS == 0) != (pass == 1))
+                continue;
+            const float x = static_cast<float>(k / (window * GRID_SUBDIVISIONS) * width());
+            out[0].set(x, 0.0f, c.r, c.g, c.b, c.a);
+            out[1].set(x, h, c.r, c.g, c.b, c.a);
+            out += 2;
+        }
+    }
+}
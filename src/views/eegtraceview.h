@@ -0,0 +1,187 @@
+/*
+ * ==========================================================================
+ *  eegtraceview.h — Scene-Graph EEG Trace Renderer
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    Draws every channel of an EegDataModel as a waveform directly into
+ *    the Qt Quick scene graph. Replaces the former GraphsView setup in
+ *    EegGraph.qml, where each channel was one LineSeries fed by one
+ *    XYModelMapper that fetched every point through data() as a QVariant.
+ *    At 128 channels × 2560 rows a full-range dataChanged meant ~330 000
+ *    virtual calls and QVariant boxings per frame; this item reads the
+ *    model's float ring in place instead.
+ *
+ *  DESIGN PATTERN:
+ *    Custom QQuickItem (ItemHasContents) — updatePaintNode() builds and
+ *    updates QSGGeometryNodes on the render thread while the GUI thread is
+ *    blocked in the sync phase, which is what makes the direct read of
+ *    EegDataModel's buffer safe without copying or locking.
+ *
+ *  NODE LAYOUT:
+ *
+ *    root (TraceRootNode)
+ *      ├─ grid node          vertical time grid, rebuilt on resize only
+ *      ├─ tile 0             columns [0, TILE_COLUMNS), all channels
+ *      ├─ tile 1             columns [TILE_COLUMNS, 2·TILE_COLUMNS), ...
+ *      └─ ...
+ *
+ *    Each tile is one QSGGeometryNode with DrawLines geometry and
+ *    per-vertex color (QSGVertexColorMaterial), so one tile is one draw
+ *    call for every channel. A column is one line per channel:
+ *      raw level   column i = segment from row i to row i+1
+ *      LOD level   column k = vertical min/max bar of envelope bucket k
+ *
+ *  LEVEL OF DETAIL:
+ *    EegDataModel::lodLevelForWidth() is asked with the plot width in
+ *    device pixels on every sync. While the raw rows fit in about two
+ *    points per pixel column they are drawn as segments; beyond that the
+ *    item draws one min/max bar per bucket of the chosen envelope level,
+ *    so a 30 s × 2 kHz window costs ~1500 bars per channel, not 60 000
+ *    segments, and no spike is lost. Each bar is stretched to meet the
+ *    previous bucket's range so the trace stays continuous. A level change
+ *    (resize, new window or rate) rebuilds the tiles.
+ *
+ *  FRAME CLOCK:
+ *    The item drives the model's change notification. changesPending()
+ *    schedules a window update; on that frame's afterAnimating (GUI
+ *    thread, just before sync) the item calls
+ *    EegDataModel::flushPendingChanges(), whose dataChanged ranges land in
+ *    m_dirtyRows and are consumed by the sync that immediately follows.
+ *    Repaints therefore track the display's vsync and always include the
+ *    latest written rows.
+ *
+ *  INCREMENTAL UPLOAD:
+ *    The model's dataChanged row ranges (one, or two across the wrap) are
+ *    collected in m_dirtyRows. Only the tiles they touch are refilled and
+ *    marked DirtyGeometry; the scene graph re-uploads the vertex buffer of
+ *    those nodes alone. With a 10 s sweep at 60 FPS that is one or two
+ *    tiles per frame — the write cursor plus the gap ahead of it —
+ *    independent of the channel count. Size, range, color and buffer
+ *    layout changes rebuild every tile once.
+ *
+ *  SWEEP GAP:
+ *    EegDataModel writes NaN into the rows ahead of the cursor. A segment
+ *    with a NaN end point is emitted as a transparent zero-length line,
+ *    so the trace breaks exactly where the model says, without a spike.
+ *
+ *  COORDINATES:
+ *    The item's bounds are the plot area. X maps row → [0, width]
+ *    (row / maxSamples spans the full time window). Y maps the model's
+ *    display values, valueMax at the top to valueMin at the bottom — the
+ *    same orientation the GraphsView Y axis had, so EegDisplayScaler's
+ *    output is drawn unchanged. Marker overlays in QML can therefore use
+ *    xPosition / timeWindowSeconds × width with no plot-margin guesswork.
+ *
+ *  THREADING:
+ *    Properties and dirty tracking live on the GUI thread. updatePaintNode()
+ *    runs on the render thread during sync; it is the only place that
+ *    touches nodes or reads the model's samples.
+ *
+ * ==========================================================================
+ */
+
+#ifndef EEGTRACEVIEW_H
+#define EEGTRACEVIEW_H
+
+#include <QQuickItem>
+#include <QColor>
+#include <QPointer>
+#include <QVariantList>
+#include <QVector>
+#include <utility>
+#include <vector>
+#include <QtQml/qqmlregistration.h>
+#include "eegdatamodel.h"
+
+class QSGGeometryNode;
+
+class EegTraceView : public QQuickItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+
+    Q_PROPERTY(EegDataModel* model READ model WRITE setModel NOTIFY modelChanged FINAL)
+    Q_PROPERTY(double valueMin READ valueMin WRITE setValueMin NOTIFY valueRangeChanged FINAL)
+    Q_PROPERTY(double valueMax READ valueMax WRITE setValueMax NOTIFY valueRangeChanged FINAL)
+    Q_PROPERTY(QVariantList channelColors READ channelColors WRITE setChannelColors NOTIFY channelColorsChanged FINAL)
+    Q_PROPERTY(QColor gridColor READ gridColor WRITE setGridColor NOTIFY gridColorsChanged FINAL)
+    Q_PROPERTY(QColor subGridColor READ subGridColor WRITE setSubGridColor NOTIFY gridColorsChanged FINAL)
+
+public:
+    explicit EegTraceView(QQuickItem* parent = nullptr);
+
+    EegDataModel* model() const;
+    void setModel(EegDataModel* model);
+
+    /* Display-value range mapped to the bottom / top edge of the item. */
+    double valueMin() const;
+    void setValueMin(double value);
+    double valueMax() const;
+    void setValueMax(double value);
+
+    /* One color per channel, cycled when there are more channels than
+     * entries. Accepts QColor values or color strings from QML. */
+    QVariantList channelColors() const;
+    void setChannelColors(const QVariantList& colors);
+
+    /* Vertical grid: gridColor every second, subGridColor every 1/10 s. */
+    QColor gridColor() const;
+    void setGridColor(const QColor& color);
+    QColor subGridColor() const;
+    void setSubGridColor(const QColor& color);
+
+signals:
+    void modelChanged();
+    void valueRangeChanged();
+    void channelColorsChanged();
+    void gridColorsChanged();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData& value) override;
+
+private slots:
+    /* EegDataModel::dataChanged — records a dirty row range. */
+    void onModelDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
+    /* EegDataModel::changesPending — asks the window for a frame. */
+    void requestFrame();
+
+    /* QQuickWindow::afterAnimating — flushes the model's pending rows. */
+    void onAfterAnimating();
+
+    /* Buffer reallocated or model replaced — every tile is rebuilt. */
+    void invalidateAll();
+
+private:
+    /* Refills the vertices of tile `tile` from the model's ring (level -1)
+     * or from envelope `level`. */
+    void fillTile(QSGGeometryNode* node, int tile, int level, int columns, int channels) const;
+
+    /* Rebuilds the vertical grid lines for the current size and window. */
+    void fillGrid(QSGGeometryNode* node) const;
+
+    QPointer<EegDataModel> m_model;
+    double m_valueMin = -50.0;
+    double m_valueMax = 1050.0;
+    QVariantList m_channelColorList;
+    QVector<QColor> m_channelColors;    // Parsed m_channelColorList
+    QColor m_gridColor = QColor(0x2d, 0x3e, 0x50);
+    QColor m_subGridColor = QColor(0x1a, 0x23, 0x32);
+
+    /* Inclusive row ranges changed since the last sync. */
+    std::vector<std::pair<int, int>> m_dirtyRows;
+    QMetaObject::Connection m_frameConnection;  // window afterAnimating
+    bool m_rebuildAll = true;           // Refill every tile on the next sync
+    bool m_rebuildGrid = true;
+
+    /* Columns per tile node. Small enough that a frame's write touches one
+     * or two tiles, large enough to keep the node count low even on the
+     * raw level. Each tile holds channels × TILE_COLUMNS × 2 vertices. */
+    static constexpr int TILE_COLUMNS = 128;
+    static constexpr int GRID_SUBDIVISIONS = 10;
+};
+
+#endif // EEGTRACEVIEW_H
@@ -0,0 +1,69 @@
+/*
+ * ==========================================================================
+ *  clockcorrectionworker.cpp — Background LSL time_correction() Sampler
+ * ==========================================================================
+ *  See clockcorrectionworker.h for the threading model and inlet lifetime.
+ * ==========================================================================
+ */
+
+#include "clockcorrectionworker.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+ClockCorrectionWorker::ClockCorrectionWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void ClockCorrectionWorker::setInlet(lsl::stream_inlet* inlet)
+{
+    {
+        QMutexLocker locker(&m_inletMutex);
+        if (inlet == m_inlet)
+            return;
+        m_inlet = inlet;
+        if (inlet)
+            m_fit.reset();
+    }
+
+    // Measure the new stream now rather than up to 10 s later. The last
+    // published model stays valid until then (it is held flat once its
+    // extrapolation limit is reached).
+    if (inlet)
+        QMetaObject::invokeMethod(this, &ClockCorrectionWorker::measure, Qt::QueuedConnection);
+}
+
+void ClockCorrectionWorker::start()
+{
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(REFRESH_INTERVAL_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &ClockCorrectionWorker::measure);
+    m_refreshTimer->start();
+}
+
+void ClockCorrectionWorker::measure()
+{
+    QMutexLocker locker(&m_inletMutex);
+    if (!m_inlet || !m_modelTarget)
+        return;
+
+    try
+    {
+        // Blocks for the network round trip — only this thread waits.
+        const double correction = m_inlet->time_correction(1.0);
+        const double localTime = lsl::local_clock();
+        m_fit.addMeasurement(localTime, correction);
+
+        auto model = std::make_shared<const EegClockModel>(m_fit.model());
+        std::atomic_store(m_modelTarget, model);
+
+        qDebug() << "[ClockCorrectionWorker] Time correction:" << correction * 1000.0
+                 << "ms, fitted drift:" << model->slope * 1e6 << "ppm over"
+                 << model->measurements << "measurements";
+    }
+    catch (const std::exception& e)
+    {
+        qWarning() << "[ClockCorrectionWorker] time_correction() failed:" << e.what();
+    }
+}
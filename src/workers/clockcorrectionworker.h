@@ -0,0 +1,83 @@
+/*
+ * ==========================================================================
+ *  clockcorrectionworker.h — Background LSL time_correction() Sampler
+ * ==========================================================================
+ *
+ *  PURPOSE:
+ *    lsl::stream_inlet::time_correction() is a network round trip to the
+ *    amplifier's LSL outlet and blocks for up to its timeout (1 s). Run on
+ *    the main thread every 10 s, it stalled the UI and every frame sync
+ *    query queued behind it. This worker owns all time_correction() calls
+ *    on its own thread; EegSyncManager only ever reads the latest
+ *    published EegClockModel.
+ *
+ *  DESIGN PATTERN:
+ *    Worker-Thread (QObject + moveToThread), like RecordingWorker.
+ *    EegSyncManager creates the worker, hands it the model slot with
+ *    setModelTarget() before moveToThread(), and invokes start() once the
+ *    thread runs. start() creates the 10 s refresh timer on the worker
+ *    thread; each measure() call:
+ *      1. time_correction(1.0) + lsl::local_clock() — one measurement
+ *      2. adds it to EegClockDriftFit (least-squares offset + slope)
+ *      3. std::atomic_store()s a new immutable EegClockModel
+ *    Readers std::atomic_load() the model and evaluate it at their own
+ *    timestamp: no lock, no wait on the network.
+ *
+ *  INLET LIFETIME:
+ *    setInlet() is called directly on the LSL acquisition thread when the
+ *    inlet is created and just before it is deleted. It takes
+ *    m_inletMutex, which measure() holds for the whole time_correction()
+ *    call, so setInlet(nullptr) returns only once no call is using the
+ *    inlet any more — the reader can then delete it safely. A new inlet
+ *    (possibly another amplifier with another clock) resets the fit and
+ *    queues an immediate measurement.
+ *
+ * ==========================================================================
+ */
+
+#ifndef CLOCKCORRECTIONWORKER_H
+#define CLOCKCORRECTIONWORKER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QTimer>
+#include <memory>
+#include <lsl_cpp.h>
+#include "eegclockmodel.h"
+
+class ClockCorrectionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ClockCorrectionWorker(QObject* parent = nullptr);
+
+    /* Where fitted models are published (std::atomic_store). Owned by
+     * EegSyncManager, which outlives the worker thread; must be set
+     * before moveToThread(). */
+    void setModelTarget(std::shared_ptr<const EegClockModel>* target) { m_modelTarget = target; }
+
+    /* Thread-safe; blocks while a time_correction() call is in flight
+     * (see INLET LIFETIME). nullptr stops measuring. */
+    void setInlet(lsl::stream_inlet* inlet);
+
+public slots:
+    /* Creates and starts the refresh timer; invoke once on the worker thread. */
+    void start();
+
+    /* Takes one time_correction() measurement and publishes the refitted
+     * model. No-op without an inlet. */
+    void measure();
+
+private:
+    static constexpr int REFRESH_INTERVAL_MS = 10000;
+
+    QMutex m_inletMutex;                    // Guards m_inlet and m_fit
+    lsl::stream_inlet* m_inlet = nullptr;
+    EegClockDriftFit m_fit;
+
+    std::shared_ptr<const EegClockModel>* m_modelTarget = nullptr;
+    QTimer* m_refreshTimer = nullptr;
+};
+
+#endif // CLOCKCORRECTIONWORKER_H
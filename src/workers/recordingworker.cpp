@@ -8,6 +8,8 @@
  */
 
 #include "recordingworker.h"
+#include "eegtimestampdejitter.h"
+#include "eegcsvformat.h"
 
 #include <QFileInfo>
 #include <QDir>
@@ -16,13 +18,99 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSaveFile>
+#include <QtEndian>
 #include <QDebug>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#  include <qt_windows.h>
+#  include <io.h>
+#else
+#  include <unistd.h>
+#  include <fcntl.h>
+#endif
+
+namespace {
+
+/* Forces the file's data from the OS page cache to stable storage.
+ * QFile::flush() only empties Qt's own buffer into the page cache; this
+ * is the call that makes written bytes survive a power cut. */
+bool syncFileData(QFile& file)
+{
+    if (!file.isOpen())
+        return true;
+    if (!file.flush())
+        return false;
+#if defined(Q_OS_WIN)
+    // handle() is a CRT descriptor wrapping the native HANDLE.
+    const HANDLE h = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return h != INVALID_HANDLE_VALUE && ::FlushFileBuffers(h);
+#elif defined(Q_OS_DARWIN)
+    // fsync() on macOS stops at the drive's write cache; F_FULLFSYNC does not.
+    return ::fcntl(file.handle(), F_FULLFSYNC) == 0 || ::fsync(file.handle()) == 0;
+#else
+    // Data plus the file size needed to read it back; mtime is skipped.
+    return ::fdatasync(file.handle()) == 0;
+#endif
+}
+
+const char* durabilityPolicyName(DurabilityPolicy policy)
+{
+    switch (policy) {
+    case DurabilityPolicy::EveryBatch: return "EVERY_BATCH";
+    case DurabilityPolicy::Interval:   return "INTERVAL";
+    case DurabilityPolicy::Size:       return "SIZE";
+    }
+    return "UNKNOWN";
+}
+
+} // namespace
 
 RecordingWorker::RecordingWorker(QObject* parent)
     : QObject(parent)
 {
 }
 
+void RecordingWorker::setDurabilityPolicy(DurabilityPolicy policy, int intervalMs, qint64 bytes)
+{
+    m_durability = policy;
+    m_durabilityIntervalMs = qMax(intervalMs, 0);
+    m_durabilityBytes = qMax<qint64>(bytes, 1);
+}
+
+double RecordingWorker::maxDataLossWindowMs(DurabilityPolicy policy, int intervalMs,
+                                            qint64 bytes, double bytesPerSec)
+{
+    // A sample waits up to one drain interval in the ring, then sits in the
+    // page cache until the next checkpoint. Group-commit checks only run at
+    // drains, so their threshold is rounded up by another drain interval.
+    switch (policy) {
+    case DurabilityPolicy::EveryBatch:
+        return EEG_DRAIN_INTERVAL_MS;
+    case DurabilityPolicy::Interval:
+        return 2.0 * EEG_DRAIN_INTERVAL_MS + intervalMs;
+    case DurabilityPolicy::Size:
+        if (bytesPerSec <= 0.0)
+            return -1.0;
+        return 2.0 * EEG_DRAIN_INTERVAL_MS + 1000.0 * double(bytes) / bytesPerSec;
+    }
+    return -1.0;
+}
+
+double RecordingWorker::eegBytesPerSec(EegFileFormat format, int channelCount, double samplingRate)
+{
+    if (samplingRate <= 0.0 || channelCount <= 0)
+        return 0.0;
+    // CSV: "123456.789012" + newline ≈ 18 bytes, ",-123.4567" ≈ 10 per value.
+    const double recordBytes = double(sizeof(double) + sizeof(float) * size_t(channelCount));
+    double rowBytes = 18.0 + 10.0 * channelCount;
+    if (format == EegFileFormat::RawFloat32)
+        rowBytes = recordBytes;
+    else if (format == EegFileFormat::Compressed)
+        rowBytes = recordBytes / EEG_COMPRESSION_RATIO_ESTIMATE;
+    return rowBytes * samplingRate;
+}
+
 RecordingWorker::~RecordingWorker()
 {
     // Ensure files are closed if worker is destroyed unexpectedly
@@ -39,22 +127,39 @@ void RecordingWorker::initializeFiles(const QString& eegPath,
                                        const QString& framesPath,
                                        const QString& metadataPath,
                                        const QStringList& channelNames,
+                                       const QVector<int>& channelIndices,
+                                       EegFileFormat eegFormat,
                                        const QString& sessionName,
                                        double samplingRate)
 {
     m_sessionName = sessionName;
+    m_channelIndices = channelIndices;
+    m_eegFormat = eegFormat;
+    m_recordChannelCount = channelIndices.isEmpty() ? channelNames.size() : channelIndices.size();
     m_savePath = QFileInfo(eegPath).absolutePath();
+    m_eegHeld = false;
     m_sampleCount = 0;
     m_markerCount = 0;
     m_frameCount = 0;
-
-    // Open EEG file
+    m_unsyncedEegBytes = 0;
+    m_unsynced = false;
+    m_syncCount = 0;
+    m_maxSyncGapMs = 0;
+    m_syncFailed = false;
+
+    // Open EEG file — text mode only for CSV; the binary layouts must not
+    // have their bytes translated (\n → \r\n on Windows).
+    const bool binaryEeg = (m_eegFormat != EegFileFormat::Csv);
     m_eegFile.setFileName(eegPath);
-    if (!m_eegFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QIODevice::OpenMode eegMode = QIODevice::WriteOnly;
+    if (!binaryEeg)
+        eegMode |= QIODevice::Text;
+    if (!m_eegFile.open(eegMode)) {
         emit filesInitialized(false, "Cannot open EEG file: " + eegPath);
         return;
     }
-    m_eegStream.setDevice(&m_eegFile);
+    if (!binaryEeg)
+        m_eegStream.setDevice(&m_eegFile);
 
     // Open markers file
     m_markersFile.setFileName(markersPath);
@@ -76,63 +181,245 @@ void RecordingWorker::initializeFiles(const QString& eegPath,
     m_framesStream.setDevice(&m_framesFile);
 
     // Write headers
-    writeEegHeader(channelNames, sessionName, samplingRate);
+    if (m_eegFormat == EegFileFormat::RawFloat32)
+        writeEegBinaryHeader(samplingRate);
+    else if (m_eegFormat == EegFileFormat::Compressed)
+        writeEegCompressedHeader(samplingRate);
+    else
+        writeEegHeader(channelNames, sessionName, samplingRate);
     writeMarkersHeader();
     writeFramesHeader();
     writeMetadata(sessionName, channelNames, samplingRate);
 
-    // Double flush headers immediately — stream flush + fsync for power-loss safety.
-    // This ensures even the CSV headers survive a power cut during the first batch.
-    m_eegStream.flush();
-    m_eegFile.flush();
-    m_markersStream.flush();
-    m_markersFile.flush();
-    m_framesStream.flush();
-    m_framesFile.flush();
+    // Checkpoint the headers so even a power cut during the first batch
+    // leaves parseable files behind.
+    syncFilesToDisk();
+
+    // The timer is created here, on the worker thread, so its timeouts
+    // are delivered to this thread's event loop.
+    if (!m_drainTimer) {
+        m_drainTimer = new QTimer(this);
+        m_drainTimer->setInterval(EEG_DRAIN_INTERVAL_MS);
+        connect(m_drainTimer, &QTimer::timeout, this, &RecordingWorker::drainEegRing);
+    }
+    m_drainTimer->start();
 
-    qDebug() << "[RecordingWorker] Files initialized:" << eegPath;
+    qDebug() << "[RecordingWorker] Files initialized:" << eegPath
+             << "Durability:" << durabilityPolicyName(m_durability)
+             << "max loss window (ms):"
+             << maxDataLossWindowMs(m_durability, m_durabilityIntervalMs, m_durabilityBytes,
+                                    eegBytesPerSec(m_eegFormat, m_recordChannelCount, samplingRate));
     emit filesInitialized(true, QString());
 }
 
-void RecordingWorker::writeEegBatch(const QVector<QVector<float>>& samples,
-                                     const QVector<double>& timestamps)
+void RecordingWorker::drainEegRing()
 {
-    if (!m_eegFile.isOpen() || samples.isEmpty())
+    if (!m_eegRing)
         return;
 
-    for (int i = 0; i < samples.size(); ++i) {
-        // Write LSL timestamp with full precision
-        m_eegStream << QString::number(timestamps[i], 'f', 6);
+    // Paused: whatever is queued was pushed after the resume and belongs
+    // behind the PAUSE_STOP row. Interval checkpoints still run.
+    if (m_eegHeld) {
+        commitIfDue();
+        return;
+    }
 
-        // Write channel values
-        const auto& channelValues = samples[i];
-        for (int ch = 0; ch < channelValues.size(); ++ch) {
-            m_eegStream << ',' << QString::number(channelValues[ch], 'f', 4);
+    const bool fileOpen = m_eegFile.isOpen();
+    int written = 0;
+    qint64 drainedBytes = 0;
+
+    EegChunkPtr chunk;
+    while (m_eegRing->tryPop(chunk)) {
+        drainedBytes += qint64(chunk->byteSize());
+        if (!fileOpen)
+            continue;
+        switch (m_eegFormat) {
+        case EegFileFormat::Csv:        written += appendEegCsvRows(*chunk); break;
+        case EegFileFormat::RawFloat32: written += appendEegRecords(*chunk); break;
+        case EegFileFormat::Compressed: written += appendEegBlockRows(*chunk); break;
         }
-        m_eegStream << '\n';
+    }
+    chunk.reset();
+
+    // Blocks never span drains: every row popped here is on disk after
+    // this drain's write, exactly as with the other formats.
+    if (m_eegFormat == EegFileFormat::Compressed)
+        encodeEegBlocks();
+
+    // Interval checkpoints are also due while nothing new arrives (pause).
+    if (written == 0) {
+        if (m_queueStats)
+            m_queueStats->eegBytesDrained.fetch_add(drainedBytes, std::memory_order_release);
+        commitIfDue();
+        return;
     }
 
-    m_sampleCount += samples.size();
+    m_sampleCount += written;
 
-    // Double flush: QTextStream::flush() empties Qt's internal write buffer
-    // to the OS page cache. QFile::flush() calls fsync()/FlushFileBuffers()
-    // to commit the page cache to physical media. Both are needed for
-    // data durability on unexpected power loss during a 24-hour recording.
-    m_eegStream.flush();
+    // Header and pause-marker rows go through m_eegStream; empty it first
+    // so the direct write below cannot overtake buffered text.
+    if (m_eegFormat == EegFileFormat::Csv)
+        m_eegStream.flush();
+
+    // Everything formatted in this drain goes out in a single write().
+    // Timed together with the checkpoint below: a stalling disk shows up
+    // as write latency long before the ring overflows.
+    QElapsedTimer writeTimer;
+    writeTimer.start();
+    if (m_eegFile.write(m_eegWriteBuffer.data(), qint64(m_eegWriteBuffer.size()))
+            != qint64(m_eegWriteBuffer.size())) {
+        emit errorOccurred("EEG write failed: " + m_eegFile.errorString());
+    }
+    m_unsyncedEegBytes += qint64(m_eegWriteBuffer.size());
+    m_unsynced = true;
+    m_eegWriteBuffer.clear(); // Keeps capacity for the next drain
+
+    // Hand the batch to the OS now (survives an app crash); whether it is
+    // also synced to disk is up to the durability policy.
     m_eegFile.flush();
+    commitIfDue();
+
+    if (m_queueStats) {
+        // Counted only once written, so bytesPending covers formatting too.
+        m_queueStats->eegBytesDrained.fetch_add(drainedBytes, std::memory_order_release);
+        const qint64 latencyUs = writeTimer.nsecsElapsed() / 1000;
+        qint64 maxUs = m_queueStats->maxWriteLatencyUs.load(std::memory_order_relaxed);
+        while (latencyUs > maxUs
+               && !m_queueStats->maxWriteLatencyUs.compare_exchange_weak(maxUs, latencyUs)) {
+        }
+    }
+
+    emit batchWritten(written, m_eegFile.size());
+}
 
-    emit batchWritten(samples.size(), m_eegFile.size());
+int RecordingWorker::appendEegCsvRows(const EegChunk& chunk)
+{
+    // Output is byte-identical to the former QTextStream path:
+    //   QString::number(ts, 'f', 6) { ',' QString::number(value, 'f', 4) } '\n'
+    // QString::number(float) widens to double, as the cast below does.
+    // Newline translation for text mode (Windows) is applied by QFile::write().
+    std::vector<char>& buf = m_eegWriteBuffer;
+
+    for (int i = 0; i < chunk.sampleCount; ++i) {
+        const float* row = chunk.row(i);
+
+        // LSL timestamp with full precision
+        appendFixed(buf, chunk.timestamps[i], 6);
+
+        // Selected channel values (all channels if no selection)
+        if (m_channelIndices.isEmpty()) {
+            for (int ch = 0; ch < chunk.channelCount; ++ch) {
+                buf.push_back(',');
+                appendFixed(buf, double(row[ch]), 4);
+            }
+        } else {
+            for (int ch : m_channelIndices) {
+                const float value = (ch >= 0 && ch < chunk.channelCount) ? row[ch] : 0.0f;
+                buf.push_back(',');
+                appendFixed(buf, double(value), 4);
+            }
+        }
+        buf.push_back('\n');
+    }
+    return chunk.sampleCount;
+}
+
+int RecordingWorker::appendEegRecords(const EegChunk& chunk)
+{
+    const int outChannels = m_recordChannelCount;
+    const size_t recordBytes = sizeof(double) + sizeof(float) * size_t(outChannels);
+    const size_t base = m_eegWriteBuffer.size();
+    m_eegWriteBuffer.resize(base + recordBytes * size_t(chunk.sampleCount));
+    char* out = m_eegWriteBuffer.data() + base;
+
+    // Without a selection the hardware row is already the record payload,
+    // so it is converted in one call instead of gathered value by value.
+    const bool wholeRow = m_channelIndices.isEmpty() && chunk.channelCount == outChannels;
+
+    for (int i = 0; i < chunk.sampleCount; ++i) {
+        const float* row = chunk.row(i);
+
+        qToLittleEndian<double>(&chunk.timestamps[i], 1, out);
+        out += sizeof(double);
+
+        if (wholeRow) {
+            qToLittleEndian<float>(row, outChannels, out);
+            out += sizeof(float) * size_t(outChannels);
+            continue;
+        }
+
+        for (int c = 0; c < outChannels; ++c) {
+            const int src = m_channelIndices.isEmpty() ? c : m_channelIndices[c];
+            const float value = (src >= 0 && src < chunk.channelCount) ? row[src] : 0.0f;
+            qToLittleEndian<float>(&value, 1, out);
+            out += sizeof(float);
+        }
+    }
+    return chunk.sampleCount;
+}
+
+int RecordingWorker::appendEegBlockRows(const EegChunk& chunk)
+{
+    const int outChannels = m_recordChannelCount;
+    const size_t base = m_eegBlockRows.size();
+    m_eegBlockRows.resize(base + size_t(outChannels) * size_t(chunk.sampleCount));
+    float* out = m_eegBlockRows.data() + base;
+
+    const bool wholeRow = m_channelIndices.isEmpty() && chunk.channelCount == outChannels;
+    for (int i = 0; i < chunk.sampleCount; ++i) {
+        const float* row = chunk.row(i);
+        if (wholeRow) {
+            std::memcpy(out, row, sizeof(float) * size_t(outChannels));
+        } else {
+            for (int c = 0; c < outChannels; ++c) {
+                const int src = m_channelIndices.isEmpty() ? c : m_channelIndices[c];
+                out[c] = (src >= 0 && src < chunk.channelCount) ? row[src] : 0.0f;
+            }
+        }
+        out += outChannels;
+    }
+    m_eegBlockTimestamps.insert(m_eegBlockTimestamps.end(),
+                                chunk.timestamps.begin(), chunk.timestamps.begin() + chunk.sampleCount);
+    return chunk.sampleCount;
+}
+
+void RecordingWorker::encodeEegBlocks()
+{
+    const int rows = int(m_eegBlockTimestamps.size());
+    const qint64 fileOffset = m_eegFile.pos();
+    for (int first = 0; first < rows; first += EegBlockCodec::MAX_BLOCK_ROWS) {
+        const int count = qMin(EegBlockCodec::MAX_BLOCK_ROWS, rows - first);
+        m_eegBlockIndex.push_back({fileOffset + qint64(m_eegWriteBuffer.size()),
+                                   m_sampleCount + first, m_eegBlockTimestamps[size_t(first)]});
+        // At most MAX_BLOCK_ROWS rows: exactly one block per call
+        m_eegCodec.encode(m_eegBlockRows.data() + size_t(first) * size_t(m_recordChannelCount),
+                          m_eegBlockTimestamps.data() + first, count, m_eegWriteBuffer);
+    }
+    m_eegBlockRows.clear();             // Both keep their capacity
+    m_eegBlockTimestamps.clear();
 }
 
 void RecordingWorker::writePauseMarker(const QString& type,
                                         double lslTimestamp,
                                         double sessionTimeSec)
 {
-    // Write to EEG CSV as inline marker
-    if (m_eegFile.isOpen()) {
+    commandStarted();
+
+    // Keep the in-band row in timestamp order. The tap closes before
+    // PAUSE_START is posted, so draining first writes every pre-pause
+    // sample ahead of it. The tap reopens right after PAUSE_STOP is
+    // posted, so everything queued since PAUSE_START is post-resume and
+    // is held until the PAUSE_STOP row is out.
+    const bool pauseStart = (type == QLatin1String("PAUSE_START"));
+    if (pauseStart) {
+        drainEegRing();
+        m_eegHeld = true;
+    }
+
+    // Write to EEG CSV as inline marker. The binary layouts hold samples
+    // only; there the markers CSV is the sole record of the pause.
+    if (m_eegFile.isOpen() && m_eegFormat == EegFileFormat::Csv) {
         m_eegStream << type << ',' << QString::number(lslTimestamp, 'f', 6) << '\n';
-        m_eegStream.flush();
-        m_eegFile.flush();
     }
 
     // Write to markers CSV
@@ -140,8 +427,16 @@ void RecordingWorker::writePauseMarker(const QString& type,
         m_markersStream << type << ",,"
                         << QString::number(lslTimestamp, 'f', 6) << ','
                         << QString::number(sessionTimeSec, 'f', 3) << '\n';
-        m_markersStream.flush();
-        m_markersFile.flush();
+    }
+
+    // Segment boundaries are rare and anchor the analysis timeline:
+    // always checkpoint, whatever the policy.
+    m_unsynced = true;
+    commitIfDue(true);
+
+    if (!pauseStart) {
+        m_eegHeld = false;
+        drainEegRing();
     }
 }
 
@@ -150,6 +445,7 @@ void RecordingWorker::writeMarker(const QString& type,
                                    double lslTimestamp,
                                    double sessionTimeSec)
 {
+    commandStarted();
     if (!m_markersFile.isOpen())
         return;
 
@@ -157,15 +453,19 @@ void RecordingWorker::writeMarker(const QString& type,
                     << label << ','
                     << QString::number(lslTimestamp, 'f', 6) << ','
                     << QString::number(sessionTimeSec, 'f', 3) << '\n';
+    // QTextStream::flush() also empties the QFile buffer into the OS.
     m_markersStream.flush();
-    m_markersFile.flush();
     m_markerCount++;
+
+    m_unsynced = true;
+    commitIfDue();
 }
 
 void RecordingWorker::writeFrameTimestamp(double lslTimestamp,
                                           qint64 frameNumber,
                                           const QString& segmentFile)
 {
+    commandStarted();
     if (!m_framesFile.isOpen())
         return;
 
@@ -174,19 +474,24 @@ void RecordingWorker::writeFrameTimestamp(double lslTimestamp,
                    << segmentFile << '\n';
 
     m_frameCount++;
+    m_unsynced = true;
 
-    // Deferred flush: at 30 fps, flushing every frame would generate 30 fsync
-    // calls per second. Flushing every 100 frames reduces this to 0.3/sec at the
-    // cost of a maximum ~3.3 s window of unsynced frame index data — acceptable
-    // given that the EEG data (which is more critical) flushes every batch.
-    if (m_frameCount % 100 == 0) {
+    // Deferred hand-off: at 30 fps, one write() per frame is 30 syscalls per
+    // second for ~30 bytes each. Every 100 frames (~3.3 s) bounds what an
+    // app crash can lose; checkpoints (driven by the EEG drain) flush the
+    // stream too, so the power-loss window is the policy's, not 3.3 s.
+    if (m_frameCount % 100 == 0)
         m_framesStream.flush();
-        m_framesFile.flush();
-    }
 }
 
 void RecordingWorker::closeFiles(double durationSeconds, qint64 videoFileSizeBytes)
 {
+    // The tap is already closed; write whatever is still queued.
+    if (m_drainTimer)
+        m_drainTimer->stop();
+    m_eegHeld = false;
+    drainEegRing();
+
     RecordingSummary summary;
     summary.sessionName = m_sessionName;
     summary.savePath = m_savePath;
@@ -195,28 +500,31 @@ void RecordingWorker::closeFiles(double durationSeconds, qint64 videoFileSizeByt
     summary.videoFrames = m_frameCount;
     summary.markerCount = static_cast<int>(m_markerCount);
 
-    // Flush and close all files
+    // The compressed file ends with its block index (see sessionconfig.h).
+    if (m_eegFile.isOpen() && m_eegFormat == EegFileFormat::Compressed)
+        writeEegBlockIndex();
+
+    // Final checkpoint, then close all files
+    m_unsynced = true;
+    commitIfDue(true);
+
     if (m_eegFile.isOpen()) {
-        m_eegStream.flush();
         summary.eegFileSizeBytes = m_eegFile.size();
         m_eegFile.close();
     }
 
-    if (m_markersFile.isOpen()) {
-        m_markersStream.flush();
+    if (m_markersFile.isOpen())
         m_markersFile.close();
-    }
 
-    if (m_framesFile.isOpen()) {
-        m_framesStream.flush();
+    if (m_framesFile.isOpen())
         m_framesFile.close();
-    }
 
     summary.videoFileSizeBytes = videoFileSizeBytes;
     summary.endTime = QDateTime::currentDateTime().toString(Qt::ISODate);
 
     qDebug() << "[RecordingWorker] Files closed. EEG samples:" << m_sampleCount
-             << "Markers:" << m_markerCount << "Frames:" << m_frameCount;
+             << "Markers:" << m_markerCount << "Frames:" << m_frameCount
+             << "Disk syncs:" << m_syncCount << "longest gap (ms):" << m_maxSyncGapMs;
 
     emit filesClosed(summary);
 }
@@ -238,6 +546,63 @@ void RecordingWorker::writeEegHeader(const QStringList& channelNames,
     m_eegStream << '\n';
 }
 
+void RecordingWorker::writeEegBinaryHeader(double samplingRate)
+{
+    // Layout documented in sessionconfig.h (EEG FILE FORMATS) and repeated
+    // in the metadata JSON. All fields little-endian.
+    char header[EEG_BINARY_HEADER_BYTES] = {};
+    std::memcpy(header, EEG_BINARY_MAGIC, sizeof(EEG_BINARY_MAGIC));
+    qToLittleEndian<quint32>(EEG_BINARY_VERSION, header + 8);
+    qToLittleEndian<quint32>(EEG_BINARY_HEADER_BYTES, header + 12);
+    qToLittleEndian<quint32>(quint32(m_recordChannelCount), header + 16);
+    qToLittleEndian<quint32>(quint32(sizeof(double) + sizeof(float) * m_recordChannelCount), header + 20);
+    qToLittleEndian<double>(samplingRate, header + 24);
+    m_eegFile.write(header, sizeof(header));
+}
+
+void RecordingWorker::writeEegCompressedHeader(double samplingRate)
+{
+    // Same 32-byte frame as the RawFloat32 header; the blocks follow.
+    char header[EEG_BINARY_HEADER_BYTES] = {};
+    std::memcpy(header, EEG_COMPRESSED_MAGIC, sizeof(EEG_COMPRESSED_MAGIC));
+    qToLittleEndian<quint32>(EEG_COMPRESSED_VERSION, header + 8);
+    qToLittleEndian<quint32>(EEG_BINARY_HEADER_BYTES, header + 12);
+    qToLittleEndian<quint32>(quint32(m_recordChannelCount), header + 16);
+    qToLittleEndian<quint32>(quint32(EegBlockCodec::MAX_BLOCK_ROWS), header + 20);
+    qToLittleEndian<double>(samplingRate, header + 24);
+    m_eegFile.write(header, sizeof(header));
+
+    m_eegCodec.reset(m_recordChannelCount);
+    m_eegBlockRows.clear();
+    m_eegBlockTimestamps.clear();
+    m_eegBlockIndex.clear();
+}
+
+void RecordingWorker::writeEegBlockIndex()
+{
+    const qint64 indexOffset = m_eegFile.pos();
+    std::vector<char> index(m_eegBlockIndex.size() * 24 + 24);
+    char* out = index.data();
+    for (const EegBlockIndexEntry& entry : m_eegBlockIndex) {
+        qToLittleEndian<quint64>(quint64(entry.fileOffset), out);
+        qToLittleEndian<quint64>(quint64(entry.firstSample), out + 8);
+        qToLittleEndian<double>(entry.firstTimestamp, out + 16);
+        out += 24;
+    }
+    std::memcpy(out, EEG_INDEX_MAGIC, sizeof(EEG_INDEX_MAGIC));
+    qToLittleEndian<quint64>(quint64(indexOffset), out + 8);
+    qToLittleEndian<quint64>(quint64(m_eegBlockIndex.size()), out + 16);
+
+    if (m_eegFile.write(index.data(), qint64(index.size())) != qint64(index.size()))
+        emit errorOccurred("EEG index write failed: " + m_eegFile.errorString());
+
+    // Uncompressed size for comparison: what RawFloat32 would have written
+    const double rawBytes = double(m_sampleCount)
+                            * double(sizeof(double) + sizeof(float) * size_t(m_recordChannelCount));
+    qDebug() << "[RecordingWorker] Compressed EEG:" << m_eegBlockIndex.size() << "blocks,"
+             << "ratio" << (m_eegFile.size() > 0 ? rawBytes / double(m_eegFile.size()) : 0.0);
+}
+
 void RecordingWorker::writeMarkersHeader()
 {
     m_markersStream << "Type,Label,LSL_Timestamp,SessionTimeSec\n";
@@ -264,9 +629,57 @@ void RecordingWorker::writeMetadata(const QString& sessionName,
         chArray.append(name);
     root["channelNames"] = chArray;
 
-    root["eegFormat"] = "CSV";
+    root["eegFile"] = QFileInfo(m_eegFile.fileName()).fileName();
+    root["eegFormat"] = eegFileFormatName(m_eegFormat); // Same names as the session state
+    if (m_eegFormat == EegFileFormat::RawFloat32) {
+        // Self-describing layout so readers do not need this source tree.
+        QJsonObject layout;
+        layout["byteOrder"] = "little-endian";
+        layout["magic"] = "VEEGF32";
+        layout["version"] = int(EEG_BINARY_VERSION);
+        layout["headerBytes"] = EEG_BINARY_HEADER_BYTES;
+        layout["recordBytes"] = int(sizeof(double) + sizeof(float) * m_recordChannelCount);
+        layout["recordFields"] = QJsonArray{
+            QJsonObject{{"name", "LSL_Timestamp"}, {"type", "float64"}, {"unit", "s"}},
+            QJsonObject{{"name", "channels"}, {"type", "float32"}, {"count", m_recordChannelCount},
+                        {"unit", "uV"}, {"order", "channelNames"}}
+        };
+        layout["pauseMarkers"] = "markers CSV only";
+        root["eegLayout"] = layout;
+    } else if (m_eegFormat == EegFileFormat::Compressed) {
+        QJsonObject layout;
+        layout["byteOrder"] = "little-endian";
+        layout["magic"] = "VEEGBLK";
+        layout["version"] = int(EEG_COMPRESSED_VERSION);
+        layout["headerBytes"] = EEG_BINARY_HEADER_BYTES;
+        layout["maxBlockRows"] = EegBlockCodec::MAX_BLOCK_ROWS;
+        layout["blockHeaderBytes"] = EegBlockCodec::BLOCK_HEADER_BYTES;
+        layout["coding"] = "per block and channel: scaled-integer or float-bit prediction "
+                           "(order 1/2) + Rice; timestamps order-2 on float64 bits; lossless";
+        layout["index"] = "24-byte entries (uint64 offset, uint64 firstSample, float64 "
+                          "firstTimestamp) + 24-byte VEEGIDX trailer, written on close";
+        layout["channels"] = QJsonObject{{"type", "float32"}, {"count", m_recordChannelCount},
+                                         {"unit", "uV"}, {"order", "channelNames"}};
+        layout["pauseMarkers"] = "markers CSV only";
+        root["eegLayout"] = layout;
+    }
+    // What a power cut can cost, so reviewers know how to read a truncated file.
+    QJsonObject durability;
+    durability["policy"] = durabilityPolicyName(m_durability);
+    if (m_durability == DurabilityPolicy::Interval)
+        durability["intervalMs"] = m_durabilityIntervalMs;
+    if (m_durability == DurabilityPolicy::Size)
+        durability["bytes"] = double(m_durabilityBytes);
+    durability["maxLossWindowMs"] = maxDataLossWindowMs(
+        m_durability, m_durabilityIntervalMs, m_durabilityBytes,
+        eegBytesPerSec(m_eegFormat, m_recordChannelCount, samplingRate));
+    root["durability"] = durability;
+
     root["videoFormat"] = "MKV (H.264)";
     root["timestampDomain"] = "LSL";
+    root["timestampDejitter"] = QJsonObject{
+        {"method", "RLS sample index to time (regular-rate streams)"},
+        {"halfLifeSec", EegTimestampDejitter::HALF_LIFE_SEC}};
     root["version"] = "1.0";
 
     QString metadataPath = m_savePath + "/" + sessionName + "_metadata.json";
@@ -275,6 +688,68 @@ void RecordingWorker::writeMetadata(const QString& sessionName,
     }
 }
 
+void RecordingWorker::commandStarted()
+{
+    if (m_queueStats)
+        m_queueStats->commandsPending.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ==========================================================================
+//  Durability Checkpoints
+// ==========================================================================
+
+void RecordingWorker::commitIfDue(bool force)
+{
+    if (!m_unsynced)
+        return;
+
+    bool due = force;
+    switch (m_durability) {
+    case DurabilityPolicy::EveryBatch:
+        due = true;
+        break;
+    case DurabilityPolicy::Interval:
+        due = due || m_sinceSync.elapsed() >= m_durabilityIntervalMs;
+        break;
+    case DurabilityPolicy::Size:
+        due = due || m_unsyncedEegBytes >= m_durabilityBytes;
+        break;
+    }
+
+    if (due)
+        syncFilesToDisk();
+}
+
+void RecordingWorker::syncFilesToDisk()
+{
+    // Buffered text must reach the OS before it can be synced. The EEG
+    // stream is unused (empty) in RawFloat32 mode.
+    if (m_eegFormat == EegFileFormat::Csv)
+        m_eegStream.flush();
+    m_markersStream.flush();
+    m_framesStream.flush();
+
+    for (QFile* file : {&m_eegFile, &m_markersFile, &m_framesFile}) {
+        if (syncFileData(*file))
+            continue;
+        qWarning() << "[RecordingWorker] Disk sync failed:" << file->fileName();
+        // Reported once: a filesystem without sync support would otherwise
+        // raise an error on every checkpoint.
+        if (!m_syncFailed) {
+            m_syncFailed = true;
+            emit errorOccurred("Disk sync failed: " + file->fileName()
+                               + " — data is written but may not survive a power cut");
+        }
+    }
+
+    if (m_sinceSync.isValid())
+        m_maxSyncGapMs = qMax(m_maxSyncGapMs, m_sinceSync.elapsed());
+    m_sinceSync.restart();
+    m_unsyncedEegBytes = 0;
+    m_unsynced = false;
+    ++m_syncCount;
+}
+
 // ==========================================================================
 //  Atomic JSON Write Helper
 // ==========================================================================
@@ -312,6 +787,7 @@ bool RecordingWorker::atomicWriteJson(const QString& finalPath, const QJsonObjec
 
 void RecordingWorker::writeSessionState(const QJsonObject& stateJson, const QString& statePath)
 {
+    commandStarted();
     if (!atomicWriteJson(statePath, stateJson)) {
         qWarning() << "[RecordingWorker] Failed to persist session state to:" << statePath;
     }
@@ -13,30 +13,63 @@
  *    Worker-Thread (QObject + moveToThread). RecordingWorker is created on
  *    the main thread then moved: worker->moveToThread(m_workerThread).
  *    All public slots execute on m_workerThread's event loop.
- *    Communication is strictly signal-driven:
+ *    Control is signal-driven:
  *      Main thread → worker:  emit requestXxx() signals (QueuedConnection)
  *      Worker → main thread:  emit filesInitialized() / batchWritten() / etc.
+ *    EEG samples bypass the event queue: they arrive through a lock-free
+ *    SPSC ring filled on the LSL acquisition thread (see setEegRing()).
  *
  *  FILES MANAGED (per session):
- *    1. EEG CSV     — LSL_Timestamp + channel values per sample.
- *       Special:      PAUSE_START / PAUSE_STOP in-band marker rows.
- *       Precision:    6 dp timestamps (μs); 4 dp amplitudes (0.1 μV).
+ *    1. EEG data    — format chosen per session (EegFileFormat):
+ *       CSV:          LSL_Timestamp + channel values per sample.
+ *                     PAUSE_START / PAUSE_STOP in-band marker rows.
+ *                     6 dp timestamps (μs); 4 dp amplitudes (0.1 μV).
+ *                     Sample rows are formatted by appendFixed()
+ *                     (eegcsvformat.h) into m_eegWriteBuffer (no
+ *                     per-value QString) and written once per drain.
+ *       RawFloat32:   32-byte header + float64 timestamp / float32 channel
+ *                     records (see sessionconfig.h). Bit-exact samples,
+ *                     4 bytes per value, no text formatting; built in
+ *                     m_eegWriteBuffer and written once per drain, too.
+ *       Compressed:   32-byte header + lossless blocks (EegBlockCodec)
+ *                     + block index on close (see sessionconfig.h). The
+ *                     selected channels of a drain are gathered into
+ *                     m_eegBlockRows and coded into m_eegWriteBuffer as
+ *                     blocks of at most MAX_BLOCK_ROWS — the drain still
+ *                     ends up in a single write(), and no rows wait for a
+ *                     later drain, so the loss window is RawFloat32's.
  *    2. Markers CSV — Type, Label, LSL_Timestamp, SessionTimeSec.
- *       Flushed immediately: markers are clinically critical annotations.
+ *       Handed to the OS immediately: markers are clinically critical.
  *    3. Frames CSV  — FrameNumber, LSL_Timestamp, SegmentFile.
- *       Flushed every 100 frames (avoids 30 fsync/sec at 30 fps).
+ *       Handed to the OS every 100 frames (not 30 write()s/sec at 30 fps).
  *    4. Metadata JSON — Written once at session open time.
  *
  *  BATCHING RATIONALE:
- *    RecordingManager accumulates EEG_BATCH_SIZE (100) samples before
- *    invoking writeEegBatch(), reducing writes to ~2-3 per second.
- *    A 5-second watchdog timer in RecordingManager ensures that data is
- *    never held in the batch for more than 5 seconds.
+ *    drainEegRing() runs every EEG_DRAIN_INTERVAL_MS (250 ms) on the worker
+ *    thread and writes every chunk queued since the last run in one write()
+ *    — ~4 writes per second regardless of how finely the acquisition thread
+ *    chunks the stream. PAUSE_START and closeFiles() drain first, so the
+ *    in-band PAUSE_START row and end of file follow the last sample. From
+ *    PAUSE_START until PAUSE_STOP drains leave the ring alone: anything
+ *    queued then was pushed after the resume and is written only after
+ *    the PAUSE_STOP row, even if the tap reopens before the worker gets
+ *    to the marker.
  *
- *  FLUSH POLICY:
- *    QTextStream::flush() + QFile::flush() are called after every write.
- *    QTextStream flushes to the OS buffer; QFile::flush() calls fsync,
- *    ensuring data survives power loss. The double flush is intentional.
+ *  FLUSH / DURABILITY POLICY:
+ *    Two different operations, not to be confused:
+ *      QTextStream::flush() / QFile::write() hand bytes to the OS page
+ *      cache (one write() syscall). Data then survives an application
+ *      crash, but NOT a power cut — QFile::flush() does not fsync.
+ *      syncFilesToDisk() calls fdatasync() (POSIX), F_FULLFSYNC (macOS) or
+ *      FlushFileBuffers() (Windows) on all three files — a "checkpoint".
+ *    Every drain and marker reaches the page cache immediately; frames
+ *    every 100 rows. Checkpoints follow the session's DurabilityPolicy
+ *    (see sessionconfig.h), evaluated by commitIfDue() after every drain
+ *    and marker: every batch, at most once per interval (group commit), or
+ *    once enough EEG bytes are pending. Pause markers and closeFiles()
+ *    always checkpoint. maxDataLossWindowMs() gives the worst-case window
+ *    of acquired data that a power cut could lose; it is logged and
+ *    written to the metadata JSON.
  *
  * ==========================================================================
  */
@@ -50,7 +83,15 @@
 #include <QVector>
 #include <QStringList>
 #include <QJsonObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <vector>
 #include "recordingsummary.h"
+#include "recordingqueuestats.h"
+#include "sessionconfig.h"
+#include "eegchunk.h"
+#include "eegblockcodec.h"
+#include "spscring.h"
 
 class RecordingWorker : public QObject
 {
@@ -60,6 +101,32 @@ public:
     explicit RecordingWorker(QObject* parent = nullptr);
     ~RecordingWorker();
 
+    /* Source of EEG chunks; this worker is the ring's only consumer.
+     * Must be set before moveToThread(); the ring is owned by
+     * RecordingManager and outlives the worker. */
+    void setEegRing(SpscRing<EegChunkPtr>* ring) { m_eegRing = ring; }
+
+    /* Back-pressure counters updated as chunks are drained and commands
+     * run (see recordingqueuestats.h). Optional; owned by RecordingManager
+     * and set before moveToThread(). */
+    void setQueueStats(RecordingQueueStats* stats) { m_queueStats = stats; }
+
+    /* When data is synced to disk (see FLUSH / DURABILITY POLICY).
+     * Must be set before moveToThread(), like the ring. */
+    void setDurabilityPolicy(DurabilityPolicy policy, int intervalMs, qint64 bytes);
+
+    /* Worst-case span of acquired EEG (ms) that a power cut could lose
+     * under the given policy: time in the ring before a drain plus time
+     * in the page cache before a checkpoint. bytesPerSec is only used
+     * by the Size policy; returns -1 there if it is unknown (<= 0). */
+    static double maxDataLossWindowMs(DurabilityPolicy policy, int intervalMs,
+                                      qint64 bytes, double bytesPerSec);
+
+    /* EEG file growth rate: exact for RawFloat32, an estimate for CSV
+     * (typical row width) and Compressed (typical ratio). 0 if
+     * samplingRate is unknown. */
+    static double eegBytesPerSec(EegFileFormat format, int channelCount, double samplingRate);
+
 public slots:
     /* Opens all output files and writes CSV/JSON headers.
      * Must be the first slot invoked after the worker thread starts.
@@ -70,21 +137,28 @@ public slots:
                          const QString& framesPath,
                          const QString& metadataPath,
                          const QStringList& channelNames,
+                         const QVector<int>& channelIndices,
+                         EegFileFormat eegFormat,
                          const QString& sessionName,
                          double samplingRate);
 
-    /* Writes a batch of EEG samples to the EEG CSV and flushes to disk.
-     * @param samples     [sampleIdx][channelIdx], selected channels only
-     * @param timestamps  LSL timestamp per sample row */
-    void writeEegBatch(const QVector<QVector<float>>& samples,
-                       const QVector<double>& timestamps);
+    /* Pops every chunk queued in the EEG ring, writes the selected channels
+     * to the EEG file in one write(), then checkpoints if the durability
+     * policy says so. Driven by m_drainTimer; also called around pause
+     * markers and on close. Chunks popped while the EEG file is not open
+     * are discarded so the ring cannot fill up. While paused (m_eegHeld)
+     * it only checkpoints. */
+    void drainEegRing();
 
     /* Writes PAUSE_START or PAUSE_STOP to both the EEG CSV (in-band) and
-     * the markers CSV so analysis software can detect boundaries in either file. */
+     * the markers CSV so analysis software can detect boundaries in either file.
+     * PAUSE_START drains the ring first and then holds it; PAUSE_STOP writes
+     * its row first and then releases and drains it. */
     void writePauseMarker(const QString& type, double lslTimestamp, double sessionTimeSec);
 
-    /* Writes a single clinical event marker. Flushed immediately to disk
-     * because markers are safety-critical annotations (e.g. seizure onset). */
+    /* Writes a single clinical event marker. Handed to the OS immediately
+     * because markers are safety-critical annotations (e.g. seizure onset);
+     * synced to disk per the durability policy. */
     void writeMarker(const QString& type, const QString& label,
                      double lslTimestamp, double sessionTimeSec);
 
@@ -93,7 +167,7 @@ public slots:
     void writeFrameTimestamp(double lslTimestamp, qint64 frameNumber,
                              const QString& segmentFile);
 
-    /* Flushes and closes all files, builds RecordingSummary, emits filesClosed().
+    /* Checkpoints and closes all files, builds RecordingSummary, emits filesClosed().
      * @param videoFileSizeBytes  Summed size of all MKV segments (from main thread) */
     void closeFiles(double durationSeconds, qint64 videoFileSizeBytes);
 
@@ -117,6 +191,23 @@ signals:
     void errorOccurred(const QString& error);
 
 private:
+    /* Formats one chunk's CSV rows (timestamp + selected channels) into
+     * m_eegWriteBuffer. Returns the number of rows appended. */
+    int appendEegCsvRows(const EegChunk& chunk);
+
+    /* RawFloat32 counterpart: appends one chunk's records to
+     * m_eegWriteBuffer. Returns the number of records appended. */
+    int appendEegRecords(const EegChunk& chunk);
+    void writeEegBinaryHeader(double samplingRate);
+
+    /* Compressed counterpart: gathers one chunk's selected channels into
+     * m_eegBlockRows; encodeEegBlocks() codes them into m_eegWriteBuffer
+     * once per drain and records each block in m_eegBlockIndex. */
+    int appendEegBlockRows(const EegChunk& chunk);
+    void encodeEegBlocks();
+    void writeEegCompressedHeader(double samplingRate);
+    void writeEegBlockIndex();
+
     void writeEegHeader(const QStringList& channelNames,
                         const QString& sessionName,
                         double samplingRate);
@@ -134,6 +225,18 @@ private:
     // -----------------------------------------------------------------
     static bool atomicWriteJson(const QString& finalPath, const QJsonObject& json);
 
+    /* Accounts for one command signal from RecordingManager having reached
+     * its slot (see RecordingQueueStats::commandsPending). */
+    void commandStarted();
+
+    /* Checkpoints when the durability policy is due (always if force).
+     * No-op when nothing was written since the last checkpoint. */
+    void commitIfDue(bool force = false);
+
+    /* Pushes buffered text to the OS, then syncs all open files to disk.
+     * Emits errorOccurred() if any sync fails. */
+    void syncFilesToDisk();
+
     QFile m_eegFile;
     QFile m_markersFile;
     QFile m_framesFile;
@@ -141,6 +244,51 @@ private:
     QTextStream m_markersStream;
     QTextStream m_framesStream;
 
+    SpscRing<EegChunkPtr>* m_eegRing = nullptr;
+    RecordingQueueStats* m_queueStats = nullptr;
+    QVector<int> m_channelIndices;       // Hardware channels to record (empty = all)
+    EegFileFormat m_eegFormat = EegFileFormat::Csv;
+    int m_recordChannelCount = 0;        // Channels per written row/record
+    bool m_eegHeld = false;              // Between PAUSE_START and PAUSE_STOP: the ring
+                                         // only holds post-resume chunks, kept until
+                                         // the PAUSE_STOP row is written
+    std::vector<char> m_eegWriteBuffer;  // CSV rows / binary records of the current drain
+
+    static constexpr char EEG_BINARY_MAGIC[8] = {'V','E','E','G','F','3','2','\0'};
+    static constexpr quint32 EEG_BINARY_VERSION = 1;
+    static constexpr int EEG_BINARY_HEADER_BYTES = 32;
+
+    // Compressed format (see sessionconfig.h)
+    struct EegBlockIndexEntry
+    {
+        qint64 fileOffset;
+        qint64 firstSample;
+        double firstTimestamp;
+    };
+    EegBlockCodec m_eegCodec;
+    std::vector<float> m_eegBlockRows;           // Selected channels of the current drain
+    std::vector<double> m_eegBlockTimestamps;
+    std::vector<EegBlockIndexEntry> m_eegBlockIndex;
+    static constexpr char EEG_COMPRESSED_MAGIC[8] = {'V','E','E','G','B','L','K','\0'};
+    static constexpr char EEG_INDEX_MAGIC[8] = {'V','E','E','G','I','D','X','\0'};
+    static constexpr quint32 EEG_COMPRESSED_VERSION = 1;
+    /* Bytes-per-second estimate only (eegBytesPerSec); the real ratio
+     * depends on the amplifier's resolution and noise. */
+    static constexpr double EEG_COMPRESSION_RATIO_ESTIMATE = 3.0;
+    QTimer* m_drainTimer = nullptr;      // Created on the worker thread in initializeFiles()
+    static constexpr int EEG_DRAIN_INTERVAL_MS = 250;
+
+    // Durability — checkpoint bookkeeping (see commitIfDue())
+    DurabilityPolicy m_durability = DurabilityPolicy::Interval;
+    int m_durabilityIntervalMs = 1000;
+    qint64 m_durabilityBytes = 4 * 1024 * 1024;
+    QElapsedTimer m_sinceSync;           // Restarted at every checkpoint
+    qint64 m_unsyncedEegBytes = 0;       // EEG bytes written since the last checkpoint
+    bool m_unsynced = false;             // Anything (EEG, marker, frame) written since then
+    qint64 m_syncCount = 0;
+    qint64 m_maxSyncGapMs = 0;           // Longest observed time between checkpoints
+    bool m_syncFailed = false;           // errorOccurred() already emitted for a sync
+
     QString m_sessionName;
     QString m_savePath;
     qint64 m_sampleCount = 0;